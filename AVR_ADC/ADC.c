@@ -1,134 +1,543 @@
-/*************************************************************************
- Title	:   C include file for the ADC library (ADC.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the ADC configuration.
-
-       This Library uses interruptions for the ADC and have a buffer to 
-       store the data. It has 2 modes: 10 bits and 8 bits.
-
- USAGE
-       See the C include ADC.h file for a description of each function
-
-*****************************************************************************/
-
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include "ADC.h"
-
-/* Static Variables */
-static volatile states_ADC ADC_status;
-static volatile uint16_t ADC_Value;
-static volatile uint16_t ADC_P;
-#if ADC_MODE == TENBIT
-static uint16_t ADC_Buffer[ADC_BUFFER_SIZE];
-#elif ADC_MODE == EIGHTBIT
-static uint8_t ADC_Buffer[ADC_BUFFER_SIZE];
-#endif
-static volatile uint8_t ADC_Head;
-static volatile uint8_t ADC_Tail;
-
-
-
-/*
-**	functions
-*/
-
-/*************************************************************************
-Low-level function to initialize the ADC
-Input:    none
-Returns:  none
-*************************************************************************/
-void ADC_Init(void)
-{
-	/* Voltage Reference = AVCC */
-	ADMUX |= (1<<REFS0)|(ADC_CHANNEL<<MUX0);
-	#if ADC_MODE == EIGHTBIT
-	ADMUX |= (1<<ADLAR); 	// Adjust the bits to the left
-	#endif
-
-	/* ADC Enable, ADC Interrupt Enable, Prescaler predefined to work at 125 KHz */
-	ADCSRA |= (1<<ADEN)|(1<<ADIE)|(ADC_PRESC<<ADPS0);
-}
-
-void ADC_Start()
-{
-	/* Activa ADC */
-	ADCSRA |= (1<<ADSC);
-	/* Cambia de estadp*/
-	ADC_status = ADC_WAIT;
-}
-
-
-/*************************************************************************
-Interrupt Vector for the ADC.
-If the conversion is ready this ISR will execute. Saves the data and
-change the index of the ADC Buffer.
-*************************************************************************/
-ISR(ADC_vect)
-{
-	/* ADC Value */
-	#if ADC_MODE == TENBIT
-	uint16_t temp;
-	temp = ADC;
-	#elif ADC_MODE == EIGHTBIT
-	uint8_t temp;
-	temp = ADCH;
-	#endif
-	
-	uint8_t tmphead;
-	
-	/* Calculate buffer index */
-	tmphead = (ADC_Head + 1) & ADC_BUFFER_MASK;
-	
-	/* Store new index */
-	ADC_Head = tmphead;
-	
-	/* Store the data in the buffer */
-	ADC_Buffer[tmphead] = temp;
-
-	/* Change the current state */
-	ADC_status = ADC_RDY;
-}
-
-
-
-
-/*************************************************************************
-Waits until there are new data in the buffer.
-Input:    none
-Returns:  Data converted from the ADC. 
-*************************************************************************/
-#if ADC_MODE == TENBIT
-uint16_t ADC_GetValue(void)
-{
-	/*Espera a nueva data*/
-	while(ADC_Head == ADC_Tail){}
-	uint8_t tmptail;
-	
-	/* Calcula el indice */
-	tmptail = (ADC_Tail + 1) & ADC_BUFFER_MASK;
-	/* Almacena nuevo indice */
-	ADC_Tail = tmptail;
-	/* Devuelve el valor */
-	return ADC_Buffer[ADC_Tail];
-}
-
-#elif ADC_MODE == EIGHTBIT
-uint8_t ADC_GetValue(void)
-{
-	/*Espera a nueva data*/
-	while(ADC_Head == ADC_Tail){}
-	uint8_t tmptail;
-	
-	/* Calcula el indice */
-	tmptail = (ADC_Tail + 1) & ADC_BUFFER_MASK;
-	/* Almacena nuevo indice */
-	ADC_Tail = tmptail;
-	/* Devuelve el valor */
-	return ADC_Buffer[ADC_Tail];
-}
-#endif
+/*************************************************************************
+ Title	:   C include file for the ADC library (ADC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the ADC configuration.
+
+       This Library uses interruptions for the ADC and have a buffer to 
+       store the data. It has 2 modes: 10 bits and 8 bits.
+
+ USAGE
+       See the C include ADC.h file for a description of each function
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "ADC.h"
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+#include "../AVR_STATS/STATS.h"
+#include "../AVR_TRACE/TRACE.h"
+#include "../AVR_EECONFIG/EECONFIG.h"
+#if ADC_STREAM
+#include "ADCSTREAM.h"
+#endif
+
+/* Static Variables */
+static volatile states_ADC ADC_status;
+static volatile uint16_t ADC_Value;
+static volatile uint16_t ADC_P;
+static value_ADC ADC_Buffer[ADC_BUFFER_SIZE] MEM_SECTION;
+static volatile uint8_t ADC_Head;
+static volatile uint8_t ADC_Tail;
+#if ADC_SCAN
+static volatile value_ADC ADC_Scan[ADC_SCAN_CHANNELS];	// Last value of each channel
+static volatile uint8_t ADC_ScanMask;				// Channels of the scan, 0: stopped
+static volatile uint8_t ADC_ScanNew;				// Channels with an unread value
+#endif
+#if ADC_WATCHDOG
+static value_ADC ADC_Low[ADC_WD_CHANNELS];
+static value_ADC ADC_High[ADC_WD_CHANNELS];
+static value_ADC ADC_Hyst[ADC_WD_CHANNELS];
+static uint8_t ADC_Zone[ADC_WD_CHANNELS];			// Current zone, ADC_EVT_x or 0
+static volatile uint8_t ADC_Events[ADC_WD_CHANNELS];
+static volatile uint8_t ADC_EventMask;
+#if ADC_WD_PRETRIGGER
+static value_ADC ADC_History[ADC_WD_PRETRIGGER];	// Last conversions, ring
+static uint8_t ADC_HistoryIndex;					// Oldest value of the ring
+static uint8_t ADC_HistoryFill;						// Values since the last release
+static volatile uint8_t ADC_CaptureChannel = 0xFF;	// 0xFF: history running
+#endif
+#endif
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Low-level function to initialize the ADC
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADC_Init(void)
+{
+	#if EECONFIG_ENABLE
+	uint8_t channel = EECONFIG_Data.adc_channel;
+	
+	/* Only the valid channels of ADC_CHANNEL are accepted */
+	if ((channel > ADC_CH_TEMP && channel < ADC_CH_BANDGAP) || channel > ADC_CH_GND)
+		channel = ADC_CHANNEL;
+	#else
+	const uint8_t channel = ADC_CHANNEL;
+	#endif
+	
+	/* Voltage Reference = AVCC. Registers are written, not ORed, to reset them */
+	#if ADC_MODE == EIGHTBIT
+	ADMUX = (1<<REFS0)|(1<<ADLAR)|(channel<<MUX0);	// Adjust the bits to the left
+	#else
+	ADMUX = (1<<REFS0)|(channel<<MUX0);
+	#endif
+
+	/* ADC Enable, ADC Interrupt Enable, Prescaler solved in ADC.h */
+	ADCSRA = (1<<ADEN)|(1<<ADIE)|(ADC_PRESC<<ADPS0);
+
+	/* Flush buffer */
+	ADC_Head = 0;
+	ADC_Tail = 0;
+	ADC_status = ADC_RDY;
+	#if ADC_SCAN
+	ADC_ScanMask = 0;
+	#endif
+}
+
+/*************************************************************************
+Change the channel of the next conversions. Only the MUX bits of ADMUX 
+are modified. A conversion in progress finishes with the old channel.
+Input:    channel 	new channel
+Returns:  none
+*************************************************************************/
+void ADC_SetChannel(uint8_t channel)
+{
+	ADMUX = (ADMUX & ~(0x0F<<MUX0)) | ((channel & 0x0F)<<MUX0);
+}
+
+/*************************************************************************
+Channel of the next conversions, from the MUX bits of ADMUX.
+Input:    none
+Returns:  channel
+*************************************************************************/
+uint8_t ADC_GetChannel(void)
+{
+	return (ADMUX >> MUX0) & 0x0F;
+}
+
+/*************************************************************************
+Discard the unread values of the buffer.
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADC_Flush(void)
+{
+	/* The ISR only writes the head, one byte: no atomic block needed */
+	ADC_Tail = ADC_Head;
+}
+
+void ADC_Start()
+{
+	/* Activa ADC */
+	ADCSRA |= (1<<ADSC);
+	/* Cambia de estadp*/
+	ADC_status = ADC_WAIT;
+}
+
+/*************************************************************************
+Start the conversions in Free Running mode. 
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADC_StartAuto(void)
+{
+	/* Trigger source: Free Running */
+	ADCSRB &= ~((1<<ADTS2)|(1<<ADTS1)|(1<<ADTS0));
+	ADCSRA |= (1<<ADATE)|(1<<ADSC);
+	ADC_status = ADC_WAIT;
+}
+
+/*************************************************************************
+Stop the Free Running mode. 
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADC_Stop(void)
+{
+	ADCSRA &= ~(1<<ADATE);
+	#if ADC_SCAN
+	ADC_ScanMask = 0;
+	#endif
+}
+
+
+#if ADC_SCAN
+/*************************************************************************
+Start the scan of a set of channels from the lowest one. The ISR starts 
+the next conversions.
+Input:    channels 	one bit per channel 0-7
+Returns:  none
+*************************************************************************/
+void ADC_StartScan(uint8_t channels)
+{
+	uint8_t channel = 0;
+	
+	if (!channels)
+		return;
+	while (!(channels & (1<<channel)))
+		channel++;
+	
+	/* Single conversions, the ISR restarts them */
+	ADCSRA &= ~(1<<ADATE);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADC_ScanMask = channels;
+		ADC_ScanNew = 0;
+	}
+	ADC_SetChannel(channel);
+	ADC_Start();
+}
+
+/*************************************************************************
+Channels of the scan with an unread value.
+Input:    none
+Returns:  One bit per channel
+*************************************************************************/
+uint8_t ADC_ScanChannels(void)
+{
+	return ADC_ScanNew;
+}
+
+/*************************************************************************
+Last value of a channel of the scan, marked as read.
+Input:    channel 	channel 0-7
+Returns:  Last conversion of the channel
+*************************************************************************/
+value_ADC ADC_GetScan(uint8_t channel)
+{
+	value_ADC value;
+	
+	if (channel >= ADC_SCAN_CHANNELS)
+		return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = ADC_Scan[channel];
+		ADC_ScanNew &= ~(1<<channel);
+	}
+	
+	return value;
+}
+#endif
+
+
+#if ADC_WATCHDOG
+/*************************************************************************
+Compare a value with the thresholds of the channel. Called from the ISR
+for every conversion, stored in the buffer or dropped.
+Input:    value 	last conversion
+Returns:  none
+*************************************************************************/
+static inline void ADC_Watchdog(value_ADC value)
+{
+	uint8_t channel = (ADMUX >> MUX0) & 0x0F;
+	uint8_t zone;
+	
+	#if ADC_WD_PRETRIGGER
+	/* The history does not depend on the reader of the buffer. It is 
+	   frozen while a capture waits for ADC_GetCapture() */
+	if (ADC_CaptureChannel == 0xFF)
+	{
+		ADC_History[ADC_HistoryIndex] = value;
+		if (++ADC_HistoryIndex == ADC_WD_PRETRIGGER)
+			ADC_HistoryIndex = 0;
+		if (ADC_HistoryFill < ADC_WD_PRETRIGGER)
+			ADC_HistoryFill++;
+	}
+	#endif
+	
+	if (channel >= ADC_WD_CHANNELS)
+		return;
+	
+	/* Leave the zones with hysteresis, enter them without it. 
+	   The casts keep the sums in value_ADC whatever the size of int, 
+	   ADC_SetThreshold() keeps them from wrapping */
+	zone = ADC_Zone[channel];
+	if (zone == ADC_EVT_HIGH)
+	{
+		if (value < (value_ADC)(ADC_High[channel] - ADC_Hyst[channel]))
+			zone = 0;
+	} else if (zone == ADC_EVT_LOW)
+	{
+		if (value > (value_ADC)(ADC_Low[channel] + ADC_Hyst[channel]))
+			zone = 0;
+	}
+	if (zone == 0)
+	{
+		if (value > ADC_High[channel])
+			zone = ADC_EVT_HIGH;
+		else if (value < ADC_Low[channel])
+			zone = ADC_EVT_LOW;
+	}
+	
+	/* Raise the event only on a crossing */
+	if (zone != ADC_Zone[channel] && zone != 0)
+	{
+		ADC_Events[channel] |= zone;
+		ADC_EventMask |= (1<<channel);
+		
+		#if ADC_WD_PRETRIGGER
+		/* Freeze the history, the newest value is the crossing one */
+		if (ADC_CaptureChannel == 0xFF && ADC_HistoryFill == ADC_WD_PRETRIGGER)
+			ADC_CaptureChannel = channel;
+		#endif
+	}
+	ADC_Zone[channel] = zone;
+}
+
+/*************************************************************************
+Set the thresholds of a channel and clear its events.
+Input:    channel 	channel 0-7
+		  low 		low threshold
+		  high 		high threshold
+		  hyst 		hysteresis
+Returns:  none
+*************************************************************************/
+void ADC_SetThreshold(uint8_t channel, value_ADC low, value_ADC high, value_ADC hyst)
+{
+	if (channel >= ADC_WD_CHANNELS)
+		return;
+	
+	/* Saturate the hysteresis: high - hyst and low + hyst do not wrap, 
+	   whatever the size of int */
+	if (hyst > high)
+		hyst = high;
+	if ((uint32_t)low + hyst > ADC_VALUE_MAX)
+		hyst = (low < ADC_VALUE_MAX) ? ADC_VALUE_MAX - low : 0;
+	
+	/* The ISR uses the values */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADC_Low[channel] = low;
+		ADC_High[channel] = high;
+		ADC_Hyst[channel] = hyst;
+		ADC_Zone[channel] = 0;
+		ADC_Events[channel] = 0;
+		ADC_EventMask &= ~(1<<channel);
+	}
+}
+
+/*************************************************************************
+Read and clear the events of a channel.
+Input:    channel 	channel 0-7
+Returns:  ADC_EVT_HIGH and/or ADC_EVT_LOW
+*************************************************************************/
+uint8_t ADC_GetEvents(uint8_t channel)
+{
+	uint8_t events;
+	
+	if (channel >= ADC_WD_CHANNELS)
+		return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		events = ADC_Events[channel];
+		ADC_Events[channel] = 0;
+		ADC_EventMask &= ~(1<<channel);
+	}
+	
+	return events;
+}
+
+/*************************************************************************
+Channels with pending events.
+Input:    none
+Returns:  One bit per channel
+*************************************************************************/
+uint8_t ADC_EventChannels(void)
+{
+	return ADC_EventMask;
+}
+
+#if ADC_WD_PRETRIGGER
+/*************************************************************************
+Unroll the frozen history from its oldest value and release it.
+Input:    buf 	ADC_WD_PRETRIGGER values
+Returns:  Channel of the capture, 0xFF if there is no capture
+*************************************************************************/
+uint8_t ADC_GetCapture(value_ADC* buf)
+{
+	uint8_t channel = ADC_CaptureChannel;
+	uint8_t index;
+	uint8_t i;
+	
+	/* The ISR does not write the history until it is released */
+	if (channel != 0xFF)
+	{
+		index = ADC_HistoryIndex;
+		for (i = 0; i < ADC_WD_PRETRIGGER; i++)
+		{
+			buf[i] = ADC_History[index];
+			if (++index == ADC_WD_PRETRIGGER)
+				index = 0;
+		}
+		ADC_HistoryFill = 0;
+		ADC_CaptureChannel = 0xFF;
+	}
+	
+	return channel;
+}
+#endif
+#endif
+
+
+/*************************************************************************
+Interrupt Vector for the ADC.
+If the conversion is ready this ISR will execute. Saves the data and
+change the index of the ADC Buffer. If the buffer is full the new data is
+dropped.
+*************************************************************************/
+ISR(ADC_vect)
+{
+	STATS_ISR_BEGIN();
+	/* ADC Value */
+	#if ADC_MODE == TENBIT
+	uint16_t temp;
+	temp = ADC;
+	#elif ADC_MODE == EIGHTBIT
+	uint8_t temp;
+	temp = ADCH;
+	#endif
+	
+	uint8_t tmphead;
+	#if ADC_SCAN
+	uint8_t scan = ADC_ScanMask;
+	uint8_t channel = (ADMUX >> MUX0) & 0x0F;
+	#endif
+	
+	TRACE_ISR(TRACE_ADC, (uint8_t)temp);
+	
+	#if ADC_STREAM
+	/* The stream takes the value, the buffer is not used */
+	if (ADCSTREAM_Sample(temp))
+	{
+		ADC_status = ADC_RDY;
+		STATS_ISR_END(STATS_ISR_ADC);
+		return;
+	}
+	#endif
+	
+	#if ADC_SCAN
+	/* The scan keeps the last value of the channel, the buffer is not used */
+	if (scan)
+	{
+		if (channel < ADC_SCAN_CHANNELS)
+		{
+			ADC_Scan[channel] = temp;
+			ADC_ScanNew |= (1<<channel);
+		}
+	} else
+	#endif
+	{
+		/* Calculate buffer index */
+		tmphead = (ADC_Head + 1) & ADC_BUFFER_MASK;
+		
+		/* Drop the data if the buffer is full, unread data is kept */
+		if (tmphead == ADC_Tail)
+		{
+			STATS_INC(STATS_ADC_DROP);
+		} else
+		{
+			/* Store the data in the buffer */
+			ADC_Buffer[tmphead] = temp;
+			
+			/* Store new index */
+			ADC_Head = tmphead;
+		}
+	}
+	
+	#if ADC_WATCHDOG
+	ADC_Watchdog(temp);
+	#endif
+	
+	#if ADC_SCAN
+	/* Next channel of the scan, after the watchdog read the MUX bits */
+	if (scan)
+	{
+		do
+		{
+			channel = (channel + 1) & (ADC_SCAN_CHANNELS - 1);
+		} while (!(scan & (1<<channel)));
+		ADMUX = (ADMUX & ~(0x0F<<MUX0)) | (channel<<MUX0);
+		ADCSRA |= (1<<ADSC);
+		STATS_ISR_END(STATS_ISR_ADC);
+		return;
+	}
+	#endif
+
+	/* Change the current state */
+	ADC_status = ADC_RDY;
+	STATS_ISR_END(STATS_ISR_ADC);
+}
+
+
+
+
+/*************************************************************************
+Waits until there are new data in the buffer. Depending on ADC_SLEEP_MODE
+the CPU sleeps meanwhile and wakes up with the ADC interrupt.
+Input:    none
+Returns:  none
+*************************************************************************/
+static void ADC_Wait(void)
+{
+	#if ADC_SLEEP_MODE == ADC_SLEEP_NONE
+	while(ADC_Head == ADC_Tail){}
+	#elif ADC_SLEEP_MODE == ADC_SLEEP_NOISE
+	SLEEP_WAIT_WHILE(ADC_Head == ADC_Tail, SLEEP_MODE_ADC);
+	#else
+	SLEEP_WAIT_WHILE(ADC_Head == ADC_Tail, SLEEP_MODE_IDLE);
+	#endif
+}
+
+
+/*************************************************************************
+Check that the ISR stores the conversions in the buffer.
+Input:    none
+Returns:  1 if ADC_GetValue() can get new values
+*************************************************************************/
+uint8_t ADC_Ready(void)
+{
+	/* Without ADEN, ADSC never starts a conversion */
+	if (!(ADCSRA & (1<<ADEN)))
+		return 0;
+	
+	#if ADC_STREAM
+	if (ADCSTREAM_Running())
+		return 0;
+	#endif
+	
+	return 1;
+}
+
+
+/*************************************************************************
+Number of unread values in the buffer.
+Input:    none
+Returns:  values that ADC_GetValue() can return without waiting
+*************************************************************************/
+uint8_t ADC_Available(void)
+{
+	return (ADC_Head - ADC_Tail) & ADC_BUFFER_MASK;
+}
+
+
+/*************************************************************************
+Waits until there are new data in the buffer.
+Input:    none
+Returns:  Data converted from the ADC. 
+*************************************************************************/
+value_ADC ADC_GetValue(void)
+{
+	uint8_t tmptail;
+	
+	/* Wait for new data */
+	ADC_Wait();
+	
+	/* Calculate buffer index. The ISR never writes the slot of the tail */
+	tmptail = (ADC_Tail + 1) & ADC_BUFFER_MASK;
+	ADC_Tail = tmptail;
+	return ADC_Buffer[tmptail];
+}
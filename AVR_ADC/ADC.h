@@ -1,127 +1,380 @@
-#ifndef ADC_H_
-#define ADC_H_
-
-/*************************************************************************
- Title	:   C include file for the ADC library (ADC.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the ADC configuration.
-
-       This Library uses interruptions for the ADC and have a buffer to 
-       store the data. It has 2 modes: 10 bits and 8 bits.
-
-*****************************************************************************/
-
-
-
-/**
-*	ADC Mode Definitions
-*	2 modes of operation.  
-*
-*/
-#define TENBIT			0
-#define EIGHTBIT		1
-
-/**
-*	UART Clock Definitions
-*	Used to obtain the UBRR value for the desired baud rate.
-*
-*/
-#ifndef F_CPU				/* Prevent compiler error by supplying a default */
-#define F_CPU 8000000UL
-#endif
-
-/**
-*	ADC Optimum Frequency: 125KHz
-*	Definition of the pre escaler. It uses the previous definition of the
-*	frequency of the microcontroller.
-*
-*/
-#if F_CPU == 1000000		
-	#define ADC_PRESC	3
-#elif F_CPU == 8000000
-	#define ADC_PRESC	6
-#elif F_CPU == 16000000 
-	#define ADC_PRESC	7
-#endif
-
-
-/**
-*	ADC Buffer Definitions
-*	Used to store the data. The size of the buffer has to be a power 
-* 	of 2. Otherwise it won't work properly. 
-*
-*/
-#define ADC_BUFFER_SIZE		8     /* 2,4,8,16,32,64,128 or 256 bytes */
-#define ADC_BUFFER_MASK		(ADC_BUFFER_SIZE - 1)
-
-
-/**
-*	ADC States
-*	There are two states in order to known the current state of the 
-* 	ADC conversion.
-*
-*/
-typedef enum
-{
-	ADC_RDY,				// Conversion ready.
-	ADC_WAIT				// Conversion in progress
-} states_ADC;
-
-
-
-/**
-*	ADC Mode
-*	Chose the mode you want to work with the ADC.
-*	The posible modes are 10BIT to obtain more precision in the conversion 
-*	or 8BIT to set a standard mode.
-*
-*/
-#define ADC_MODE 		TENBIT			/* 10BIT -- 8BIT */
-
-
-/**
-*	ADC Channel
-*	Choose the bit of the port C you want to work with the ADC.
-*	The posible modes are 0, 1, 2, 3, 4, 5, 6 and 7. Remember that the Reset
-*	interrupt is triggered with the PC6 pin.
-*
-*/
-#define ADC_CHANNEL		1	
-
-
-/**
-*	Functions 
-*/
-
-/**
- @brief		Configure the ADC to work at 125 KHz with the voltage reference on AVCC. 
- @param		none
- @return 	none
-*/
-void ADC_Init(void);
-
-
-/**
- @brief		Start the ADC conversion. 
- @param		none
- @return 	none
-*/
-void ADC_Start(void);
-
-
-/**
- @brief		Wait for the ADC to finish the conversion.
- @param		none
- @return 	Value of the conversion.
-*/
-#if ADC_MODE== TENBIT
-uint16_t ADC_GetValue(void);
-#elif ADC_MODE == EIGHTBIT
-uint8_t ADC_GetValue(void);
-#endif
-
+#ifndef ADC_H_
+#define ADC_H_
+
+/*************************************************************************
+ Title	:   C include file for the ADC library (ADC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the ADC configuration.
+
+       This Library uses interruptions for the ADC and have a buffer to 
+       store the data. It has 2 modes: 10 bits and 8 bits.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	ADC States
+*	There are two states in order to known the current state of the 
+* 	ADC conversion.
+*
+*/
+typedef enum
+{
+	ADC_RDY,				// Conversion ready.
+	ADC_WAIT				// Conversion in progress
+} states_ADC;
+
+
+
+/**
+*	ADC Mode
+*	Chose the mode you want to work with the ADC in CONFIG.h.
+*	The posible modes are TENBIT to obtain more precision in the conversion 
+*	or EIGHTBIT to set a standard mode.
+*
+*/
+#if (ADC_MODE != TENBIT) && (ADC_MODE != EIGHTBIT)
+	#error "ADC_MODE must be TENBIT or EIGHTBIT"
+#endif
+
+
+/**
+*	ADC Buffer Definitions
+*	Used to store the data. The size of the buffer is set in MEMCONF.h
+* 	and has to be a power of 2.
+*
+*/
+#include "../AVR_MEMCONF/MEMCONF.h"
+#define ADC_BUFFER_MASK		(ADC_BUFFER_SIZE - 1)
+
+
+/**
+*	ADC Channel
+*	Choose the bit of the port C you want to work with the ADC.
+*	The posible modes are 0, 1, 2, 3, 4, 5, 6 and 7. Remember that the Reset
+*	interrupt is triggered with the PC6 pin. The internal channels can also 
+*	be used. ADC_CHANNEL is set in CONFIG.h, other values are rejected at
+*	compile time.
+*
+*/
+
+/**
+*	ADC Internal Channels
+*	Inputs of the multiplexer that are not pins of the port C.
+*
+*/
+#define ADC_CH_TEMP		8				// Temperature sensor
+#define ADC_CH_BANDGAP	14				// Internal 1.1V reference
+#define ADC_CH_GND		15				// 0V (GND)
+
+#if (ADC_CHANNEL < 0) || ((ADC_CHANNEL > ADC_CH_TEMP) && (ADC_CHANNEL < ADC_CH_BANDGAP)) || (ADC_CHANNEL > ADC_CH_GND)
+	#error "ADC_CHANNEL must be 0-7, ADC_CH_TEMP, ADC_CH_BANDGAP or ADC_CH_GND"
+#endif
+
+
+/**
+*	ADC Clock Definitions
+*	The ADC needs a clock between 50 KHz and 200 KHz to get the full 
+*	10 bits resolution. ADC_PRESC is solved for any F_CPU as the smallest
+*	division factor that keeps the clock under the maximum. With ADC_FAST
+*	the maximum is 1 MHz, only allowed in the 8 bits mode. 
+*	ADC_PRESC can also be supplied (1 to 7, division factor 2^ADC_PRESC).
+*
+*/
+#ifndef ADC_FAST
+#define ADC_FAST		0				/* 1: up to 1 MHz, EIGHTBIT only */
+#endif
+
+#define ADC_CLK_MIN		50000UL
+#if ADC_FAST
+	#if ADC_MODE != EIGHTBIT
+		#error "ADC_FAST can only be used with ADC_MODE EIGHTBIT"
+	#endif
+	#define ADC_CLK_MAX	1000000UL
+#else
+	#define ADC_CLK_MAX	200000UL
+#endif
+
+#ifndef ADC_PRESC
+	#if (F_CPU/2) <= ADC_CLK_MAX
+		#define ADC_PRESC	1
+	#elif (F_CPU/4) <= ADC_CLK_MAX
+		#define ADC_PRESC	2
+	#elif (F_CPU/8) <= ADC_CLK_MAX
+		#define ADC_PRESC	3
+	#elif (F_CPU/16) <= ADC_CLK_MAX
+		#define ADC_PRESC	4
+	#elif (F_CPU/32) <= ADC_CLK_MAX
+		#define ADC_PRESC	5
+	#elif (F_CPU/64) <= ADC_CLK_MAX
+		#define ADC_PRESC	6
+	#elif (F_CPU/128) <= ADC_CLK_MAX
+		#define ADC_PRESC	7
+	#else
+		#error "F_CPU is too high for the ADC clock"
+	#endif
+#endif
+
+#if (ADC_PRESC < 1) || (ADC_PRESC > 7)
+	#error "ADC_PRESC must be between 1 and 7"
+#endif
+
+#define ADC_CLK			((F_CPU) >> (ADC_PRESC))
+
+#if ADC_CLK > ADC_CLK_MAX
+	#error "ADC clock is too high, increase ADC_PRESC"
+#elif (ADC_CLK < ADC_CLK_MIN) && !ADC_FAST
+	#warning "ADC clock is under 50 KHz, conversions are slower than needed"
+#endif
+
+
+/**
+*	ADC Sleep Definitions
+*	Choose how ADC_GetValue() waits for a new conversion.
+*	ADC_SLEEP_IDLE stops the CPU clock until any interrupt.
+*	ADC_SLEEP_NOISE uses the ADC Noise Reduction mode: the I/O clocks are
+*	halted during the conversion, which lowers the current and the digital
+*	noise seen by the ADC. If no conversion is running, entering this mode 
+*	starts one. Keep in mind that the UART, the TWI master and Timer0/1 
+*	are stopped while sleeping in this mode.
+*	ADC_GetValue() does not enable the interrupts: with them disabled it 
+*	does not sleep, and the ISR can not fill the buffer.
+*
+*/
+#define ADC_SLEEP_NONE	0
+#define ADC_SLEEP_IDLE	1
+#define ADC_SLEEP_NOISE	2
+
+#ifndef ADC_SLEEP_MODE
+#define ADC_SLEEP_MODE	ADC_SLEEP_IDLE	/* NONE -- IDLE -- NOISE */
+#endif
+
+
+/**
+*	ADC Value Type
+*	Type of the values stored in the buffer for the selected mode.
+*
+*/
+#if ADC_MODE == TENBIT
+typedef uint16_t value_ADC;
+#define ADC_VALUE_MAX		0x3FF
+#elif ADC_MODE == EIGHTBIT
+typedef uint8_t value_ADC;
+#define ADC_VALUE_MAX		0xFF
+#endif
+
+
+/**
+*	ADC Watchdog Definitions
+*	When ADC_WATCHDOG is enabled (CONFIG.h), the ISR compares every conversion with
+*	the high and low thresholds of its channel (0-7) and raises an event 
+*	only when a threshold is crossed. The value has to go back past the 
+*	threshold by the hysteresis before the same event can be raised again.
+*	The hysteresis is saturated to the range of the values: with hyst 
+*	over high, the value can not leave the high zone.
+*	The channel is read from ADMUX, so change it with ADC_SetChannel()
+*	only between conversions.
+*
+*	With ADC_WD_PRETRIGGER > 0 (set in MEMCONF.h), the ISR also keeps the
+*	last ADC_WD_PRETRIGGER conversions in a history ring that always 
+*	overwrites its oldest value, full buffer or not. On a crossing the 
+*	history is frozen, like the trigger of an oscilloscope, and 
+*	ADC_GetCapture() unrolls it and releases it. The history has the 
+*	conversions of every channel, in the order of the ISR. After a 
+*	release it has to be filled again before the next capture: a 
+*	crossing meanwhile raises its event without a capture.
+*
+*/
+#define ADC_WD_CHANNELS		8
+
+#if ADC_WD_PRETRIGGER > 255
+	#error "ADC_WD_PRETRIGGER can not be bigger than 255"
+#endif
+
+#define ADC_EVT_HIGH		0x01		// Value went over the high threshold
+#define ADC_EVT_LOW			0x02		// Value went under the low threshold
+
+
+/**
+*	ADC Scan Definitions
+*	When ADC_SCAN is enabled (CONFIG.h), ADC_StartScan() converts a set 
+*	of channels (0-7) in turn without the CPU: the ISR keeps the last 
+*	value of each channel, selects the next channel of the set and 
+*	starts its conversion, so the ADC never waits for the main loop. The
+*	values of the scan do not go to the buffer of ADC_GetValue(). 
+*	ADC_Stop() ends the scan after the current conversion.
+*
+*/
+#define ADC_SCAN_CHANNELS	8
+
+
+/**
+*	ADC Stream Definitions
+*	With ADC_STREAM enabled (CONFIG.h), the ISR gives the conversions to 
+*	ADCSTREAM.c while the stream is started, to be sent through the UART
+*	in blocks.
+*
+*/
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Configure the ADC clock with ADC_PRESC, the voltage reference on AVCC
+ 			and the channel ADC_CHANNEL (or adc_channel of EECONFIG_Data with
+ 			EECONFIG_ENABLE). Can be called again to reset the ADC.
+ @param		none
+ @return 	none
+*/
+void ADC_Init(void);
+
+
+/**
+ @brief		Change the channel of the next conversions. The other settings
+ 			are kept. Calling it with the current channel has no effect.
+ @param		channel 	0-7, ADC_CH_TEMP, ADC_CH_BANDGAP or ADC_CH_GND
+ @return 	none
+*/
+void ADC_SetChannel(uint8_t channel);
+
+
+/**
+ @brief		Channel of the next conversions. 
+ @param		none
+ @return 	0-7, ADC_CH_TEMP, ADC_CH_BANDGAP or ADC_CH_GND
+*/
+uint8_t ADC_GetChannel(void);
+
+
+/**
+ @brief		Discard the unread values of the buffer. 
+ @param		none
+ @return 	none
+*/
+void ADC_Flush(void);
+
+
+/**
+ @brief		Start the ADC conversion. 
+ @param		none
+ @return 	none
+*/
+void ADC_Start(void);
+
+
+/**
+ @brief		Start the conversions in Free Running mode. Each conversion starts
+ 			when the previous one finishes, without CPU intervention.
+ @param		none
+ @return 	none
+*/
+void ADC_StartAuto(void);
+
+
+/**
+ @brief		Stop the Free Running mode or the scan. The current conversion 
+ 			is finished. 
+ @param		none
+ @return 	none
+*/
+void ADC_Stop(void);
+
+
+/**
+ @brief		Check that ADC_GetValue() can get new values: the ADC was 
+ 			initialized and, with ADC_STREAM, the stream is stopped.
+ @param		none
+ @return 	1 if the buffer is filled by the ISR, 0 if not
+*/
+uint8_t ADC_Ready(void);
+
+
+/**
+ @brief		Number of unread values in the buffer. Does not wait. 
+ @param		none
+ @return 	values that ADC_GetValue() can return without waiting
+*/
+uint8_t ADC_Available(void);
+
+
+/**
+ @brief		Wait for the ADC to finish the conversion.
+ @param		none
+ @return 	Value of the conversion.
+*/
+value_ADC ADC_GetValue(void);
+
+
+#if ADC_SCAN
+/**
+ @brief		Start the scan of a set of channels, from the lowest one. The 
+ 			values of an older scan are discarded.
+ @param		channels 	One bit per channel 0-7, not 0
+ @return 	none
+*/
+void ADC_StartScan(uint8_t channels);
+
+/**
+ @brief		Channels of the scan with a new value since their last 
+ 			ADC_GetScan(). Cheap to poll from the main loop.
+ @param		none
+ @return 	One bit per channel
+*/
+uint8_t ADC_ScanChannels(void);
+
+/**
+ @brief		Last value of a channel of the scan. Does not wait. 
+ @param		channel 	channel 0-7
+ @return 	Last conversion of the channel, 0 if it has none
+*/
+value_ADC ADC_GetScan(uint8_t channel);
+#endif
+
+
+#if ADC_WATCHDOG
+/**
+ @brief		Set the thresholds of a channel and clear its events. To disable 
+ 			a threshold use 0 for low or the maximum value for high.
+ @param		channel 	channel 0-7
+ 			low 		an event is raised when the value goes under low
+ 			high 		an event is raised when the value goes over high
+ 			hyst 		hysteresis to leave the low or high zone
+ @return 	none
+*/
+void ADC_SetThreshold(uint8_t channel, value_ADC low, value_ADC high, value_ADC hyst);
+
+/**
+ @brief		Read and clear the events of a channel. 
+ @param		channel 	channel 0-7
+ @return 	ADC_EVT_HIGH and/or ADC_EVT_LOW, 0 if nothing happened
+*/
+uint8_t ADC_GetEvents(uint8_t channel);
+
+/**
+ @brief		Channels with pending events. Cheap to poll from the main loop.
+ @param		none
+ @return 	One bit per channel
+*/
+uint8_t ADC_EventChannels(void);
+
+#if ADC_WD_PRETRIGGER
+/**
+ @brief		Copy the frozen history and release it for a new trigger. 
+ @param		buf 	ADC_WD_PRETRIGGER values, oldest first. The last one 
+ 						crossed the threshold
+ @return 	Channel of the capture, 0xFF if there is no capture
+*/
+uint8_t ADC_GetCapture(value_ADC* buf);
+#endif
+#endif
+
 #endif /* ADC_H_ */ 
\ No newline at end of file
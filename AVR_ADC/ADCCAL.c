@@ -0,0 +1,174 @@
+/*************************************************************************
+ Title	:   ADC calibration library (ADCCAL.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Calibration routines for the ADC library.
+
+       The internal 1.1V reference is measured against AVCC to obtain the
+       real VCC. The offset and gain corrections are stored in the EEPROM.
+       Both are folded into one fixed-point multiplier, so the conversion
+       to millivolts only needs a multiplication and a shift.
+
+ USAGE
+       See the C include ADCCAL.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include "../AVR_CONFIG/CONFIG.h"			/* F_CPU for <util/delay.h> */
+#include <util/delay.h>
+#include "ADC.h"
+#include "ADCCAL.h"
+
+
+/* Static Variables */
+static calib_ADCCAL EEMEM ADCCAL_Stored;
+static calib_ADCCAL ADCCAL_Data;
+static uint16_t ADCCAL_Vcc = ADCCAL_VCC_MV;
+static uint32_t ADCCAL_Mult;
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Compute the multiplier used by ADCCAL_ToMillivolts().
+Input:    none
+Returns:  none
+*************************************************************************/
+static void ADCCAL_Update(void)
+{
+	ADCCAL_Mult = ((uint32_t)ADCCAL_Vcc * ADCCAL_Data.gain * 4) / ADCCAL_FULL_SCALE;
+}
+
+/*************************************************************************
+Average ADCCAL_SAMPLES conversions of the internal reference. 
+Input:    none
+Returns:  Sum of the conversions, 0 if the ADC can not be used
+*************************************************************************/
+static uint32_t ADCCAL_ReadBandgap(void)
+{
+	uint8_t channel = ADC_GetChannel();
+	uint32_t sum = 0;
+	uint8_t i;
+	
+	/* ADC_GetValue() would wait forever for the buffer */
+	if (!ADC_Ready())
+		return 0;
+	
+	/* Stop the Free Running mode and wait for the last conversion */
+	ADC_Stop();
+	while (ADCSRA & (1<<ADSC));
+	
+	/* The reference needs about 1 ms to settle after the switch */
+	ADC_SetChannel(ADC_CH_BANDGAP);
+	_delay_ms(1);
+	ADC_Flush();
+	
+	/* First conversion is discarded */
+	ADC_Start();
+	ADC_GetValue();
+	for (i = 0; i < ADCCAL_SAMPLES; i++)
+	{
+		ADC_Start();
+		sum += ADC_GetValue();
+	}
+	
+	ADC_SetChannel(channel);
+	return sum;
+}
+
+/*************************************************************************
+Load the calibration from the EEPROM and compute the multiplier.
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADCCAL_Init(void)
+{
+	eeprom_read_block(&ADCCAL_Data, &ADCCAL_Stored, sizeof(calib_ADCCAL));
+	
+	/* Erased or old EEPROM: defaults */
+	if (ADCCAL_Data.magic != ADCCAL_MAGIC)
+	{
+		ADCCAL_Data.magic = ADCCAL_MAGIC;
+		ADCCAL_Data.bandgap_mv = ADCCAL_BANDGAP_MV;
+		ADCCAL_Data.offset = 0;
+		ADCCAL_Data.gain = ADCCAL_GAIN_ONE;
+	}
+	
+	ADCCAL_Update();
+}
+
+/*************************************************************************
+Measure the internal reference against AVCC to obtain VCC.
+	VCC = bandgap * FULL_SCALE / value
+Input:    none
+Returns:  VCC in millivolts
+*************************************************************************/
+uint16_t ADCCAL_MeasureVcc(void)
+{
+	uint32_t sum = ADCCAL_ReadBandgap();
+	
+	if (sum != 0)
+		ADCCAL_Vcc = ((uint32_t)ADCCAL_Data.bandgap_mv * ADCCAL_FULL_SCALE * ADCCAL_SAMPLES) / sum;
+	
+	ADCCAL_Update();
+	return ADCCAL_Vcc;
+}
+
+/*************************************************************************
+Measure the internal reference with a known VCC and store it.
+	bandgap = VCC * value / FULL_SCALE
+Input:    vcc_mv 	VCC in millivolts
+Returns:  Internal reference in millivolts
+*************************************************************************/
+uint16_t ADCCAL_CalibrateBandgap(uint16_t vcc_mv)
+{
+	uint32_t sum = ADCCAL_ReadBandgap();
+	
+	if (sum == 0)
+		return 0;
+	
+	ADCCAL_Data.bandgap_mv = ((uint32_t)vcc_mv * sum) / (ADCCAL_FULL_SCALE * ADCCAL_SAMPLES);
+	eeprom_update_block(&ADCCAL_Data, &ADCCAL_Stored, sizeof(calib_ADCCAL));
+	
+	ADCCAL_Vcc = vcc_mv;
+	ADCCAL_Update();
+	return ADCCAL_Data.bandgap_mv;
+}
+
+/*************************************************************************
+Set the offset and gain corrections and store them.
+Input:    offset 	offset in ADC counts
+		  gain 		gain correction, Q2.14
+Returns:  none
+*************************************************************************/
+void ADCCAL_SetCorrection(int16_t offset, uint16_t gain)
+{
+	ADCCAL_Data.offset = offset;
+	ADCCAL_Data.gain = gain;
+	eeprom_update_block(&ADCCAL_Data, &ADCCAL_Stored, sizeof(calib_ADCCAL));
+	
+	ADCCAL_Update();
+}
+
+/*************************************************************************
+Convert a value of the ADC to millivolts.
+Input:    value 	value of the ADC
+Returns:  Corrected millivolts
+*************************************************************************/
+uint16_t ADCCAL_ToMillivolts(value_ADC value)
+{
+	int16_t counts = (int16_t)value - ADCCAL_Data.offset;
+	
+	if (counts <= 0)
+		return 0;
+	
+	return ((uint32_t)counts * ADCCAL_Mult) >> 16;
+}
@@ -0,0 +1,114 @@
+#ifndef ADCCAL_H_
+#define ADCCAL_H_
+
+/*************************************************************************
+ Title	:   C include file for the ADC calibration library (ADCCAL.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Calibration routines for the ADC library.
+
+       The internal 1.1V reference is measured against AVCC to obtain the
+       real VCC. The offset and gain corrections are stored in the EEPROM.
+       Both are folded into one fixed-point multiplier, so the conversion
+       to millivolts only needs a multiplication and a shift:
+
+           mV = ((value - offset) * ADCCAL_Mult) >> 16
+           ADCCAL_Mult = VCC[mV] * gain * 4 / ADCCAL_FULL_SCALE
+
+       where gain is in Q2.14 format (16384 = 1.0).
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "ADC.h"
+
+
+/**
+*	Calibration Definitions
+*	Full scale of the ADC for the selected mode and default values used 
+*	while the EEPROM has no valid calibration.
+*
+*/
+#if ADC_MODE == TENBIT
+#define ADCCAL_FULL_SCALE	1024UL
+#elif ADC_MODE == EIGHTBIT
+#define ADCCAL_FULL_SCALE	256UL
+#endif
+
+#define ADCCAL_GAIN_ONE		16384		// Gain 1.0 in Q2.14
+#define ADCCAL_BANDGAP_MV	1100		// Nominal internal reference
+#define ADCCAL_VCC_MV		5000		// VCC until ADCCAL_MeasureVcc()
+
+#ifndef ADCCAL_SAMPLES
+#define ADCCAL_SAMPLES		8			/* Averaged bandgap conversions */
+#endif
+
+
+/**
+*	Calibration Data
+*	Values stored in the EEPROM. 
+*
+*/
+typedef struct
+{
+	uint16_t magic;				// ADCCAL_MAGIC if the data is valid
+	uint16_t bandgap_mv;		// Real value of the internal reference
+	int16_t offset;				// Offset in ADC counts
+	uint16_t gain;				// Gain correction, Q2.14
+} calib_ADCCAL;
+
+#define ADCCAL_MAGIC		0xCA1B
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Load the calibration from the EEPROM, or the defaults if it is not 
+ 			valid, and compute the multiplier. ADC_Init() has to be called first.
+ @param		none
+ @return 	none
+*/
+void ADCCAL_Init(void);
+
+/**
+ @brief		Measure the internal reference against AVCC to obtain VCC and 
+ 			update the multiplier. The current channel is restored and 
+ 			unread values of the ADC buffer are discarded. Nothing is 
+ 			measured if ADC_Ready() is 0 (ADC not initialized or stream 
+ 			running). The interrupts have to be enabled.
+ @param		none
+ @return 	VCC in millivolts, the previous value if nothing was measured
+*/
+uint16_t ADCCAL_MeasureVcc(void);
+
+/**
+ @brief		Measure the internal reference when VCC is known (e.g. with a 
+ 			multimeter) and store its real value in the EEPROM. Like 
+ 			ADCCAL_MeasureVcc(), it needs ADC_Ready().
+ @param		vcc_mv 	VCC in millivolts
+ @return 	Internal reference in millivolts, 0 if nothing was measured
+*/
+uint16_t ADCCAL_CalibrateBandgap(uint16_t vcc_mv);
+
+/**
+ @brief		Set the offset and gain corrections and store them in the EEPROM.
+ @param		offset 	offset in ADC counts, subtracted from every value
+ 			gain 	gain correction in Q2.14 (ADCCAL_GAIN_ONE = 1.0)
+ @return 	none
+*/
+void ADCCAL_SetCorrection(int16_t offset, uint16_t gain);
+
+/**
+ @brief		Convert a value of the ADC to millivolts. No division is used.
+ @param		value 	value returned by ADC_GetValue()
+ @return 	Corrected millivolts, 0 if the value is under the offset
+*/
+uint16_t ADCCAL_ToMillivolts(value_ADC value);
+
+
+#endif /* ADCCAL_H_ */
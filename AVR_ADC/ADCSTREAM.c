@@ -0,0 +1,163 @@
+/*************************************************************************
+ Title	:   ADC streaming library (ADCSTREAM.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Streams the conversions of the ADC through the UART in binary 
+       blocks of 4 samples in 5 bytes, with sequence numbers and CRC.
+
+ USAGE
+       See the C include ADCSTREAM.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include "ADC.h"
+#include "ADCSTREAM.h"
+#include "../AVR_UART/UART.h"
+
+
+/* Static Variables */
+static uint8_t ADCSTREAM_Block[2][ADCSTREAM_BLOCK] MEM_SECTION;
+static uint8_t* ADCSTREAM_Pos;					// Next byte of the payload
+static uint8_t ADCSTREAM_Fill;					// Block being filled
+static uint8_t ADCSTREAM_Count;					// Samples in the current group
+static uint8_t ADCSTREAM_Groups;				// Complete groups of the block
+static uint8_t ADCSTREAM_High;					// Bits 9:8 of the group
+static uint8_t ADCSTREAM_Crc;
+static uint8_t ADCSTREAM_Seq;
+static volatile uint16_t ADCSTREAM_Drops;
+static volatile uint8_t ADCSTREAM_Active;
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Prepare the block to be filled with the next sequence number.
+Input:    none
+Returns:  none
+*************************************************************************/
+static void ADCSTREAM_NewBlock(void)
+{
+	uint8_t* block = ADCSTREAM_Block[ADCSTREAM_Fill];
+	
+	block[0] = ADCSTREAM_SYNC1;
+	block[1] = ADCSTREAM_SYNC2;
+	block[2] = ADCSTREAM_Seq;
+	block[3] = ADCSTREAM_GROUPS;
+	ADCSTREAM_Crc = _crc_ibutton_update(0, ADCSTREAM_Seq);
+	ADCSTREAM_Crc = _crc_ibutton_update(ADCSTREAM_Crc, ADCSTREAM_GROUPS);
+	
+	ADCSTREAM_Pos = &block[ADCSTREAM_HEADER];
+	ADCSTREAM_Count = 0;
+	ADCSTREAM_Groups = 0;
+	ADCSTREAM_High = 0;
+}
+
+/*************************************************************************
+Start packing the conversions.
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADCSTREAM_Start(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADCSTREAM_Seq = 0;
+		ADCSTREAM_Drops = 0;
+		ADCSTREAM_Fill = 0;
+		ADCSTREAM_NewBlock();
+		ADCSTREAM_Active = 1;
+	}
+}
+
+/*************************************************************************
+Stop packing the conversions.
+Input:    none
+Returns:  none
+*************************************************************************/
+void ADCSTREAM_Stop(void)
+{
+	ADCSTREAM_Active = 0;
+}
+
+/*************************************************************************
+State of the stream.
+Input:    none
+Returns:  1 if the conversions are packed
+*************************************************************************/
+uint8_t ADCSTREAM_Running(void)
+{
+	return ADCSTREAM_Active;
+}
+
+/*************************************************************************
+Number of blocks dropped because the UART was busy.
+Input:    none
+Returns:  Dropped blocks
+*************************************************************************/
+uint16_t ADCSTREAM_Dropped(void)
+{
+	uint16_t drops;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		drops = ADCSTREAM_Drops;
+	}
+	return drops;
+}
+
+/*************************************************************************
+Pack one conversion. The low byte is stored at once, the 2 high bits are
+collected and stored after the fourth sample of the group. A complete
+block is handed to the UART and the other block starts to fill.
+Input:    value 	conversion
+Returns:  1 if the value was taken by the stream
+*************************************************************************/
+uint8_t ADCSTREAM_Sample(uint16_t value)
+{
+	uint8_t* pos;
+	
+	if (!ADCSTREAM_Active)
+		return 0;
+	
+	/* Low byte */
+	pos = ADCSTREAM_Pos;
+	*pos++ = (uint8_t)value;
+	ADCSTREAM_Crc = _crc_ibutton_update(ADCSTREAM_Crc, (uint8_t)value);
+	
+	/* High bits, the first sample ends at bits 1:0 */
+	ADCSTREAM_High = (ADCSTREAM_High >> 2) | ((uint8_t)(value >> 2) & 0xC0);
+	if (++ADCSTREAM_Count == 4)
+	{
+		*pos++ = ADCSTREAM_High;
+		ADCSTREAM_Crc = _crc_ibutton_update(ADCSTREAM_Crc, ADCSTREAM_High);
+		ADCSTREAM_Count = 0;
+		ADCSTREAM_High = 0;
+		
+		if (++ADCSTREAM_Groups == ADCSTREAM_GROUPS)
+		{
+			*pos = ADCSTREAM_Crc;
+			
+			/* Send the block, the other one is filled meanwhile */
+			if (USART_TransmitBlock(ADCSTREAM_Block[ADCSTREAM_Fill], ADCSTREAM_BLOCK))
+				ADCSTREAM_Fill ^= 1;
+			else
+				ADCSTREAM_Drops++;
+			
+			ADCSTREAM_Seq++;
+			ADCSTREAM_NewBlock();
+			return 1;
+		}
+	}
+	ADCSTREAM_Pos = pos;
+	
+	return 1;
+}
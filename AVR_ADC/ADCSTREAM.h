@@ -0,0 +1,103 @@
+#ifndef ADCSTREAM_H_
+#define ADCSTREAM_H_
+
+/*************************************************************************
+ Title	:   C include file for the ADC streaming library (ADCSTREAM.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Streams the conversions of the ADC through the UART in binary 
+       blocks. Requires ADC_STREAM = 1 and the 10 bits mode.
+
+       The ADC ISR packs each value into the current block. When a block 
+       is complete it is handed to USART_TransmitBlock() and the other 
+       block starts to fill, so the main loop has no work per sample.
+       If the UART is still sending the previous block, the new block is
+       dropped, but its sequence number is used anyway: the receiver 
+       detects lost blocks by the gaps in the sequence.
+
+       Block format:
+           0xA5 0x5A              Sync bytes
+           seq                    Sequence number, +1 every block
+           groups                 Number of 5-byte groups (ADCSTREAM_GROUPS)
+           groups x 5 bytes       4 samples per group:
+                                    byte 0-3  low 8 bits of samples 0-3
+                                    byte 4    bits 9:8 of sample n at bits 2n+1:2n
+           crc                    CRC-8 (Dallas/Maxim, _crc_ibutton_update)
+                                  from seq to the last group, initial value 0
+
+       AVR_TEST/STREAMDEC.c is a decoder of this format for the PC.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "ADC.h"
+
+#if ADC_MODE != TENBIT
+	#error "ADCSTREAM needs ADC_MODE TENBIT"
+#endif
+
+
+/**
+*	Stream Block Definitions
+*	ADCSTREAM_GROUPS (set in MEMCONF.h) is the number of 5-byte groups of
+*	4 samples of every block. The block has 5 bytes more for the header 
+*	and the CRC, and two blocks are used.
+*
+*/
+#define ADCSTREAM_SYNC1		0xA5
+#define ADCSTREAM_SYNC2		0x5A
+#define ADCSTREAM_HEADER	4
+#define ADCSTREAM_PAYLOAD	(ADCSTREAM_GROUPS * 5)
+#define ADCSTREAM_BLOCK		(ADCSTREAM_HEADER + ADCSTREAM_PAYLOAD + 1)
+
+#if ADCSTREAM_BLOCK > 255
+	#error "ADCSTREAM_GROUPS is too big for USART_TransmitBlock()"
+#endif
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Start packing the conversions. The sequence restarts at 0.
+ 			Start the conversions with ADC_StartAuto() or ADC_Start().
+ 			The ADC buffer and the watchdog are not used while streaming.
+ @param		none
+ @return 	none
+*/
+void ADCSTREAM_Start(void);
+
+/**
+ @brief		Stop packing the conversions. An incomplete block is discarded.
+ @param		none
+ @return 	none
+*/
+void ADCSTREAM_Stop(void);
+
+/**
+ @brief		State of the stream. While it runs, ADC_GetValue() gets no values.
+ @param		none
+ @return 	1 between ADCSTREAM_Start() and ADCSTREAM_Stop()
+*/
+uint8_t ADCSTREAM_Running(void);
+
+/**
+ @brief		Number of blocks dropped because the UART was busy.
+ @param		none
+ @return 	Dropped blocks since ADCSTREAM_Start()
+*/
+uint16_t ADCSTREAM_Dropped(void);
+
+/**
+ @brief		Pack one conversion. Called by the ADC ISR.
+ @param		value 	conversion
+ @return 	1 if the value was taken by the stream, 0 if it is stopped
+*/
+uint8_t ADCSTREAM_Sample(uint16_t value);
+
+
+#endif /* ADCSTREAM_H_ */
@@ -0,0 +1,133 @@
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+/*************************************************************************
+ Title	:   C include file for the build options of the libraries
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Feature switches shared by the libraries, in one place.
+
+       Every header of the libraries that needs one of these options 
+       includes this file first, so all the files of a build see the same
+       values whatever their include order. MEMCONF.h uses them to count
+       the RAM of the enabled libraries only.
+
+       Each value can be changed here or supplied with -D for each build.
+
+*****************************************************************************/
+
+
+/**
+*	CPU Clock
+*	F_CPU of every library and of the C++ templates: the baud rates, the
+*	TWI bit rate, the ADC prescaler and the delays are solved from it.
+*	Normally supplied with -D, the default is the internal 8 MHz RC.
+*
+*/
+#ifndef F_CPU
+#define F_CPU				8000000UL
+#endif
+
+
+/**
+*	Driver Defaults
+*	Parameters of the drivers that EECONFIG_Data can also hold: the baud
+*	rate of AVR_UART (MYUBRR is its divisor in 2X mode), the channel of 
+*	AVR_ADC, the address of the LCD adapter and the type of the RGB Led.
+*	Without EECONFIG_ENABLE they are the only values. EECONFIG.c takes 
+*	its defaults from here, without the headers of the drivers.
+*
+*/
+#ifndef UART_BAUD_RATE
+#define UART_BAUD_RATE		9600
+#endif
+#define MYUBRR				(((F_CPU) + 4UL*(UART_BAUD_RATE))/(8UL*(UART_BAUD_RATE)) - 1)
+
+#ifndef ADC_CHANNEL
+#define ADC_CHANNEL			1			/* 0-7 or an internal channel of ADC.h */
+#endif
+
+#ifndef LCD_Add
+#define LCD_Add				0x27		/* I2C adapter of the LCD, or 0x3F */
+#endif
+
+#define COMMON_ANODE		0
+#define COMMON_CATHODE		1
+
+#ifndef TYPE_RGB
+#define TYPE_RGB			COMMON_CATHODE
+#endif
+
+
+/**
+*	ADC Mode
+*	ADC_MODE of AVR_ADC: TENBIT for the full precision, EIGHTBIT for one
+*	byte per value (left adjusted result, ADCH only).
+*
+*/
+#define TENBIT				0
+#define EIGHTBIT			1
+
+#ifndef ADC_MODE
+#define ADC_MODE			TENBIT		/* TENBIT -- EIGHTBIT */
+#endif
+
+
+/**
+*	ADC Features
+*	ADC_WATCHDOG compiles the thresholds and the capture of AVR_ADC. 
+*	ADC_SCAN compiles the channel scan of AVR_ADC, needed by 
+*	AVR_DASHBOARD. ADC_STREAM hands the conversions to ADCSTREAM.c, 
+*	which has to be linked.
+*
+*/
+#ifndef ADC_WATCHDOG
+#define ADC_WATCHDOG		0			/* 1: evaluate thresholds in the ISR */
+#endif
+#ifndef ADC_SCAN
+#define ADC_SCAN			0			/* 1: rotate the channels in the ISR */
+#endif
+#ifndef ADC_STREAM
+#define ADC_STREAM			0			/* 1: link ADCSTREAM.c */
+#endif
+
+
+/**
+*	Instrumentation
+*	TRACE_ENABLE compiles the event ring of AVR_TRACE and STATS_ENABLE 
+*	the counters of AVR_STATS. With 0 their macros are empty and the 
+*	other libraries have no overhead.
+*
+*/
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE		0
+#endif
+#ifndef STATS_ENABLE
+#define STATS_ENABLE		0
+#endif
+
+
+/**
+*	Optional Libraries
+*	Set to 1 for each of these libraries that is linked. Their buffers 
+*	are only counted by MEMCONF.h when enabled, and their source files 
+*	do not build without it. 
+*	With EECONFIG_ENABLE the drivers take their parameters from 
+*	EECONFIG_Data at init and EECONFIG_Init() has to be called first.
+*
+*/
+#ifndef SWUART_ENABLE
+#define SWUART_ENABLE		0
+#endif
+#ifndef SHELL_ENABLE
+#define SHELL_ENABLE		0
+#endif
+#ifndef EECONFIG_ENABLE
+#define EECONFIG_ENABLE		0
+#endif
+
+
+#endif /* CONFIG_H_ */
@@ -0,0 +1,58 @@
+#ifndef SLEEPWAIT_H_
+#define SLEEPWAIT_H_
+
+/*************************************************************************
+ Title	:   C include file for the sleep waits of the libraries
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       The wait loop shared by the drivers that sleep instead of spinning
+       (UART, SWUART, ADC, I2C and the C++ Uart<>).
+
+       The condition is checked with the interrupts disabled, and sei()
+       is followed by sleep_cpu(): sei() always executes the next
+       instruction, so an interrupt that changes the condition right
+       after the check wakes the CPU instead of being lost. The I bit of
+       the caller is kept. Called with the interrupts disabled, nothing
+       could wake the CPU, so the condition is polled without sleeping.
+
+ USAGE
+       SLEEP_WAIT_WHILE(USART_RxHead == USART_RxTail, SLEEP_MODE_IDLE);
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+
+/**
+*	Sleep Wait
+*	Sleep in mode (SLEEP_MODE_xxx of <avr/sleep.h>) while cond is true.
+*	cond is evaluated again after every wake-up, with the interrupts
+*	disabled.
+*
+*/
+#define SLEEP_WAIT_WHILE(cond, mode) \
+	do { \
+		uint8_t sleep_sreg = SREG; \
+		set_sleep_mode(mode); \
+		cli(); \
+		while (cond) \
+		{ \
+			if (sleep_sreg & (1 << SREG_I)) \
+			{ \
+				sleep_enable(); \
+				sei(); \
+				sleep_cpu(); \
+				sleep_disable(); \
+				cli(); \
+			} \
+		} \
+		SREG = sleep_sreg; \
+	} while (0)
+
+
+#endif /* SLEEPWAIT_H_ */
@@ -0,0 +1,175 @@
+#ifndef ADC_HPP_
+#define ADC_HPP_
+
+/*************************************************************************
+ Title	:   C++ include file for the ADC template
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x (-std=gnu++11)
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Template version of the ADC library (AVR_ADC).
+
+       The mode (10 or 8 bits) and the list of channels are template 
+       parameters. The type of the values follows the mode, so there is
+       one read function for both modes. The prescaler is solved like in
+       ADC.h.
+
+       Unlike ADC.c, the conversions are polled: there is no ADC_vect 
+       and no buffer. read() busy-waits the 13 ADC clocks of a conversion
+       (25 for the first one) where ADC_GetValue() sleeps until the ISR
+       stores the value, and a value is never queued for a later read.
+       There is no Free Running mode, ADC Noise Reduction sleep, watchdog
+       or stream, and each read selects its channel. It can be linked 
+       with ADC.c only if they do not convert at the same time.
+
+ USAGE
+       typedef avr::Adc<avr::EightBit, 0, 1, avr::ChTemp> Sensors;
+       Sensors::init();
+       uint8_t light = Sensors::read<1>();		// Channel 1
+
+*****************************************************************************/
+
+#include "AVRCPP.hpp"
+
+namespace avr
+{
+
+/**
+*	ADC Modes and Internal Channels
+*	Same values as ADC.h.
+*
+*/
+enum AdcMode
+{
+	TenBit,
+	EightBit
+};
+
+enum
+{
+	ChTemp = 8,					// Temperature sensor
+	ChBandgap = 14,				// Internal 1.1V reference
+	ChGnd = 15					// 0V (GND)
+};
+
+
+/**
+*	ADC Clock
+*	Smallest division factor (2^presc) that keeps the ADC clock under 
+*	200 KHz, 1 to 7.
+*
+*/
+constexpr uint8_t adcPrescaler(uint32_t cpu, uint8_t presc = 1)
+{
+	return (presc >= 7 || (cpu >> presc) <= 200000UL) ? presc : adcPrescaler(cpu, presc + 1);
+}
+
+
+/**
+*	Channel List
+*	Nth<I, Channels...>::Value is the I-th channel, solved at compile time.
+*
+*/
+template<uint8_t I, uint8_t First, uint8_t... Rest>
+struct Nth
+{
+	enum : uint8_t { Value = Nth<I - 1, Rest...>::Value };
+};
+
+template<uint8_t First, uint8_t... Rest>
+struct Nth<0, First, Rest...>
+{
+	enum : uint8_t { Value = First };
+};
+
+constexpr bool validChannels()
+{
+	return true;
+}
+
+template<class... T>
+constexpr bool validChannels(uint8_t ch, T... rest)
+{
+	return (ch <= ChTemp || ch == ChBandgap || ch == ChGnd) && validChannels(rest...);
+}
+
+
+/**
+*	ADC
+*	Mode: TenBit or EightBit. Channels: 0-7, ChTemp, ChBandgap or ChGnd.
+*
+*/
+template<AdcMode Mode, uint8_t... Channels>
+class Adc
+{
+	static_assert(sizeof...(Channels) > 0, "Adc needs at least one channel");
+	static_assert(validChannels(Channels...), "Adc channels must be 0-7, ChTemp, ChBandgap or ChGnd");
+	static_assert((F_CPU >> 7) <= 200000UL, "F_CPU is too high for the ADC clock");
+	
+	static const uint8_t Presc = adcPrescaler(F_CPU);
+	static const uint8_t Admux = (1 << REFS0) | (Mode == EightBit ? (1 << ADLAR) : 0);
+	
+	/* Unrolled at compile time, no channel table in RAM */
+	template<uint8_t I>
+	static void scanFrom(void*, Bool<true>) {}
+	
+	template<uint8_t I, class V>
+	static void scanFrom(V* values, Bool<false>)
+	{
+		values[I] = read<I>();
+		scanFrom<I + 1>(values, Bool<I + 1 == sizeof...(Channels)>());
+	}
+	
+public:
+	typedef typename Select<Mode == EightBit, uint8_t, uint16_t>::Type Value;
+	static const uint8_t Count = sizeof...(Channels);
+	
+	/**
+	 @brief		Reference on AVCC, prescaler, first channel selected.
+	*/
+	static void init()
+	{
+		ADMUX = Admux | (Nth<0, Channels...>::Value << MUX0);
+		ADCSRA = (1 << ADEN) | (Presc << ADPS0);
+	}
+	
+	/**
+	 @brief		Convert the I-th channel of the list and wait for the value.
+	*/
+	template<uint8_t I>
+	static Value read()
+	{
+		static_assert(I < sizeof...(Channels), "Adc channel index out of range");
+		return convert(Nth<I, Channels...>::Value);
+	}
+	
+	/**
+	 @brief		Convert every channel of the list, in order.
+	 @param		values 	Count values
+	*/
+	static void scan(Value* values)
+	{
+		scanFrom<0>(values, Bool<Count == 0>());
+	}
+	
+	/**
+	 @brief		Convert any channel and wait for the value.
+	*/
+	static Value convert(uint8_t channel)
+	{
+		ADMUX = Admux | ((channel & 0x0F) << MUX0);
+		ADCSRA |= (1 << ADSC);
+		while (ADCSRA & (1 << ADSC)) {}
+		if (Mode == EightBit)
+			return ADCH;
+		return ADC;
+	}
+};
+
+template<AdcMode Mode, uint8_t... Channels> const uint8_t Adc<Mode, Channels...>::Count;
+
+} // namespace avr
+
+
+#endif /* ADC_HPP_ */
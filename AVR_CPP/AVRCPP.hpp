@@ -0,0 +1,94 @@
+#ifndef AVRCPP_HPP_
+#define AVRCPP_HPP_
+
+/*************************************************************************
+ Title	:   C++ include file for the template facade of the libraries
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x (-std=gnu++11)
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Common definitions of the header-only C++ layer.
+
+       The configuration of each driver is given as template parameters 
+       instead of #defines, so two configurations can live in one binary.
+       Everything is static and inline: there are no objects, no virtual
+       functions and no heap. Each class is a compile-time configuration.
+
+       Include UART.hpp, ADC.hpp, RGBLED.hpp or LCDI2C.hpp of this folder.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+namespace avr
+{
+
+/**
+*	Port Definitions
+*	Registers of each I/O port as types, used as template parameters.
+*	The functions return the register itself, so the compiler emits the
+*	same sbi/cbi/out as the C macros.
+*
+*/
+#define AVRCPP_PORT(name, letter) \
+	struct name \
+	{ \
+		static volatile uint8_t& port() { return PORT##letter; } \
+		static volatile uint8_t& ddr()  { return DDR##letter; } \
+		static volatile uint8_t& pin()  { return PIN##letter; } \
+	};
+
+AVRCPP_PORT(PortB, B)
+AVRCPP_PORT(PortC, C)
+AVRCPP_PORT(PortD, D)
+
+#undef AVRCPP_PORT
+
+
+/**
+*	Type Selection
+*	Select(true, A, B)::Type is A, otherwise B. There is no <type_traits>
+*	in avr-libc.
+*
+*/
+template<bool Cond, class A, class B>
+struct Select
+{
+	typedef A Type;
+};
+
+template<class A, class B>
+struct Select<false, A, B>
+{
+	typedef B Type;
+};
+
+
+/**
+*	Compile-time Flag
+*	Bool<true> and Bool<false> are different types, used to end the 
+*	recursive templates.
+*
+*/
+template<bool B>
+struct Bool {};
+
+
+/**
+*	Buffer Checks
+*	The index math of the ring buffers needs powers of 2.
+*
+*/
+constexpr bool isPow2(uint16_t size)
+{
+	return (size >= 2) && (size <= 256) && ((size & (size - 1)) == 0);
+}
+
+} // namespace avr
+
+
+#endif /* AVRCPP_HPP_ */
@@ -0,0 +1,197 @@
+#ifndef LCDI2C_HPP_
+#define LCDI2C_HPP_
+
+/*************************************************************************
+ Title	:   C++ include file for the LCD - I2C adapter template
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x (-std=gnu++11)
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Template version of the LCD - I2C adapter library (AVR_LCDI2C).
+
+       The address of the PCF8574 and the geometry are template parameters,
+       so several displays can share the bus. Each type keeps its own 
+       shadow of the expander and its own cursor. The bus is driven by the
+       I2C library (AVR_I2C), call I2C_Init() first.
+
+ USAGE
+       typedef avr::Lcd<0x27, 16, 2> Status;
+       typedef avr::Lcd<0x3F, 20, 4> Panel;
+       I2C_Init();
+       Status::init();
+       Panel::init();
+       Status::print("Ready");
+
+*****************************************************************************/
+
+#include "AVRCPP.hpp"
+#include <stdlib.h>
+
+extern "C"
+{
+#include "../AVR_I2C/I2C.h"
+}
+
+namespace avr
+{
+
+/**
+*	LCD
+*	Addr: 7 bits address of the expander. Cols x Rows: geometry of the
+*	HD44780 display, checked like in LCDI2C.h.
+*
+*/
+template<uint8_t Addr, uint8_t Cols = 16, uint8_t Rows = 2>
+class Lcd
+{
+	static_assert(Addr < 0x80, "Lcd address must be a 7 bits address");
+	static_assert(Rows >= 1 && Rows <= 4 && Cols * ((Rows + 1) / 2) <= 40 && !(Rows > 2 && Cols > 20), 
+				  "Lcd Cols x Rows is not a valid HD44780 geometry");
+	
+	/* Pins of the expander and commands, same as LCDI2C.h */
+	enum : uint8_t
+	{
+		PinRS = (1 << 0),
+		PinE = (1 << 2),
+		PinBL = (1 << 3),
+		Cmd8Bit = 0x33,
+		Cmd4Bit = 0x32,
+		CmdClear = 0x01,
+		CmdDispOn = 0x0C,
+		CmdFunction = (Rows == 1) ? 0x20 : 0x28,
+		CmdDdram = 0x80
+	};
+	
+	static uint8_t Shadow;
+	static uint8_t Ctrl;
+	static uint8_t Row;
+	static uint8_t Col;
+	
+	static uint8_t offset(uint8_t row)
+	{
+		return (row & 1 ? 0x40 : 0x00) + (row & 2 ? Cols : 0);
+	}
+	
+	static void nibble(uint8_t data, uint8_t rs)
+	{
+		uint8_t bitmask = (data & 0xF0) | Ctrl | rs;
+		
+		/* RS has to be stable before E rises */
+		if ((Shadow ^ bitmask) & PinRS)
+			I2C_Transmit(bitmask);
+		I2C_Transmit(bitmask | PinE);
+		I2C_Transmit(bitmask);
+		Shadow = bitmask;
+	}
+	
+	static void send(uint8_t data, uint8_t rs)
+	{
+		I2C_Start(I2C_ADD_WR(Addr));
+		nibble(data, rs);
+		nibble(data << 4, rs);
+		I2C_Stop();
+	}
+	
+public:
+	/**
+	 @brief		Initialize the display in 4 bits mode and clear it.
+	*/
+	static void init()
+	{
+		command(Cmd8Bit);
+		command(Cmd4Bit);
+		command(CmdFunction);
+		command(CmdDispOn);
+		clear();
+	}
+	
+	/**
+	 @brief		Send a command (LCD_xxx of LCDI2C.h).
+	*/
+	static void command(uint8_t cmd)
+	{
+		send(cmd, 0);
+	}
+	
+	/**
+	 @brief		Clear the display and move the cursor to the start.
+	*/
+	static void clear()
+	{
+		command(CmdClear);
+		Row = 0;
+		Col = 0;
+	}
+	
+	/**
+	 @brief		Move the cursor. Rows out of the display are ignored.
+	 @param		row 	1 to Rows
+	 			col 	0 to Cols - 1
+	*/
+	static void gotoXY(uint8_t row, uint8_t col)
+	{
+		if (row == 0 || row > Rows)
+			return;
+		Row = row - 1;
+		Col = col;
+		command(CmdDdram | (offset(Row) + col));
+	}
+	
+	/**
+	 @brief		Put a char, at the end of a row continue on the next one.
+	*/
+	static void putChar(char c)
+	{
+		if (Col >= Cols)
+			gotoXY((Row + 1) % Rows + 1, 0);
+		send(c, PinRS);
+		Col++;
+	}
+	
+	/**
+	 @brief		Put a null terminated string.
+	*/
+	static void print(const char* s)
+	{
+		while (*s)
+			putChar(*s++);
+	}
+	
+	/**
+	 @brief		Put a number.
+	*/
+	static void print(uint16_t number)
+	{
+		char array[6];				// 5 digits of the number and the null char
+		utoa(number, array, 10);
+		print(array);
+	}
+	
+	/**
+	 @brief		Turn the backlight on or off, only written if it changes.
+	*/
+	static void backlight(bool on)
+	{
+		uint8_t bitmask;
+		
+		Ctrl = on ? PinBL : 0;
+		bitmask = (Shadow & ~PinBL) | Ctrl;
+		if (bitmask == Shadow)
+			return;
+		I2C_Start(I2C_ADD_WR(Addr));
+		I2C_Transmit(bitmask);
+		I2C_Stop();
+		Shadow = bitmask;
+	}
+};
+
+template<uint8_t Addr, uint8_t Cols, uint8_t Rows> uint8_t Lcd<Addr, Cols, Rows>::Shadow = 0xFF;
+template<uint8_t Addr, uint8_t Cols, uint8_t Rows> uint8_t Lcd<Addr, Cols, Rows>::Ctrl = (1 << 3);
+template<uint8_t Addr, uint8_t Cols, uint8_t Rows> uint8_t Lcd<Addr, Cols, Rows>::Row;
+template<uint8_t Addr, uint8_t Cols, uint8_t Rows> uint8_t Lcd<Addr, Cols, Rows>::Col;
+
+} // namespace avr
+
+
+#endif /* LCDI2C_HPP_ */
@@ -0,0 +1,149 @@
+#ifndef RGBLED_HPP_
+#define RGBLED_HPP_
+
+/*************************************************************************
+ Title	:   C++ include file for the RGB-Led template
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x (-std=gnu++11)
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Template version of the RGB-Led library (AVR_RGBLED).
+
+       The port, the pins and the type of the Led are template parameters,
+       so several Leds can be used. The masks are solved at compile time 
+       and each color is one read-modify-write of the port, with the 
+       interrupts disabled.
+
+ USAGE
+       typedef avr::RgbPins<avr::PortD, 3, 4, 5> Pins;
+       typedef avr::RgbLed<Pins, avr::CommonCathode> Led;
+       Led::init();
+       Led::color(avr::Yellow);
+
+*****************************************************************************/
+
+#include "AVRCPP.hpp"
+#include <avr/interrupt.h>
+
+namespace avr
+{
+
+/**
+*	RGB Type Definitions
+*	The 2 types of RGB Led.
+*
+*/
+enum Polarity
+{
+	CommonAnode,				// Pin low turns the color on
+	CommonCathode				// Pin high turns the color on
+};
+
+/**
+*	RGB Colors
+*	Colors that the LED can shown, same order as RGBLED.h. 
+*
+*/
+enum Color
+{
+	Red,
+	Green,
+	Blue,
+	Yellow,
+	Cyan,
+	Magenta,
+	White,
+	Off
+};
+
+
+/**
+*	RGB Pins
+*	Port and pins of the Led.
+*
+*/
+template<class Port, uint8_t PinR, uint8_t PinG, uint8_t PinB>
+struct RgbPins
+{
+	static_assert(PinR < 8 && PinG < 8 && PinB < 8, "RGB pins must be 0-7");
+	
+	typedef Port PortType;
+	enum : uint8_t
+	{
+		R = (1 << PinR),
+		G = (1 << PinG),
+		B = (1 << PinB),
+		All = R | G | B
+	};
+};
+
+
+/**
+*	RGB Led
+*	Pins: RgbPins<...>. Pol: CommonAnode or CommonCathode.
+*
+*/
+template<class Pins, Polarity Pol>
+class RgbLed
+{
+public:
+	/**
+	 @brief		Turn off the pins and configure them as output.
+	*/
+	static void init()
+	{
+		write(0);
+		Pins::PortType::ddr() |= Pins::All;
+	}
+	
+	/**
+	 @brief		Change the color of the Led. With a constant color the 
+	 			mask is solved at compile time.
+	 @param		c 	color the led will shown
+	*/
+	static void color(Color c)
+	{
+		write(mask(c));
+	}
+	
+	/**
+	 @brief		Turn on the pins of mask and off the others.
+	 @param		on 	Pins::R, Pins::G and/or Pins::B
+	*/
+	static void write(uint8_t on)
+	{
+		uint8_t sreg = SREG;
+		uint8_t value;
+		
+		/* An ISR writing the other pins between the read and the write 
+		   would be undone */
+		cli();
+		value = Pins::PortType::port() & ~Pins::All;
+		if (Pol == CommonCathode)
+			value |= on;
+		else
+			value |= Pins::All & ~on;
+		Pins::PortType::port() = value;
+		SREG = sreg;
+	}
+	
+	/**
+	 @brief		Pins of a color.
+	*/
+	static constexpr uint8_t mask(Color c)
+	{
+		return c == Red     ? Pins::R :
+		       c == Green   ? Pins::G :
+		       c == Blue    ? Pins::B :
+		       c == Yellow  ? (Pins::R | Pins::G) :
+		       c == Cyan    ? (Pins::G | Pins::B) :
+		       c == Magenta ? (Pins::R | Pins::B) :
+		       c == White   ? Pins::All : 0;
+	}
+};
+
+} // namespace avr
+
+
+#endif /* RGBLED_HPP_ */
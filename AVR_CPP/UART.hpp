@@ -0,0 +1,175 @@
+#ifndef UART_HPP_
+#define UART_HPP_
+
+/*************************************************************************
+ Title	:   C++ include file for the UART template
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x (-std=gnu++11)
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Template version of the UART library (AVR_UART).
+
+       Same 2X mode, ring buffers and Idle sleep waits as UART.c. The size
+       of the buffers and the baud rate are template parameters. UBRR 
+       and its error are solved at compile time, a rate with more than 
+       2% of error does not compile.
+
+       The USART has only one pair of vectors: AVRCPP_UART_ISR(type) has 
+       to be written once, in one .cpp file, and UART.c can not be linked
+       in the same program.
+
+ USAGE
+       typedef avr::Uart<32, 38400> Serial;
+       AVRCPP_UART_ISR(Serial)
+       ...
+       Serial::init();
+       sei();
+       Serial::transmit(Serial::receive());
+
+*****************************************************************************/
+
+#include "AVRCPP.hpp"
+#include <avr/interrupt.h>
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+
+namespace avr
+{
+
+/**
+*	UART
+*	BufSize: RX and TX buffer sizes, power of 2 between 2 and 256.
+*	Baud: baud rate.
+*
+*/
+template<uint16_t BufSize, uint32_t Baud = 9600>
+class Uart
+{
+	static_assert(isPow2(BufSize), "Uart BufSize must be a power of 2 between 2 and 256");
+	
+	static const uint8_t Mask = BufSize - 1;
+	static const uint16_t Ubrr = (F_CPU + 4UL * Baud) / (8UL * Baud) - 1;
+	static const uint32_t Real = F_CPU / (8UL * (Ubrr + 1));
+	
+	static_assert(Ubrr <= 4095, "Uart baud rate is too low for F_CPU");
+	static_assert(Real * 1000UL / Baud >= 980 && Real * 1000UL / Baud <= 1020, 
+				  "Uart baud rate error is higher than 2%");
+	
+	static uint8_t RxBuf[BufSize];
+	static uint8_t TxBuf[BufSize];
+	static volatile uint8_t RxHead;
+	static volatile uint8_t RxTail;
+	static volatile uint8_t TxHead;
+	static volatile uint8_t TxTail;
+	
+public:
+	/**
+	 @brief		Configure the USART in 2X mode, 8N1, and flush the buffers.
+	*/
+	static void init()
+	{
+		UBRR0H = (uint8_t)(Ubrr >> 8);
+		UBRR0L = (uint8_t)Ubrr;
+		UCSR0A = (1 << U2X0);
+		UCSR0B = (1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0);
+		UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+		RxHead = RxTail = 0;
+		TxHead = TxTail = 0;
+	}
+	
+	/**
+	 @brief		Wait for a byte and return it.
+	*/
+	static uint8_t receive()
+	{
+		uint8_t tmptail;
+		
+		SLEEP_WAIT_WHILE(RxHead == RxTail, SLEEP_MODE_IDLE);
+		tmptail = (RxTail + 1) & Mask;
+		RxTail = tmptail;
+		return RxBuf[tmptail];
+	}
+	
+	/**
+	 @brief		Queue a byte, wait if the buffer is full.
+	*/
+	static void transmit(uint8_t data)
+	{
+		uint8_t tmphead = (TxHead + 1) & Mask;
+		
+		SLEEP_WAIT_WHILE(tmphead == TxTail, SLEEP_MODE_IDLE);
+		TxBuf[tmphead] = data;
+		TxHead = tmphead;
+		UCSR0B |= (1 << UDRIE0);
+	}
+	
+	/**
+	 @brief		Number of bytes in the RX buffer.
+	*/
+	static uint8_t available()
+	{
+		return (RxHead - RxTail) & Mask;
+	}
+	
+	/**
+	 @brief		Send a null terminated string.
+	*/
+	static void putString(const char* s)
+	{
+		while (*s)
+			transmit(*s++);
+	}
+	
+	/**
+	 @brief		ISR bodies, called by AVRCPP_UART_ISR(). 
+	*/
+	static void rxIsr()
+	{
+		uint8_t data = UDR0;
+		uint8_t tmphead = (RxHead + 1) & Mask;
+		
+		/* Drop the data if the buffer is full, unread data is kept */
+		if (tmphead != RxTail)
+		{
+			RxBuf[tmphead] = data;
+			RxHead = tmphead;
+		}
+	}
+	
+	static void udreIsr()
+	{
+		uint8_t tmptail;
+		
+		if (TxHead != TxTail)
+		{
+			tmptail = (TxTail + 1) & Mask;
+			TxTail = tmptail;
+			UDR0 = TxBuf[tmptail];
+		} else
+		{
+			UCSR0B &= ~(1 << UDRIE0);
+		}
+	}
+};
+
+template<uint16_t BufSize, uint32_t Baud> uint8_t Uart<BufSize, Baud>::RxBuf[BufSize];
+template<uint16_t BufSize, uint32_t Baud> uint8_t Uart<BufSize, Baud>::TxBuf[BufSize];
+template<uint16_t BufSize, uint32_t Baud> volatile uint8_t Uart<BufSize, Baud>::RxHead;
+template<uint16_t BufSize, uint32_t Baud> volatile uint8_t Uart<BufSize, Baud>::RxTail;
+template<uint16_t BufSize, uint32_t Baud> volatile uint8_t Uart<BufSize, Baud>::TxHead;
+template<uint16_t BufSize, uint32_t Baud> volatile uint8_t Uart<BufSize, Baud>::TxTail;
+
+} // namespace avr
+
+
+/**
+*	UART Vectors
+*	Bind the USART interrupts to one Uart<> type.
+*
+*/
+#define AVRCPP_UART_ISR(type) \
+	ISR(USART_RX_vect)   { type::rxIsr(); } \
+	ISR(USART_UDRE_vect) { type::udreIsr(); }
+
+
+#endif /* UART_HPP_ */
@@ -0,0 +1,227 @@
+/*************************************************************************
+ Title	:   ADC to LCD dashboard (DASHBOARD.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Shows ADC readings on the LCD without spending the loop on the bus.
+
+       The ADC ISR goes round the channels of the fields, each 
+       Dashboard_Task() takes the channels with a new value. The drawings
+       go round the changed fields, one per credit of Dashboard_Tick(), 
+       so no field is starved. A drawing is formatted when it starts and 
+       sent one transfer per call.
+
+ USAGE
+       See the C include DASHBOARD.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <string.h>
+#include "DASHBOARD.h"
+
+#if !ADC_SCAN
+	#error "DASHBOARD.c needs ADC_SCAN"
+#endif
+
+
+/* State of a field without values */
+#define DASHBOARD_EMPTY		2
+
+/* Static Variables */
+static field_DASHBOARD* Dashboard_Fields;
+static uint8_t Dashboard_Count;
+static uint8_t Dashboard_Drawn;				// Last field drawn
+static volatile uint8_t Dashboard_Credit;
+static field_DASHBOARD* Dashboard_Drawing;	// Field being sent, or 0
+static char Dashboard_Text[DASHBOARD_WIDTH_MAX];
+static uint8_t Dashboard_Step;				// 0: cursor, then the chars
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Start the drawing of a field: its number, right-aligned with the decimal
+point, is formatted now and sent by Dashboard_Send().
+Input:    field 	field to be drawn
+Returns:  none
+*************************************************************************/
+static void Dashboard_Draw(field_DASHBOARD* field)
+{
+	char* text = Dashboard_Text;
+	uint16_t number = field->value;
+	uint8_t digits = 0;
+	uint8_t point = 0;
+	uint8_t i = field->width;
+	
+	while (i)
+	{
+		i--;
+		if (field->decimals && digits == field->decimals && !point)
+		{
+			text[i] = '.';
+			point = 1;
+		} else if (number || digits <= field->decimals)
+		{
+			/* Leading zero before the point: "0.05" */
+			text[i] = '0' + number % 10;
+			number /= 10;
+			digits++;
+		} else
+		{
+			text[i] = ' ';
+		}
+	}
+	
+	/* The number does not fit */
+	if (number)
+		memset(text, '#', field->width);
+	
+	/* New values are compared with this one while it is sent */
+	field->shown = field->value;
+	field->dirty = 0;
+	Dashboard_Drawing = field;
+	Dashboard_Step = 0;
+}
+
+/*************************************************************************
+Send the next part of the drawing: the cursor, then one char.
+Input:    none
+Returns:  none
+*************************************************************************/
+static void Dashboard_Send(void)
+{
+	field_DASHBOARD* field = Dashboard_Drawing;
+	
+	if (Dashboard_Step == 0)
+		LCD_GotoXY(field->row, field->pos);
+	else
+		LCD_Char(Dashboard_Text[Dashboard_Step - 1]);
+	
+	if (++Dashboard_Step > field->width)
+		Dashboard_Drawing = 0;
+}
+
+/*************************************************************************
+Draw the labels and start the scan of the channels.
+Input:    fields 	fields of the dashboard
+		  count 	number of fields
+Returns:  none
+*************************************************************************/
+void Dashboard_Init(field_DASHBOARD* fields, uint8_t count)
+{
+	field_DASHBOARD* field;
+	uint8_t channels = 0;
+	uint8_t i;
+	
+	Dashboard_Fields = fields;
+	Dashboard_Count = count;
+	Dashboard_Drawn = count - 1;
+	Dashboard_Credit = DASHBOARD_BURST;
+	Dashboard_Drawing = 0;
+	
+	for (i = 0; i < count; i++)
+	{
+		field = &fields[i];
+		if (field->width > DASHBOARD_WIDTH_MAX)
+			field->width = DASHBOARD_WIDTH_MAX;
+		field->pos = field->col;
+		if (field->label)
+		{
+			LCD_GotoXY(field->row, field->col);
+			LCD_String(field->label);
+			field->pos += strlen(field->label);
+		}
+		field->value = 0;
+		field->dirty = DASHBOARD_EMPTY;
+		channels |= (1 << (field->channel & (ADC_SCAN_CHANNELS - 1)));
+	}
+	
+	/* Values of an older scan are discarded */
+	ADC_StartScan(channels);
+}
+
+/*************************************************************************
+Give one drawing credit, up to DASHBOARD_BURST.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Dashboard_Tick(void)
+{
+	if (Dashboard_Credit < DASHBOARD_BURST)
+		Dashboard_Credit++;
+}
+
+/*************************************************************************
+Take the new values of the scan and make one LCD transfer.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Dashboard_Task(void)
+{
+	field_DASHBOARD* field;
+	uint16_t value;
+	uint16_t diff;
+	uint8_t fresh;
+	uint8_t channel;
+	uint8_t i;
+	
+	/* Sampling: the fields of the channels with a new value. A channel 
+	   can have several fields */
+	fresh = ADC_ScanChannels();
+	for (i = 0; fresh && i < Dashboard_Count; i++)
+	{
+		field = &Dashboard_Fields[i];
+		channel = field->channel & (ADC_SCAN_CHANNELS - 1);
+		if (!(fresh & (1 << channel)))
+			continue;
+		value = ADC_GetScan(channel);
+		if (field->convert)
+			value = field->convert(value);
+		field->value = value;
+		
+		/* A drawing is needed when the value leaves the deadband around 
+		   the LCD value. The first value is always drawn */
+		if (field->dirty == DASHBOARD_EMPTY)
+		{
+			field->dirty = 1;
+		} else if (!field->dirty)
+		{
+			diff = (value > field->shown) ? value - field->shown : field->shown - value;
+			field->dirty = (diff > field->deadband);
+		}
+	}
+	
+	/* Rendering: one transfer per call, a new field only with a credit */
+	if (Dashboard_Drawing)
+	{
+		Dashboard_Send();
+		return;
+	}
+	if (Dashboard_Credit == 0)
+		return;
+	
+	for (i = 0; i < Dashboard_Count; i++)
+	{
+		if (++Dashboard_Drawn >= Dashboard_Count)
+			Dashboard_Drawn = 0;
+		field = &Dashboard_Fields[Dashboard_Drawn];
+		if (field->dirty == 1)
+		{
+			Dashboard_Draw(field);
+			Dashboard_Send();
+			/* Dashboard_Tick() can be called from an ISR */
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				Dashboard_Credit--;
+			}
+			return;
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#ifndef DASHBOARD_H_
+#define DASHBOARD_H_
+
+/*************************************************************************
+ Title	:   C include file for the ADC to LCD dashboard (DASHBOARD.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Shows ADC readings on the LCD without spending the loop on the bus.
+
+       Each field binds an ADC channel to a position of the LCD, with a 
+       label and a number format. The ADC scans the channels of the 
+       fields by itself (ADC_StartScan()), at full speed while the LCD 
+       is written. Dashboard_Task() does not wait: it takes the new 
+       values of the scan and makes one transfer of the LCD, the cursor 
+       or one char of a field. A field is drawn only when its value moved
+       more than the deadband from the value on the LCD, and only when 
+       Dashboard_Tick() gave a credit, so the bus time of the display is
+       bounded by the tick rate.
+
+       Uses the scan of the ADC library (ADC_SCAN in CONFIG.h, channels
+       0-7) and the LCD library. Both have to be initialized first.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+
+/**
+*	Dashboard Rate Definitions
+*	Each Dashboard_Tick() allows one field to be drawn, up to 
+*	DASHBOARD_BURST drawings can be saved while nothing changes. A field 
+*	costs one LCD command and one transfer per char, LCD_CHAR_US each, 
+*	one per Dashboard_Task(): a call blocks for 5.6 ms at most with the 
+*	default I2C_VEL of 10 kHz, the scan goes on meanwhile. 
+*	DASHBOARD_FIELD_US is the bus time of a field: 39 ms for 6 chars at 
+*	10 kHz, so 200 ms ticks keep the display under 20% of the time 
+*	(20 ms ticks are enough at 100 kHz).
+*
+*/
+#ifndef DASHBOARD_BURST
+#define DASHBOARD_BURST		1
+#endif
+
+#define DASHBOARD_WIDTH_MAX	6			// Chars of a number, with the point
+
+#define DASHBOARD_FIELD_US(width)	(((width) + 1) * LCD_CHAR_US)
+
+
+/**
+*	Dashboard Converter
+*	Optional function that converts the value of the ADC to the shown 
+*	number, e.g. ADCCAL_ToMillivolts(). Without it the raw value is shown.
+*
+*/
+typedef uint16_t (*converter_DASHBOARD)(value_ADC value);
+
+
+/**
+*	Dashboard Field
+*	The first members are set by the application, the others are the 
+*	state kept by the library. The number is right-aligned in width 
+*	chars, with decimals digits after a point: 1234 with 2 decimals is 
+*	shown as "12.34". Numbers that do not fit are shown as '#'.
+*
+*/
+typedef struct
+{
+	uint8_t row;					// LCD row, from 1
+	uint8_t col;					// LCD column of the label, from 0
+	char* label;					// Drawn once by Dashboard_Init(), or 0
+	uint8_t channel;				// ADC channel, 0-7
+	uint8_t width;					// 1 to DASHBOARD_WIDTH_MAX
+	uint8_t decimals;				// 0 to width - 2
+	uint16_t deadband;				// Change needed to draw it, shown units
+	converter_DASHBOARD convert;	// Or 0 for the raw value
+	
+	uint16_t value;					// Last value
+	uint16_t shown;					// Value on the LCD
+	uint8_t dirty;					// 1: value has to be drawn
+	uint8_t pos;					// LCD column of the number
+} field_DASHBOARD;
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Draw the labels, clear the state of the fields and start the 
+ 			scan of their channels. The fields have to stay in memory.
+ @param		fields 	fields of the dashboard
+ 			count 	number of fields, 1 to 255
+ @return 	none
+*/
+void Dashboard_Init(field_DASHBOARD* fields, uint8_t count);
+
+/**
+ @brief		Give one drawing credit. Call it at the display rate, from the 
+ 			main loop or a timer ISR.
+ @param		none
+ @return 	none
+*/
+void Dashboard_Tick(void);
+
+/**
+ @brief		Take the new values of the scan and make one LCD transfer of 
+ 			the field being drawn. A changed field is started if there is
+ 			a credit. Does not wait for the ADC, call it from the main 
+ 			loop as often as possible.
+ @param		none
+ @return 	none
+*/
+void Dashboard_Task(void);
+
+
+#endif /* DASHBOARD_H_ */
@@ -0,0 +1,155 @@
+/*************************************************************************
+ Title	:   EEPROM configuration library (EECONFIG.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Persistent configuration of the libraries in the EEPROM.
+
+       Record of each slot:
+           seq  version  size  data[size]  crc_lo  crc_hi
+       crc = CRC-16 (_crc16_update, init 0xFFFF) of seq, version, size 
+       and data. The newest record is the valid one with the highest seq,
+       compared modulo 256.
+
+ USAGE
+       See the C include EECONFIG.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <string.h>
+#include "EECONFIG.h"
+
+/* Bytes of a record around the data */
+#define EECONFIG_HEADER		3
+#define EECONFIG_CRC		2
+
+/* The config has to fit in one slot */
+typedef char EECONFIG_SizeCheck[(sizeof(config_EECONFIG) + EECONFIG_HEADER + EECONFIG_CRC <= EECONFIG_SLOT_SIZE) ? 1 : -1];
+
+/* Global Variables */
+config_EECONFIG EECONFIG_Data;
+
+/* Static Variables */
+static uint8_t EEMEM EECONFIG_Store[EECONFIG_SLOTS][EECONFIG_SLOT_SIZE];
+static uint8_t EECONFIG_Slot;				// Slot of the newest record
+static uint8_t EECONFIG_Seq;				// Sequence of the newest record
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Load the defaults: the driver macros of CONFIG.h.
+Input:    none
+Returns:  none
+*************************************************************************/
+void EECONFIG_Defaults(void)
+{
+	EECONFIG_Data.uart_ubrr = MYUBRR;
+	EECONFIG_Data.adc_channel = ADC_CHANNEL;
+	EECONFIG_Data.lcd_addr = LCD_Add;
+	EECONFIG_Data.rgb_type = TYPE_RGB;
+}
+
+/*************************************************************************
+Read and check the record of a slot.
+Input:    slot 	slot of the store
+		  record 	EECONFIG_SLOT_SIZE bytes
+Returns:  1 if the CRC is right and the version can be used
+*************************************************************************/
+static uint8_t EECONFIG_Read(uint8_t slot, uint8_t* record)
+{
+	uint16_t crc = 0xFFFF;
+	uint8_t size;
+	uint8_t i;
+	
+	eeprom_read_block(record, EECONFIG_Store[slot], EECONFIG_SLOT_SIZE);
+	
+	/* Newer layouts than this firmware are not used */
+	size = record[2];
+	if (record[1] > EECONFIG_VERSION || size > EECONFIG_SLOT_SIZE - EECONFIG_HEADER - EECONFIG_CRC)
+		return 0;
+	
+	for (i = 0; i < EECONFIG_HEADER + size; i++)
+		crc = _crc16_update(crc, record[i]);
+	
+	return (record[i] == (uint8_t)crc) && (record[i + 1] == (uint8_t)(crc >> 8));
+}
+
+/*************************************************************************
+Load the newest valid record.
+Input:    none
+Returns:  1 if a record was loaded, 0 if the defaults are used
+*************************************************************************/
+uint8_t EECONFIG_Init(void)
+{
+	uint8_t record[EECONFIG_SLOT_SIZE];
+	uint8_t found = 0;
+	uint8_t slot;
+	uint8_t size;
+	
+	EECONFIG_Defaults();
+	EECONFIG_Slot = EECONFIG_SLOTS - 1;
+	EECONFIG_Seq = 0xFF;
+	
+	/* Find the newest record */
+	for (slot = 0; slot < EECONFIG_SLOTS; slot++)
+	{
+		if (!EECONFIG_Read(slot, record))
+			continue;
+		if (!found || (int8_t)(record[0] - EECONFIG_Seq) > 0)
+		{
+			EECONFIG_Slot = slot;
+			EECONFIG_Seq = record[0];
+			found = 1;
+		}
+	}
+	
+	if (found)
+	{
+		/* Old layouts are shorter, the new fields keep the defaults */
+		EECONFIG_Read(EECONFIG_Slot, record);
+		size = record[2];
+		if (size > sizeof(config_EECONFIG))
+			size = sizeof(config_EECONFIG);
+		memcpy(&EECONFIG_Data, &record[EECONFIG_HEADER], size);
+	}
+	
+	return found;
+}
+
+/*************************************************************************
+Write the RAM copy as a new record in the next slot. The old record is 
+kept until the new one is complete.
+Input:    none
+Returns:  none
+*************************************************************************/
+void EECONFIG_Save(void)
+{
+	uint8_t record[EECONFIG_HEADER + sizeof(config_EECONFIG) + EECONFIG_CRC];
+	uint16_t crc = 0xFFFF;
+	uint8_t i;
+	
+	if (++EECONFIG_Slot >= EECONFIG_SLOTS)
+		EECONFIG_Slot = 0;
+	EECONFIG_Seq++;
+	
+	record[0] = EECONFIG_Seq;
+	record[1] = EECONFIG_VERSION;
+	record[2] = sizeof(config_EECONFIG);
+	memcpy(&record[EECONFIG_HEADER], &EECONFIG_Data, sizeof(config_EECONFIG));
+	for (i = 0; i < EECONFIG_HEADER + sizeof(config_EECONFIG); i++)
+		crc = _crc16_update(crc, record[i]);
+	record[i] = (uint8_t)crc;
+	record[i + 1] = (uint8_t)(crc >> 8);
+	
+	/* Only the changed bytes are written */
+	eeprom_update_block(record, EECONFIG_Store[EECONFIG_Slot], sizeof(record));
+}
@@ -0,0 +1,117 @@
+#ifndef EECONFIG_H_
+#define EECONFIG_H_
+
+/*************************************************************************
+ Title	:   C include file for the EEPROM configuration library (EECONFIG.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Persistent configuration of the libraries in the EEPROM.
+
+       The parameters that were only compile-time macros (baud rate, ADC
+       channel, LCD address, RGB type) are kept in a RAM copy that is 
+       loaded from the EEPROM by EECONFIG_Init(). The drivers read the 
+       copy at init, so a unit can be reconfigured without reflashing.
+
+       Each EECONFIG_Save() writes a new record in the next slot of a 
+       ring of EECONFIG_SLOTS slots (round-robin wear leveling). A record
+       has a sequence number, the version of the layout and a CRC, so an
+       interrupted write only loses the new record.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	Config Enable
+*	EECONFIG_ENABLE is set in CONFIG.h. With 1 the drivers take their 
+*	parameters from EECONFIG_Data at init and EECONFIG_Init() has to be 
+*	called before them. With 0 the drivers use the macros and this 
+*	library is not needed.
+*
+*/
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	Config Store Definitions
+*	EECONFIG_SLOTS records of EECONFIG_SLOT_SIZE bytes are reserved in 
+*	the EEPROM (128 bytes by default). Each EEPROM cell takes about 
+*	100.000 writes, with 8 slots the configuration can be saved 800.000 
+*	times. A record is the header (3 bytes), the config and a CRC-16.
+*
+*/
+#ifndef EECONFIG_SLOTS
+#define EECONFIG_SLOTS		8
+#endif
+#ifndef EECONFIG_SLOT_SIZE
+#define EECONFIG_SLOT_SIZE	16
+#endif
+
+#if (EECONFIG_SLOTS < 1) || (EECONFIG_SLOTS > 64)
+	#error "EECONFIG_SLOTS must be between 1 and 64"
+#endif
+
+
+/**
+*	Config Data
+*	Fields of the configuration. The layout can only grow: add the new 
+*	fields at the end and increase EECONFIG_VERSION. The fields of an 
+*	older record are kept and the new ones take their default values.
+*
+*/
+#define EECONFIG_VERSION	1
+
+typedef struct
+{
+	uint16_t uart_ubrr;			// UBRR of USART_Init(), 2X mode
+	uint8_t adc_channel;		// ADC_CHANNEL
+	uint8_t lcd_addr;			// LCD_Add, 7 bits
+	uint8_t rgb_type;			// TYPE_RGB: COMMON_ANODE or COMMON_CATHODE
+} config_EECONFIG;
+
+
+/**
+*	Config RAM Copy
+*	Read the fields directly, there is no lookup. Change them and call 
+*	EECONFIG_Save() to store them, the drivers take the new values at 
+*	their next init.
+*
+*/
+extern config_EECONFIG EECONFIG_Data;
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Load the newest valid record into EECONFIG_Data, or the defaults
+ 			(the macros of each driver) if there is none. 
+ @param		none
+ @return 	1 if a record was loaded, 0 if the defaults are used
+*/
+uint8_t EECONFIG_Init(void);
+
+/**
+ @brief		Write EECONFIG_Data in the next slot. Takes about 3.3 ms per 
+ 			changed byte, the EEPROM is written with interrupts enabled.
+ @param		none
+ @return 	none
+*/
+void EECONFIG_Save(void);
+
+/**
+ @brief		Load the defaults into EECONFIG_Data. The EEPROM is not changed
+ 			until EECONFIG_Save().
+ @param		none
+ @return 	none
+*/
+void EECONFIG_Defaults(void);
+
+
+#endif /* EECONFIG_H_ */
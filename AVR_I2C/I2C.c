@@ -0,0 +1,348 @@
+/*************************************************************************
+ Title	:   I2C library (I2C.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the I2C (TWI) protocol as a master.
+
+       Originally part of the LCD - I2C adapter library. The low-level 
+       functions were moved here, so the LCD is one more device of the 
+       bus. Register read and write functions were added.
+
+       This Library only uses the I2C pins of the AVR. 
+       The bit rate to initialize the I2C is MYTWBR. 
+       This value is obtain from a Macro definition.
+
+ USAGE
+       See the C include I2C.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/twi.h>
+#include "I2C.h"
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+#include "../AVR_STATS/STATS.h"
+#include "../AVR_TRACE/TRACE.h"
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Waits until the TWI hardware finishes the current operation, at most 
+I2C_TIMEOUT polls. The CPU sleeps in Idle mode meanwhile if I2C_SLEEP_WAIT
+is enabled.
+Input:    none
+Returns:  none
+*************************************************************************/
+static void I2C_Wait(void)
+{
+	#if I2C_TIMEOUT
+	uint16_t polls = I2C_TIMEOUT;
+	#define I2C_POLL()		(--polls != 0)
+	#else
+	#define I2C_POLL()		1
+	#endif
+	
+	/* With the interrupts disabled by the caller TWINT is polled */
+	#if I2C_SLEEP_WAIT
+	SLEEP_WAIT_WHILE(!(TWCR & (1 << TWINT)) && I2C_POLL(), SLEEP_MODE_IDLE);
+	#else
+	while (!(TWCR & (1 << TWINT)) && I2C_POLL());
+	#endif
+	
+	#if I2C_TIMEOUT
+	if (polls == 0)
+	{
+		/* Give up, the TWI interrupt is not needed anymore */
+		TWCR &= ~((1 << TWIE) | (1 << TWINT));
+		STATS_INC(STATS_I2C_TIMEOUT);
+	}
+	#endif
+	#undef I2C_POLL
+}
+
+#if I2C_SLEEP_WAIT
+/*************************************************************************
+Interrupt Vector for the TWI.
+Only used to wake up the CPU. Disables itself, TWINT is left set so the
+next operation is started by the I2C functions. 
+*************************************************************************/
+ISR(TWI_vect)
+{
+	STATS_ISR_BEGIN();
+	TRACE_ISR(TRACE_TWI, TW_STATUS);
+	/* Writing 0 to TWINT does not clear the flag */
+	TWCR &= ~((1 << TWIE) | (1 << TWINT));
+	STATS_ISR_END(STATS_ISR_TWI);
+}
+#endif
+
+/*************************************************************************
+Low-level function to initialize the I2C
+Input:    none
+Returns:  none
+*************************************************************************/
+void I2C_Init(void)
+{
+	/* Set SCL to I2C_VEL. Prescaler and bit rate solved in I2C.h */
+	TWSR = (MYTWPS << TWPS0);
+	TWBR = MYTWBR;
+	
+	/* Enable TWI */
+	TWCR = (1 << TWEN);
+}
+
+
+/*************************************************************************
+Low-level function that send a Start (or repeated Start) condition and 
+the address of a device
+Input:    address 	Address of device with a W/R condition at the end.
+Returns:  I2C_OK if the device acknowledged, the TWI status otherwise
+*************************************************************************/
+uint8_t I2C_Start(uint8_t address)
+{
+	uint8_t status;
+	#if I2C_TIMEOUT
+	uint16_t polls = I2C_TIMEOUT;
+	#endif
+	
+	/* A previous Stop has to be on the bus before the new Start */
+	while (TWCR & (1 << TWSTO))
+	{
+		#if I2C_TIMEOUT
+		if (--polls == 0)
+			break;
+		#endif
+	}
+	
+	TRACE(TRACE_I2C_START, address);
+	
+	/* Send Start Condition. Written, not ORed: TWINT is cleared by writing 1 */
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | I2C_TWIE;
+	
+	/* Wait for the Start */
+	I2C_Wait();
+	status = TW_STATUS;
+	if ((status != TW_START) && (status != TW_REP_START))
+		return status;
+	
+	/* Send the address and W/R condition, TWSTA has to be cleared */
+	TWDR = address;
+	TWCR = (1 << TWINT) | (1 << TWEN) | I2C_TWIE;
+	
+	/* Wait for the acknowledge bit */
+	I2C_Wait();
+	status = TW_STATUS;
+	if ((status == TW_MT_SLA_ACK) || (status == TW_MR_SLA_ACK))
+		return I2C_OK;
+	
+	#if STATS_ENABLE
+	if ((status == TW_MT_SLA_NACK) || (status == TW_MR_SLA_NACK))
+		STATS_INC(STATS_I2C_NACK);
+	#endif
+	TRACE(TRACE_I2C_NACK, status);
+	return status;
+}
+
+/*************************************************************************
+Low-level function that send a Stop condition.
+Input:    none
+Returns:  none
+*************************************************************************/
+void I2C_Stop(void)
+{
+	TRACE(TRACE_I2C_STOP, 0);
+	
+	/* Send Stop Condition. The TWI clears TWSTO when it is done */
+	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+}
+
+
+/*************************************************************************
+Send Byte through I2C. Wait for the acknowledge bit.
+Input:    data 	byte to be send
+Returns:  I2C_OK if the device acknowledged, the TWI status otherwise
+*************************************************************************/
+uint8_t I2C_Transmit(uint8_t data)
+{
+	uint8_t status;
+	
+	/* Send the Data */
+	TWDR = data;
+	TWCR = (1 << TWINT) | (1 << TWEN) | I2C_TWIE;
+	
+	/* Wait for the acknowledge bit */
+	I2C_Wait();
+	status = TW_STATUS;
+	if (status == TW_MT_DATA_ACK)
+		return I2C_OK;
+	
+	#if STATS_ENABLE
+	if (status == TW_MT_DATA_NACK)
+		STATS_INC(STATS_I2C_NACK);
+	#endif
+	TRACE(TRACE_I2C_NACK, status);
+	return status;
+}
+
+/*************************************************************************
+Waits until there are new data and acknowledge it. 
+Input:    none
+Returns:  Data received from the I2C. 
+*************************************************************************/
+uint8_t I2C_Receive(void)
+{
+	/*Clean the flag for the incoming data*/
+	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA) | I2C_TWIE;
+	
+	/* Wait for the data */
+	I2C_Wait();
+	
+	/* Return the incoming data */
+	return TWDR;
+}
+
+/*************************************************************************
+Waits until there are new data and does not acknowledge it. The device 
+releases the bus for the Stop.
+Input:    none
+Returns:  Data received from the I2C. 
+*************************************************************************/
+uint8_t I2C_ReceiveNack(void)
+{
+	/* TWEA cleared: NACK after the byte */
+	TWCR = (1 << TWINT) | (1 << TWEN) | I2C_TWIE;
+	
+	/* Wait for the data */
+	I2C_Wait();
+	
+	/* Return the incoming data */
+	return TWDR;
+}
+
+
+/*
+**	functions - Registers
+*/
+
+/*************************************************************************
+Send the address of the device and the register address, MSB first.
+Input:    add 	7 bits address of the device
+		  reg 	register address
+		  size 	bytes of the register address, 1 or 2
+Returns:  I2C_OK or the TWI status of the error. The bus is stopped 
+		  on error.
+*************************************************************************/
+static uint8_t I2C_Select(uint8_t add, uint16_t reg, uint8_t size)
+{
+	uint8_t status;
+	
+	status = I2C_Start(I2C_ADD_WR(add));
+	if ((status == I2C_OK) && (size == 2))
+		status = I2C_Transmit(reg >> 8);
+	if (status == I2C_OK)
+		status = I2C_Transmit(reg & 0xFF);
+	if (status != I2C_OK)
+		I2C_Stop();
+	
+	return status;
+}
+
+/*************************************************************************
+Write bytes to consecutive registers. The device increments the register 
+address after each byte.
+Input:    add 	7 bits address of the device
+		  reg 	first register
+		  size 	bytes of the register address, 1 or 2
+		  data 	bytes to be written
+		  len 	number of bytes
+Returns:  I2C_OK or the TWI status of the error
+*************************************************************************/
+static uint8_t I2C_Write(uint8_t add, uint16_t reg, uint8_t size, const uint8_t* data, uint8_t len)
+{
+	uint8_t status;
+	
+	status = I2C_Select(add, reg, size);
+	if (status != I2C_OK)
+		return status;
+	
+	while (len--)
+	{
+		status = I2C_Transmit(*data++);
+		if (status != I2C_OK)
+			break;
+	}
+	I2C_Stop();
+	
+	return status;
+}
+
+/*************************************************************************
+Read bytes from consecutive registers. The register address is written,
+then a repeated Start turns the bus around without releasing it. Every 
+byte is acknowledged but the last one.
+Input:    add 	7 bits address of the device
+		  reg 	first register
+		  size 	bytes of the register address, 1 or 2
+		  data 	buffer for the bytes
+		  len 	number of bytes
+Returns:  I2C_OK or the TWI status of the error
+*************************************************************************/
+static uint8_t I2C_Read(uint8_t add, uint16_t reg, uint8_t size, uint8_t* data, uint8_t len)
+{
+	uint8_t status;
+	
+	status = I2C_Select(add, reg, size);
+	if (status != I2C_OK)
+		return status;
+	
+	/* Repeated Start */
+	status = I2C_Start(I2C_ADD_RD(add));
+	if (status == I2C_OK && len)
+	{
+		while (--len)
+			*data++ = I2C_Receive();
+		*data = I2C_ReceiveNack();
+	}
+	I2C_Stop();
+	
+	return status;
+}
+
+/*************************************************************************
+Write bytes to consecutive registers of a device, 8 bits register address.
+*************************************************************************/
+uint8_t I2C_WriteReg(uint8_t add, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+	return I2C_Write(add, reg, 1, data, len);
+}
+
+/*************************************************************************
+Read bytes from consecutive registers of a device, 8 bits register address.
+*************************************************************************/
+uint8_t I2C_ReadReg(uint8_t add, uint8_t reg, uint8_t* data, uint8_t len)
+{
+	return I2C_Read(add, reg, 1, data, len);
+}
+
+/*************************************************************************
+Write bytes to consecutive registers of a device, 16 bits register address.
+*************************************************************************/
+uint8_t I2C_WriteReg16(uint8_t add, uint16_t reg, const uint8_t* data, uint8_t len)
+{
+	return I2C_Write(add, reg, 2, data, len);
+}
+
+/*************************************************************************
+Read bytes from consecutive registers of a device, 16 bits register address.
+*************************************************************************/
+uint8_t I2C_ReadReg16(uint8_t add, uint16_t reg, uint8_t* data, uint8_t len)
+{
+	return I2C_Read(add, reg, 2, data, len);
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#ifndef I2C_H_
+#define I2C_H_
+
+/*************************************************************************
+ Title	:   C include file for the I2C library (I2C.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the I2C (TWI) protocol as a master.
+
+       Originally part of the LCD - I2C adapter library. Now shared by the
+       LCD and any other device of the bus: register read and write with
+       repeated start, burst reads ending with NACK and 8 or 16 bits 
+       register addresses (sensors, EEPROMs, ...).
+
+       The bit rate to initialize the I2C is MYTWBR. This value is 
+       obtain from a Macro definition.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	I2C Clock Definitions
+*	Used to obtain the TWBR value and the prescaler for the desired bit 
+*	rate. The smallest prescaler that fits TWBR in 8 bits is used.
+*
+*/
+#ifndef I2C_VEL
+#define I2C_VEL			10000			// 10 kHz for the I2C
+#endif
+
+#if (F_CPU/I2C_VEL) < 16
+	#error "I2C_VEL is too high for F_CPU, SCL = F_CPU/(16 + 2*TWBR*4^TWPS)"
+#elif ((F_CPU/I2C_VEL - 16)/2) <= 255
+	#define MYTWPS		0
+	#define MYTWBR		((F_CPU/I2C_VEL - 16)/2)
+#elif ((F_CPU/I2C_VEL - 16)/8) <= 255
+	#define MYTWPS		1
+	#define MYTWBR		((F_CPU/I2C_VEL - 16)/8)
+#elif ((F_CPU/I2C_VEL - 16)/32) <= 255
+	#define MYTWPS		2
+	#define MYTWBR		((F_CPU/I2C_VEL - 16)/32)
+#else
+	#define MYTWPS		3
+	#define MYTWBR		((F_CPU/I2C_VEL - 16)/128)
+#endif
+
+#if defined(MYTWBR) && (MYTWBR > 255)
+	#error "I2C_VEL is too low for F_CPU, TWBR does not fit in 8 bits"
+#endif
+
+
+/**
+*	I2C Sleep Definitions
+*	When enabled, the I2C functions put the CPU in Idle mode while the TWI
+*	hardware is busy instead of polling the TWINT flag. The TWI interrupt
+*	wakes the CPU up. Called with the interrupts disabled, the functions
+*	poll TWINT instead and leave them disabled.
+*
+*/
+#ifndef I2C_SLEEP_WAIT
+#define I2C_SLEEP_WAIT	1				/* 1: Idle sleep -- 0: busy wait */
+#endif
+
+/**
+*	I2C Timeout
+*	Maximum number of polls of the TWINT flag before an operation is 
+*	given up (0 waits forever). With I2C_SLEEP_WAIT each poll is a wake-up, 
+*	so the timeout only works if another interrupt (e.g. a timer) is running.
+*
+*/
+#ifndef I2C_TIMEOUT
+#define I2C_TIMEOUT		0xFFFF
+#endif
+
+#if I2C_SLEEP_WAIT
+#define I2C_TWIE		(1 << TWIE)
+#else
+#define I2C_TWIE		0
+#endif
+
+
+/**
+*	I2C Address Definitions
+*	The register functions use 7 bits addresses. I2C_Start() uses the
+*	address with the W/R condition at the end.
+*
+*/
+#define I2C_WRITE		0
+#define I2C_READ		1
+#define I2C_ADD_WR(add)	(((add) << 1) | I2C_WRITE)
+#define I2C_ADD_RD(add)	(((add) << 1) | I2C_READ)
+
+/**
+*	I2C Results
+*	Returned by the functions that check the acknowledge bit. Any other 
+*	value is the TWI status code (TW_xxx of util/twi.h) of the error.
+*
+*/
+#define I2C_OK			0
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Low-level function to initialize the I2C
+ @param		none
+ @return 	none
+*/
+void I2C_Init(void);
+
+/**
+ @brief		Low-level function that send a Start (or repeated Start) condition
+ 			and the address of a device.
+ @param		address 	Address of device with a W/R condition at the end.
+ @return 	I2C_OK if the device acknowledged, the TWI status otherwise
+*/
+uint8_t I2C_Start(uint8_t address);
+
+/**
+ @brief		Low-level function that send a Stop condition.
+ @param		none
+ @return 	none
+*/
+void I2C_Stop(void);
+
+/**
+ @brief		Send Byte through I2C. Wait for the acknowledge bit.
+ @param		data 	byte to be send
+ @return 	I2C_OK if the device acknowledged, the TWI status otherwise
+*/
+uint8_t I2C_Transmit(uint8_t data);
+
+/**
+ @brief		Waits until there are new data and acknowledge it, so the 
+ 			device sends more data. 
+ @param		none
+ @return 	Data received from the I2C. 
+*/
+uint8_t I2C_Receive(void);
+
+/**
+ @brief		Waits until there are new data and does not acknowledge it. 
+ 			Used for the last byte of a read, before the Stop. 
+ @param		none
+ @return 	Data received from the I2C. 
+*/
+uint8_t I2C_ReceiveNack(void);
+
+/**
+ @brief		Write bytes to consecutive registers of a device.
+ @param		add 	7 bits address of the device
+ 			reg 	first register
+ 			data 	bytes to be written
+ 			len 	number of bytes
+ @return 	I2C_OK or the TWI status of the error
+*/
+uint8_t I2C_WriteReg(uint8_t add, uint8_t reg, const uint8_t* data, uint8_t len);
+
+/**
+ @brief		Read bytes from consecutive registers of a device, with a 
+ 			repeated Start and a NACK on the last byte.
+ @param		add 	7 bits address of the device
+ 			reg 	first register
+ 			data 	buffer for the bytes
+ 			len 	number of bytes
+ @return 	I2C_OK or the TWI status of the error
+*/
+uint8_t I2C_ReadReg(uint8_t add, uint8_t reg, uint8_t* data, uint8_t len);
+
+/**
+ @brief		I2C_WriteReg() for devices with 16 bits register addresses,
+ 			sent MSB first (e.g. 24Cxx EEPROMs). 
+*/
+uint8_t I2C_WriteReg16(uint8_t add, uint16_t reg, const uint8_t* data, uint8_t len);
+
+/**
+ @brief		I2C_ReadReg() for devices with 16 bits register addresses,
+ 			sent MSB first (e.g. 24Cxx EEPROMs). 
+*/
+uint8_t I2C_ReadReg16(uint8_t add, uint16_t reg, uint8_t* data, uint8_t len);
+
+
+#endif /* I2C_H_ */
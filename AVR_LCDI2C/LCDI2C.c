@@ -1,227 +1,302 @@
-/*************************************************************************
- Title	:   LCD - I2C adapter library (LCDI2C.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the I2C protocol and LCD commands.
-
-       Originally based on the Github Code of eagl1 
-       (https://github.com/eagl1/LCD1602_I2C_all_code). Changed
-       the macros and new functions for the LCD. 
-       Designed for the ATmega328P microcontroller.
-
-       This Library only uses the I2C pins of the AVR. 
-       The bit rate to initialize the I2C is MYTWBR. 
-       This value is obtain from a Macro definition.
-
- USAGE
-       See the C include LCDI2C.h file for a description of each function
-       
-*****************************************************************************/
-
-#include <avr/io.h>
-#include <util/twi.h>
-#include <stdlib.h>
-#include "LCDI2C.h"
-
-
-/*
-**	functions - LCD
-*/
-
-
-/*************************************************************************
-Low-level function to initialize the LCD.
-Input:    none
-Returns:  none
-*************************************************************************/
-void LCD_Init(void)
-{
-	/* Initialize LCD */
-	sendCMD(LCD_8BIT);
-	sendCMD(LCD_4BIT);
-	sendCMD(LCD_FUNCTION_4BIT_2LINES);
-	sendCMD(LCD_DISP_ON);
-	sendCMD(LCD_CLR);
-}
-
-/*************************************************************************
-Allows to write new commands to the LCD 
-Input:    CMD	Command to be send
-Returns:  none
-*************************************************************************/
-void sendCMD(uint8_t CMD)
-{
-	uint8_t bitmask;
-	/* Send Address - Write Condition */
-	I2C_Start(LCD_Add_WR);
-	
-	/* Send commands. MS Nibble*/
-	I2C_Transmit(bitmask = (CMD & 0xF0) | 0x08);
-	I2C_Transmit(bitmask |= (1 << E));
-	I2C_Transmit(bitmask &= ~(1 << E));
-	
-	/* Send commands. LS Nibble*/
-	I2C_Transmit(bitmask = ((CMD << 4) & 0xF0) | 0x08);
-	I2C_Transmit(bitmask |= (1 << E));
-	I2C_Transmit(bitmask &= ~(1 << E));
-	
-	/* Stop Condition */
-	I2C_Stop();
-}
-
-/*************************************************************************
-Put a char on the LCD Display. 
-Input:    data	char to be shown
-Returns:  none
-*************************************************************************/
-void sendData(uint8_t data)
-{
-	uint8_t bitmask;
-	/* Send Address - Write Condition */
-	I2C_Start(LCD_Add_WR);
-	
-	/* Send Data. MS Nibble*/
-	I2C_Transmit(bitmask = (data & 0xF0) | 0x08 | (1 << RS));
-	I2C_Transmit(bitmask |= (1 << E));
-	I2C_Transmit(bitmask &= ~(1 << E));
-	
-	/* Send Data. LS Nibble*/
-	I2C_Transmit(bitmask = ((data << 4) & 0xF0) | 0x08 | (1 << RS));
-	I2C_Transmit(bitmask |= (1 << E));
-	I2C_Transmit(bitmask &= ~(1 << E));
-	
-	/* Stop Condition */
-	I2C_Stop();
-}
-
-/*************************************************************************
-Change the current position of the cursor 
-Input:    row	Choose the new row
-		  col 	Choose the new col
-Returns:  none
-*************************************************************************/
-void LCD_GotoXY (uint8_t row, uint8_t col)
-{
-	/* Change the cursor*/
-	if (row == 1)
-	sendCMD(LCD_ROW1 + col);
-	if (row == 2)
-	sendCMD(LCD_ROW2 + col);
-}
-
-/*************************************************************************
-Put a String on the LCD Display. 
-Input:    arr1	String to be shown
-Returns:  none
-*************************************************************************/
-void LCD_String(char* arr1)
-{
-	/* Last char will be null. Check for characters to send*/
-	while(*arr1 != 0x00)
-	{
-		sendData(*arr1);		// Send 1 char at the time
-		arr1++;					// Increment the index
-	}
-}
-
-/*************************************************************************
-Put a Number on the LCD Display. 
-Input:    numb	number to be shown
-Returns:  none
-*************************************************************************/
-void LCD_Number(uint16_t numb)
-{
-	char array[4];				// 4 digits of the number. Change if needed
-	itoa(numb, array, 10);		// Radix for the conversion: 10
-	LCD_String(array);			// Send the ASCII codes obtained from data
-	
-}
-
-
-/*
-**	functions - I2C
-*/
-
-/*************************************************************************
-Low-level function to initialize the I2C
-Input:    none
-Returns:  none
-*************************************************************************/
-void I2C_Init(void)
-{
-	/* Set SCL to 50 kHz. Macro definition */
-	TWSR = 0x00;			// Prescaler = 1
-	TWBR = MYTWBR;			// Macro 72
-	
-	/* Enable TWI */
-	TWCR = (1 << TWEN);
-}
-
-
-/*************************************************************************
-Low-level function that send a Start condition and the address of a device
-Input:    address 	Address of device with a W/R condition at the end.
-Returns:  none
-*************************************************************************/
-void I2C_Start(uint8_t address)
-{
-	/* Send Start Condition*/
-	TWCR |= (1 << TWINT) | (1 << TWSTA);
-	
-	/* Wait for the acknowledge bit */
-	while (!(TWCR & (1 << TWINT)));
-	
-	/* Send the address and W/R condition */
-	TWDR = address;
-	TWCR |= (1 << TWINT) | (1 << TWEA);
-	
-	/* Wait for the acknowledge bit */
-	while (!(TWCR & (1 << TWINT)));
-}
-
-/*************************************************************************
-Low-level function that send a Stop condition.
-Input:    none
-Returns:  none
-*************************************************************************/
-void I2C_Stop(void)
-{
-	/* Send Stop Condition */
-	TWCR |= (1 << TWINT) | (1 << TWSTO);
-}
-
-
-/*************************************************************************
-Send Byte through I2C. Wait for the acknowledge bit.
-Input:    data 	byte to be send
-Returns:  none
-*************************************************************************/
-void I2C_Transmit(uint8_t data)
-{
-	/* Send the Data */
-	TWDR = data;
-	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
-	
-	/* Wait for the acknowledge bit */
-	while (!(TWCR & (1 << TWINT)));
-}
-
-/*************************************************************************
-Waits until there are new data. 
-Input:    none
-Returns:  Data received from the UART. 
-*************************************************************************/
-uint8_t I2C_Receive(void)
-{
-	/*Clean the flag for the incoming data*/
-	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
-	
-	/* Wait for the acknowledge bit */
-	while (!(TWCR & (1 << TWINT)));
-	
-	/* Return the incoming data */
-	return TWDR;
+/*************************************************************************
+ Title	:   LCD - I2C adapter library (LCDI2C.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the LCD commands.
+
+       Originally based on the Github Code of eagl1 
+       (https://github.com/eagl1/LCD1602_I2C_all_code). Changed
+       the macros and new functions for the LCD. 
+       Designed for the ATmega328P microcontroller.
+
+       The LCD is one device of the I2C bus, the TWI functions are in 
+       the I2C library (AVR_I2C).
+
+ USAGE
+       See the C include LCDI2C.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <stdlib.h>
+#include "LCDI2C.h"
+#include "../AVR_EECONFIG/EECONFIG.h"
+
+
+/* Static Variables */
+static const uint8_t LCD_RowOffset[4] = { 0x00, 0x40, LCD_COLS, 0x40 + LCD_COLS };
+static uint8_t LCD_Row;						// Cursor position, from 0
+static uint8_t LCD_Col;
+static uint8_t LCD_Shadow = 0xFF;			// Last byte written, all high at reset
+static uint8_t LCD_Ctrl = (1 << BL);		// Backlight and spare pins
+static uint8_t LCD_OnTicks;					// Backlight pattern
+static uint8_t LCD_OffTicks;
+static uint16_t LCD_Ticks;
+#if EECONFIG_ENABLE
+static uint8_t LCD_Address = LCD_Add;		// Taken from EECONFIG_Data at init
+#define LCD_ADDRESS_WR	I2C_ADD_WR(LCD_Address)
+#else
+#define LCD_ADDRESS_WR	LCD_Add_WR
+#endif
+
+
+/*
+**	functions - LCD
+*/
+
+
+/*************************************************************************
+Low-level function to initialize the LCD.
+Input:    none
+Returns:  none
+*************************************************************************/
+void LCD_Init(void)
+{
+	#if EECONFIG_ENABLE
+	LCD_Address = EECONFIG_Data.lcd_addr & 0x7F;
+	#endif
+	
+	/* Initialize LCD */
+	sendCMD(LCD_8BIT);
+	sendCMD(LCD_4BIT);
+	#if LCD_ROWS == 1
+	sendCMD(LCD_FUNCTION_4BIT_1LINE);
+	#else
+	sendCMD(LCD_FUNCTION_4BIT_2LINES);	// 4 row displays use 2 lines too
+	#endif
+	sendCMD(LCD_DISP_ON);
+	LCD_Clear();
+}
+
+/*************************************************************************
+Clear the display and return the cursor and the scroll to the start.
+Input:    none
+Returns:  none
+*************************************************************************/
+void LCD_Clear(void)
+{
+	sendCMD(LCD_CLR);
+	LCD_Row = 0;
+	LCD_Col = 0;
+}
+
+/*************************************************************************
+Send a nibble to the LCD. The expander is written with the data and E
+high, then E low. The data is latched on the falling edge of E, so the
+byte that only sets the data before E is needed just when RS changes.
+Input:    nibble 	data on the 4 high bits
+		  rs 		(1 << RS) for data, 0 for commands
+Returns:  none
+*************************************************************************/
+static void LCD_Nibble(uint8_t nibble, uint8_t rs)
+{
+	uint8_t bitmask = (nibble & 0xF0) | LCD_Ctrl | rs;
+	
+	/* RS has to be stable before E rises */
+	if ((LCD_Shadow ^ bitmask) & (1 << RS))
+		I2C_Transmit(bitmask);
+	I2C_Transmit(bitmask | (1 << E));
+	I2C_Transmit(bitmask);
+	LCD_Shadow = bitmask;
+}
+
+/*************************************************************************
+Write one byte to the expander if it is different from the shadow.
+Input:    bitmask 	new value of the 8 pins
+Returns:  none
+*************************************************************************/
+static void LCD_Write(uint8_t bitmask)
+{
+	if (bitmask == LCD_Shadow)
+		return;
+	
+	I2C_Start(LCD_ADDRESS_WR);
+	I2C_Transmit(bitmask);
+	I2C_Stop();
+	LCD_Shadow = bitmask;
+}
+
+/*************************************************************************
+Allows to write new commands to the LCD 
+Input:    CMD	Command to be send
+Returns:  none
+*************************************************************************/
+void sendCMD(uint8_t CMD)
+{
+	/* Send Address - Write Condition */
+	I2C_Start(LCD_ADDRESS_WR);
+	
+	/* Send commands. MS Nibble, LS Nibble */
+	LCD_Nibble(CMD, 0);
+	LCD_Nibble(CMD << 4, 0);
+	
+	/* Stop Condition */
+	I2C_Stop();
+}
+
+/*************************************************************************
+Put a char on the LCD Display. 
+Input:    data	char to be shown
+Returns:  none
+*************************************************************************/
+void sendData(uint8_t data)
+{
+	/* Send Address - Write Condition */
+	I2C_Start(LCD_ADDRESS_WR);
+	
+	/* Send Data. MS Nibble, LS Nibble */
+	LCD_Nibble(data, (1 << RS));
+	LCD_Nibble(data << 4, (1 << RS));
+	
+	/* Stop Condition */
+	I2C_Stop();
+}
+
+/*************************************************************************
+Turn the backlight on or off and stop the pattern.
+Input:    on 	1 to turn it on
+Returns:  none
+*************************************************************************/
+void LCD_Backlight(uint8_t on)
+{
+	LCD_OnTicks = 0;
+	LCD_OffTicks = 0;
+	
+	if (on)
+		LCD_Ctrl |= (1 << BL);
+	else
+		LCD_Ctrl &= ~(1 << BL);
+	LCD_Write((LCD_Shadow & ~((1 << BL) | LCD_GPIO_MASK)) | LCD_Ctrl);
+}
+
+/*************************************************************************
+Set the backlight pattern.
+Input:    on_ticks 	ticks with the backlight on
+		  off_ticks ticks with the backlight off
+Returns:  none
+*************************************************************************/
+void LCD_BacklightPattern(uint8_t on_ticks, uint8_t off_ticks)
+{
+	LCD_OnTicks = on_ticks;
+	LCD_OffTicks = off_ticks;
+	LCD_Ticks = 0;
+}
+
+/*************************************************************************
+Advance the backlight pattern one tick.
+Input:    none
+Returns:  none
+*************************************************************************/
+void LCD_BacklightTick(void)
+{
+	if (LCD_OnTicks == 0 && LCD_OffTicks == 0)
+		return;
+	
+	/* On for the first ticks of the period, then off */
+	if (LCD_Ticks < LCD_OnTicks)
+		LCD_Ctrl |= (1 << BL);
+	else
+		LCD_Ctrl &= ~(1 << BL);
+	if (++LCD_Ticks >= (uint16_t)LCD_OnTicks + LCD_OffTicks)
+		LCD_Ticks = 0;
+	
+	LCD_Write((LCD_Shadow & ~(1 << BL)) | (LCD_Ctrl & (1 << BL)));
+}
+
+/*************************************************************************
+Set spare pins of the expander.
+Input:    mask 	pins to be changed
+		  value new value of the pins
+Returns:  none
+*************************************************************************/
+void LCD_SetPins(uint8_t mask, uint8_t value)
+{
+	mask &= LCD_GPIO_MASK;
+	LCD_Ctrl = (LCD_Ctrl & ~mask) | (value & mask);
+	LCD_Write((LCD_Shadow & ~mask) | (value & mask));
+}
+
+/*************************************************************************
+Change the current position of the cursor 
+Input:    row	Choose the new row
+		  col 	Choose the new col
+Returns:  none
+*************************************************************************/
+void LCD_GotoXY (uint8_t row, uint8_t col)
+{
+	/* Rows out of the display are ignored */
+	if (row == 0 || row > LCD_ROWS)
+		return;
+	
+	/* Change the cursor*/
+	LCD_Row = row - 1;
+	LCD_Col = col;
+	sendCMD(LCD_DDRAM | (LCD_RowOffset[LCD_Row] + col));
+}
+
+/*************************************************************************
+Put a char at the cursor and advance the column.
+Input:    c 	char to be shown
+Returns:  none
+*************************************************************************/
+void LCD_Char(uint8_t c)
+{
+	#if LCD_WRAP
+	/* End of the row: continue on the next one */
+	if (LCD_Col >= LCD_COLS)
+		LCD_GotoXY((LCD_Row + 1) % LCD_ROWS + 1, 0);
+	#endif
+	sendData(c);
+	LCD_Col++;
+}
+
+/*************************************************************************
+Put a String on the LCD Display. 
+Input:    arr1	String to be shown
+Returns:  none
+*************************************************************************/
+void LCD_String(char* arr1)
+{
+	/* Last char will be null. Check for characters to send*/
+	while(*arr1 != 0x00)
+	{
+		LCD_Char(*arr1);		// Send 1 char at the time
+		arr1++;					// Increment the index
+	}
+}
+
+/*************************************************************************
+Write a text on a row without wrapping, to be scrolled. 
+Input:    row	row of the text
+		  arr1	String to be shown
+Returns:  none
+*************************************************************************/
+void LCD_Marquee(uint8_t row, char* arr1)
+{
+	uint8_t len = 0;
+	
+	LCD_GotoXY(row, 0);
+	while(*arr1 != 0x00 && len < LCD_LINE_LEN)
+	{
+		sendData(*arr1);
+		arr1++;
+		len++;
+	}
+	LCD_Col += len;
+}
+
+/*************************************************************************
+Put a Number on the LCD Display. 
+Input:    numb	number to be shown
+Returns:  none
+*************************************************************************/
+void LCD_Number(uint16_t numb)
+{
+	char array[6];				// 5 digits of the number and the null char
+	utoa(numb, array, 10);		// Radix for the conversion: 10
+	LCD_String(array);			// Send the ASCII codes obtained from data
+	
 }
\ No newline at end of file
@@ -1,177 +1,270 @@
-#ifndef LCDI2C_H_
-#define LCDI2C_H_
-
-/*************************************************************************
- Title	:   C include file for the LCD - I2C adapter library (LCDI2C.c)
- Author	:   Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the I2C protocol and LCD commands.
-
-       Originally based on the Github Code of eagl1 
-       (https://github.com/eagl1/LCD1602_I2C_all_code). Changed
-       the macros and new functions for the LCD. 
-       Designed for the ATmega328P microcontroller.
-
-       This Library only uses the I2C pins of the AVR. 
-       The bit rate to initialize the I2C is MYTWBR. 
-       This value is obtain from a Macro definition.
-
-*****************************************************************************/
-
-
-/**
-*	I2C Clock Definitions
-*	Used to obtain the UBRR value for the desired baud rate.
-*
-*/
-#ifndef F_CPU		/* Prevent compiler error by supplying a default */
-#define F_CPU 1000000UL
-#endif
-#define I2C_VEL			10000			// 10 kHz for the I2C
-#define MYTWBR			((F_CPU/I2C_VEL - 16)/2)	
-
-
-/**
-*	I2C-Adapter Address
-*	Choose the address of the I2C adapter. The default values 
-*	are 0x27 and 0x3F. Change if needed.
-*
-*/
-#define LCD_Add			0x27			// Address of the LCD
-
-
-/**
-*	LCD Pins definition
-*	Choose the enable, register select and read/write pins of the LCD. The default 
-* 	values are 2,1,0 respectively. 
-*
-*/
-#define E				2   			// E  bit
-#define RW				1   			// RW bit
-#define RS				0   			// RS bit
-
-
-/**
-*	LCD Command Definitions
-*	Used to configure the device. This commands are used on the 
-*	LCD_Init() function. 
-*
-*/
-#define LCD_8BIT					0x33
-#define LCD_4BIT					0x32
-#define LCD_CLR						0x01
-#define LCD_ROW1					0x80
-#define LCD_ROW2					0xC0
-#define LCD_DISP_ON					0x0C
-#define LCD_DISP_ON_CURSOR			0x0E
-#define LCD_DISP_ON_CURSOR_BLINK	0x0F
-#define LCD_FUNCTION_4BIT_2LINES	0x28
-
-
-/**
-*	LCD Macro Definitions
-*	A brief set of macros to make the code easier to read.
-*
-*/
-#define LCD_Add_WR		((LCD_Add<<1)|TW_WRITE)
-#define LCD_Add_RD		((LCD_Add<<1)|TW_READ)
-#define LCD_Clear()		(sendCMD(LCD_CLR))
-#define LCD_Up()		(sendCMD(LCD_ROW1))
-#define LCD_Down()		(sendCMD(LCD_ROW2))
-
-
-
-/**
-*	Functions - LCD
-*/
-
-/**
- @brief		Low-level function to initialize the LCD. 
- @param		none
- @return 	none
-*/
-void LCD_Init(void);
-
-/**
- @brief		Allows to write new commands to the LCD.
- @param		CMD 	Command to be send
- @return 	none
-*/
-void sendCMD(uint8_t CMD);
-
-/**
- @brief		Change the current position of the cursor 
- @param		row 	Choose the new row
- 			col 	Choose the new col
- @return 	none
-*/
-void LCD_GotoXY (uint8_t row, uint8_t col);
-
-/**
- @brief		Put a String on the LCD Display. 
- @param		arr1	String to be shown
- @return 	none
-*/
-void LCD_String(char* arr1);
-
-/**
- @brief		Put a Number on the LCD Display.
- @param		numb	number to be shown
- @return 	none
-*/
-void LCD_Number(uint16_t numb);
-
-
-
-
-/**
-*	Functions - I2C
-*/
-
-/**
- @brief		Low-level function to initialize the I2C
- @param		none
- @return 	none
-*/
-void I2C_Init(void);
-
-/**
- @brief		Low-level function that send a Start condition and the address of a device.
- @param		address 	Address of device with a W/R condition at the end.
- @return 	none
-*/
-void I2C_Start(uint8_t address);
-
-/**
- @brief		Low-level function that send a Stop condition.
- @param		none
- @return 	none
-*/
-void I2C_Stop(void);
-
-/**
- @brief		Send Byte through I2C. Wait for the acknowledge bit.
- @param		data 	byte to be send
- @return 	none
-*/
-void I2C_Transmit(uint8_t data);
-
-/**
- @brief		Waits until there are new data. 
- @param		none
- @return 	Data received from the UART. 
-*/
-uint8_t I2C_Receive(void);
-
-/**
- @brief		Low-level function to initialize the LCD. 
- @param		none
- @return 	none
-*/
-
-
-
+#ifndef LCDI2C_H_
+#define LCDI2C_H_
+
+/*************************************************************************
+ Title	:   C include file for the LCD - I2C adapter library (LCDI2C.c)
+ Author	:   Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the LCD commands.
+
+       Originally based on the Github Code of eagl1 
+       (https://github.com/eagl1/LCD1602_I2C_all_code). Changed
+       the macros and new functions for the LCD. 
+       Designed for the ATmega328P microcontroller.
+
+       The LCD is one device of the I2C bus, the TWI functions are in 
+       the I2C library (AVR_I2C). Call I2C_Init() before LCD_Init().
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	I2C Definitions
+*	The clock, sleep and timeout of the bus are set in I2C.h.
+*
+*/
+#include "../AVR_I2C/I2C.h"
+
+
+/**
+*	I2C-Adapter Address
+*	LCD_Add, the address of the I2C adapter, is set in CONFIG.h. The 
+*	usual values are 0x27 and 0x3F. With EECONFIG_ENABLE, LCD_Init()
+*	takes lcd_addr of EECONFIG_Data instead.
+*
+*/
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	LCD Geometry
+*	Choose the size of the display: 16x2, 20x4, 40x2, 16x4, ... The start 
+*	address of each row is computed from the number of columns. With 
+*	LCD_WRAP, LCD_String() continues on the next row at the end of a row.
+*
+*/
+#ifndef LCD_COLS
+#define LCD_COLS		16
+#endif
+#ifndef LCD_ROWS
+#define LCD_ROWS		2
+#endif
+#ifndef LCD_WRAP
+#define LCD_WRAP		1
+#endif
+
+#if (LCD_ROWS < 1) || (LCD_ROWS > 4) || (LCD_COLS * ((LCD_ROWS + 1) / 2) > 40) || (LCD_ROWS > 2 && LCD_COLS > 20)
+	#error "LCD_COLS x LCD_ROWS is not a valid HD44780 geometry"
+#endif
+
+#define LCD_LINE_LEN	40				// DDRAM chars of each line
+
+
+/**
+*	LCD Pins definition
+*	Choose the enable, register select and read/write pins of the LCD. The default 
+* 	values are 2,1,0 respectively. 
+*
+*/
+#define BL				3				// Backlight bit
+#define E				2   			// E  bit
+#define RW				1   			// RW bit
+#define RS				0   			// RS bit
+
+
+/**
+*	PCF8574 Spare Pins
+*	Pins of the expander that are not connected to the LCD and can be used
+*	as outputs with LCD_SetPins(). The common adapters use all 8 pins, so 
+*	the default is none. P4-P7, RS and E are written by every nibble and BL
+*	by the backlight, so only P1 can be spare, on adapters that tie RW of 
+*	the LCD to GND: with RW wired, a high P1 makes the LCD drive the bus.
+*
+*/
+#ifndef LCD_GPIO_MASK
+#define LCD_GPIO_MASK	0x00
+#endif
+
+#if LCD_GPIO_MASK & ~(1 << RW)
+	#error "LCD_GPIO_MASK can only have the RW pin, the others drive the LCD"
+#endif
+
+
+/**
+*	Backlight Pattern Tick
+*	Each tick of LCD_BacklightTick() can write the expander once: Start, 
+*	address, data and Stop, about 20 SCL periods. LCD_TICK_MIN_US is that 
+*	time for I2C_VEL, the shortest tick the pattern can keep (2000 us at 
+*	the default 10 kHz, 200 us at 100 kHz). Define LCD_TICK_US with the 
+*	period of the calls to have it checked at compile time.
+*
+*/
+#define LCD_TICK_MIN_US		((20UL * 1000000UL) / (I2C_VEL))
+
+#if defined(LCD_TICK_US) && (LCD_TICK_US < LCD_TICK_MIN_US)
+	#error "LCD_TICK_US is shorter than one write of the expander at I2C_VEL"
+#endif
+
+/* A char or a command (sendData(), sendCMD(), LCD_Char(), LCD_GotoXY())
+   is one transfer of up to 5 bytes, at most 56 SCL periods: 5600 us at 
+   10 kHz, 560 us at 100 kHz */
+#define LCD_CHAR_US			((56UL * 1000000UL) / (I2C_VEL))
+
+
+/**
+*	LCD Command Definitions
+*	Used to configure the device. This commands are used on the 
+*	LCD_Init() function. 
+*
+*/
+#define LCD_8BIT					0x33
+#define LCD_4BIT					0x32
+#define LCD_CLR						0x01
+#define LCD_ROW1					0x80
+#define LCD_ROW2					0xC0
+#define LCD_DISP_ON					0x0C
+#define LCD_DISP_ON_CURSOR			0x0E
+#define LCD_DISP_ON_CURSOR_BLINK	0x0F
+#define LCD_FUNCTION_4BIT_2LINES	0x28
+#define LCD_FUNCTION_4BIT_1LINE		0x20
+#define LCD_HOME					0x02
+#define LCD_SHIFT_LEFT				0x18
+#define LCD_SHIFT_RIGHT				0x1C
+#define LCD_DDRAM					0x80
+
+
+/**
+*	LCD Macro Definitions
+*	A brief set of macros to make the code easier to read.
+*
+*/
+#define LCD_Add_WR		I2C_ADD_WR(LCD_Add)
+#define LCD_Add_RD		I2C_ADD_RD(LCD_Add)
+#define LCD_Up()		(LCD_GotoXY(1, 0))
+#define LCD_Down()		(LCD_GotoXY(2, 0))
+#define LCD_ScrollLeft()	(sendCMD(LCD_SHIFT_LEFT))
+#define LCD_ScrollRight()	(sendCMD(LCD_SHIFT_RIGHT))
+
+
+
+/**
+*	Functions - LCD
+*/
+
+/**
+ @brief		Low-level function to initialize the LCD. 
+ @param		none
+ @return 	none
+*/
+void LCD_Init(void);
+
+/**
+ @brief		Allows to write new commands to the LCD.
+ @param		CMD 	Command to be send
+ @return 	none
+*/
+void sendCMD(uint8_t CMD);
+
+/**
+ @brief		Put a char on the LCD Display.
+ @param		data 	char to be shown
+ @return 	none
+*/
+void sendData(uint8_t data);
+
+/**
+ @brief		Clear the display, return the cursor and the scroll to the start.
+ @param		none
+ @return 	none
+*/
+void LCD_Clear(void);
+
+/**
+ @brief		Change the current position of the cursor 
+ @param		row 	Choose the new row, 1 to LCD_ROWS
+ 			col 	Choose the new col, from 0
+ @return 	none
+*/
+void LCD_GotoXY (uint8_t row, uint8_t col);
+
+/**
+ @brief		Put a char at the cursor and advance it. With LCD_WRAP the char
+ 			goes to the next row when the row is full. Use it instead of 
+ 			sendData() for text, which does not move the cursor position 
+ 			kept by the library.
+ @param		c 	char to be shown
+ @return 	none
+*/
+void LCD_Char(uint8_t c);
+
+/**
+ @brief		Put a String on the LCD Display. With LCD_WRAP the text 
+ 			continues on the next row when a row is full.
+ @param		arr1	String to be shown
+ @return 	none
+*/
+void LCD_String(char* arr1);
+
+/**
+ @brief		Write a text of up to LCD_LINE_LEN chars on a row, without 
+ 			wrapping, for a marquee. Each LCD_ScrollLeft() or 
+ 			LCD_ScrollRight() then moves the display one char with a single
+ 			command. On 4 row displays rows 1-3 and 2-4 share a line and 
+ 			all the rows move together.
+ @param		row 	row of the text
+ 			arr1	String to be shown
+ @return 	none
+*/
+void LCD_Marquee(uint8_t row, char* arr1);
+
+/**
+ @brief		Turn the backlight on or off. Stops the pattern of 
+ 			LCD_BacklightPattern(). Nothing is sent if it does not change.
+ @param		on 	1 to turn it on, 0 to turn it off
+ @return 	none
+*/
+void LCD_Backlight(uint8_t on);
+
+/**
+ @brief		Set a backlight pattern driven by LCD_BacklightTick(): on for 
+ 			on_ticks and off for off_ticks. The tick can not be shorter than
+ 			LCD_TICK_MIN_US. At 10 kHz, with a tick every 2 ms, (1, 3) dims 
+ 			the backlight to 25% at 125 Hz. Every 10 ms, (50, 50) blinks it.
+ @param		on_ticks 	ticks with the backlight on
+ 			off_ticks 	ticks with the backlight off
+ @return 	none
+*/
+void LCD_BacklightPattern(uint8_t on_ticks, uint8_t off_ticks);
+
+/**
+ @brief		Advance the backlight pattern. Call it periodically from the 
+ 			main loop, not from an ISR. Only writes the expander on a change.
+ @param		none
+ @return 	none
+*/
+void LCD_BacklightTick(void);
+
+/**
+ @brief		Set spare pins of the expander (LCD_GPIO_MASK) as outputs. 
+ 			Nothing is sent if the pins do not change.
+ @param		mask 	pins to be changed
+ 			value 	new value of the pins
+ @return 	none
+*/
+void LCD_SetPins(uint8_t mask, uint8_t value);
+
+/**
+ @brief		Put a Number on the LCD Display.
+ @param		numb	number to be shown
+ @return 	none
+*/
+void LCD_Number(uint16_t numb);
+
+
+
 #endif /* LCDI2C_H_ */
\ No newline at end of file
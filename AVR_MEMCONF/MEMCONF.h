@@ -0,0 +1,196 @@
+#ifndef MEMCONF_H_
+#define MEMCONF_H_
+
+/*************************************************************************
+ Title	:   C include file for the memory configuration of the libraries
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Sizes of every buffer of the libraries in one place.
+
+       Each value can be changed here or supplied with -D for each build.
+       The sizes are checked at compile time, the ring buffers can be 
+       placed in the .noinit section and the buffers of the enabled 
+       libraries are added up and compared with MEM_RAM_BUDGET.
+
+       The feature switches come from CONFIG.h, included first, so the 
+       sum is the same in every file of the build.
+
+*****************************************************************************/
+
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	UART Buffer Sizes
+*	Used by AVR_UART. Power of 2 between 2 and 256 bytes.
+*
+*/
+#ifndef USART_RX_BUFFER_SIZE
+#define USART_RX_BUFFER_SIZE	8
+#endif
+#ifndef USART_TX_BUFFER_SIZE
+#define USART_TX_BUFFER_SIZE	8
+#endif
+
+
+/**
+*	Software UART Buffer Sizes
+*	Used by AVR_SWUART. Power of 2 between 2 and 256 bytes. The RX buffer
+*	holds a burst of the device (e.g. one NMEA sentence of a GPS is up to
+*	82 bytes, read it while it arrives).
+*
+*/
+#ifndef SWUART_RX_BUFFER_SIZE
+#define SWUART_RX_BUFFER_SIZE	32
+#endif
+#ifndef SWUART_TX_BUFFER_SIZE
+#define SWUART_TX_BUFFER_SIZE	8
+#endif
+
+
+/**
+*	ADC Buffer Sizes
+*	Used by AVR_ADC. ADC_BUFFER_SIZE is the number of values, power of 2 
+*	between 2 and 256. ADC_WD_PRETRIGGER is the capture window of the 
+*	watchdog (0 to 255), the size of its history, frozen during a 
+*	capture. ADCSTREAM_GROUPS is the number of 5-byte groups of 
+*	the stream blocks.
+*
+*/
+#ifndef ADC_BUFFER_SIZE
+#define ADC_BUFFER_SIZE			8
+#endif
+#ifndef ADC_WD_PRETRIGGER
+#define ADC_WD_PRETRIGGER		0
+#endif
+#ifndef ADCSTREAM_GROUPS
+#define ADCSTREAM_GROUPS		8
+#endif
+
+
+/**
+*	Shell Buffer Size
+*	Used by AVR_SHELL. Longest command line, with the null char.
+*
+*/
+#ifndef SHELL_LINE_SIZE
+#define SHELL_LINE_SIZE			32
+#endif
+
+
+/**
+*	Trace Buffer Size
+*	Used by AVR_TRACE. Number of 4-byte records, power of 2 between 2 
+*	and 256.
+*
+*/
+#ifndef TRACE_SIZE
+#define TRACE_SIZE				16
+#endif
+
+
+/**
+*	Buffer Checks
+*	The index math of the ring buffers needs powers of 2.
+*
+*/
+#define MEM_IS_POW2(size)		(((size) >= 2) && ((size) <= 256) && (((size) & ((size) - 1)) == 0))
+
+#if !MEM_IS_POW2(USART_RX_BUFFER_SIZE) || !MEM_IS_POW2(USART_TX_BUFFER_SIZE)
+	#error "UART buffer sizes must be a power of 2 between 2 and 256"
+#endif
+#if !MEM_IS_POW2(SWUART_RX_BUFFER_SIZE) || !MEM_IS_POW2(SWUART_TX_BUFFER_SIZE)
+	#error "Software UART buffer sizes must be a power of 2 between 2 and 256"
+#endif
+#if !MEM_IS_POW2(ADC_BUFFER_SIZE)
+	#error "ADC_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+#if !MEM_IS_POW2(TRACE_SIZE)
+	#error "TRACE_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+
+/**
+*	Ring Buffer Placement
+*	MEM_NOINIT places the ring buffers in the .noinit section: they are not
+*	cleared at reset, which saves startup time. The libraries reset the 
+*	indexes, so old contents are never read as data.
+*
+*/
+#ifndef MEM_NOINIT
+#define MEM_NOINIT				1
+#endif
+
+#if MEM_NOINIT
+	#define MEM_SECTION			__attribute__((section(".noinit")))
+#else
+	#define MEM_SECTION
+#endif
+
+
+/**
+*	RAM Budget
+*	Static RAM used by the buffers of each library, in bytes. UART and 
+*	ADC are always counted, the others only when CONFIG.h enables them. 
+*	The build fails if the total exceeds MEM_RAM_BUDGET.
+*	MEM_TOTAL_BYTES counts only the buffers sized here: the indexes, the
+*	flags and the other statics of the libraries are not included (a few
+*	bytes each, Stats_ arrays, EECONFIG_Data, the dashboard text...). The
+*	mem_report target of AVR_TEST lists all of them per module.
+*
+*/
+#ifndef MEM_RAM_BUDGET
+#define MEM_RAM_BUDGET			1024	/* Half of the 2 KB, rest for the stack */
+#endif
+
+#if ADC_MODE == EIGHTBIT
+	#define MEM_ADC_VALUE		1
+#else
+	#define MEM_ADC_VALUE		2
+#endif
+#if ADC_WATCHDOG
+	#define MEM_ADC_WINDOW		ADC_WD_PRETRIGGER
+#else
+	#define MEM_ADC_WINDOW		0
+#endif
+
+#if ADC_SCAN
+	#define MEM_ADC_SCAN		8
+#else
+	#define MEM_ADC_SCAN		0
+#endif
+
+#define MEM_UART_BYTES			(USART_RX_BUFFER_SIZE + USART_TX_BUFFER_SIZE)
+#define MEM_ADC_BYTES			((ADC_BUFFER_SIZE + MEM_ADC_WINDOW + MEM_ADC_SCAN) * MEM_ADC_VALUE)
+#if SWUART_ENABLE
+	#define MEM_SWUART_BYTES	(SWUART_RX_BUFFER_SIZE + SWUART_TX_BUFFER_SIZE)
+#else
+	#define MEM_SWUART_BYTES	0
+#endif
+#if ADC_STREAM
+	#define MEM_ADCSTREAM_BYTES	(2 * (ADCSTREAM_GROUPS * 5 + 5))
+#else
+	#define MEM_ADCSTREAM_BYTES	0
+#endif
+#if SHELL_ENABLE
+	#define MEM_SHELL_BYTES		(SHELL_LINE_SIZE)
+#else
+	#define MEM_SHELL_BYTES		0
+#endif
+#if TRACE_ENABLE
+	#define MEM_TRACE_BYTES		(TRACE_SIZE * 4)
+#else
+	#define MEM_TRACE_BYTES		0
+#endif
+
+#define MEM_TOTAL_BYTES			(MEM_UART_BYTES + MEM_SWUART_BYTES + MEM_ADC_BYTES + MEM_ADCSTREAM_BYTES + MEM_SHELL_BYTES + MEM_TRACE_BYTES)
+
+#if MEM_TOTAL_BYTES > MEM_RAM_BUDGET
+	#error "Buffers of the libraries exceed MEM_RAM_BUDGET"
+#endif
+
+
+#endif /* MEMCONF_H_ */
@@ -1,93 +1,125 @@
-/*************************************************************************
- Title	:   RGB-Led library (RGBLED.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic library for use a RGB Led.
-
-       This Library uses macro definitions for the port, 
-       the pin and the type of the Led. The values are only dominant colors.
-       This Library does not include a function to change the brightness of
-       the Led.
-
- USAGE
-       See the C include RGBLED.h file for a description of each function
-       
-*****************************************************************************/
-
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <util/delay.h>
-#include "RGBLED.h"
-
-
-/*
-**	functions
-*/
-
-/*************************************************************************
-Low-level function to initialize the LED.
-Input:    none
-Returns:  none
-*************************************************************************/
-void RGBLed_Init(void)
-{
-	RGB_CLEAR();										// Turn off the pins
-	DDR_RGB |= (1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B);		// Pins as output
-}
-
-/*************************************************************************
-Change the color of the RGB Led.
-Input:    color 	color the led will shown
-Returns:  none
-*************************************************************************/
-void RGBLed_Color(uint8_t color)
-{
-	RGB_CLEAR();
-	switch(color)
-	{
-		case RED:
-			RGB_RED();
-			break;
-		case GREEN:
-			RGB_GREEN();
-			break;
-		case BLUE:
-			RGB_BLUE();
-			break;
-		case YELLOW:
-			RGB_GREEN();
-			RGB_RED();
-			break;
-		case CYAN:
-			RGB_BLUE();
-			RGB_GREEN();
-			break;
-		case MAGENTA:
-			RGB_BLUE();
-			RGB_RED();
-			break;
-		default:
-			break;
-	}
-	
-}
-
-/*************************************************************************
-Blink the led every second. The value can be modified if needed.
-Input:    none
-Returns:  none
-*************************************************************************/
-void RGBLed_Blink(void)
-{
-	RGB_CLEAR();
-	_delay_ms(1000);
-	RGB_ALL();
-	_delay_ms(1000);
-}
-
-
-
-
+/*************************************************************************
+ Title	:   RGB-Led library (RGBLED.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic library for use a RGB Led.
+
+       This Library uses macro definitions for the port, 
+       the pin and the type of the Led. The values are only dominant colors.
+       This Library does not include a function to change the brightness of
+       the Led.
+
+ USAGE
+       See the C include RGBLED.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "../AVR_CONFIG/CONFIG.h"			/* F_CPU for <util/delay.h> */
+#include <util/delay.h>
+#include "RGBLED.h"
+#include "../AVR_EECONFIG/EECONFIG.h"
+
+
+/* Static Variables */
+#if EECONFIG_ENABLE
+static uint8_t RGB_Type = TYPE_RGB;				// Taken from EECONFIG_Data at init
+#else
+#define RGB_Type		TYPE_RGB
+#endif
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Turn on pins of a mask and off the others, with one write of the port.
+The read-modify-write is atomic: an ISR that changes other pins of the
+port meanwhile would be undone by the write.
+Input:    mask 	pins to be changed
+		  on 	pins to be turned on
+Returns:  none
+*************************************************************************/
+void RGBLed_Pins(uint8_t mask, uint8_t on)
+{
+	mask &= RGB_MASK;
+	if (RGB_Type == COMMON_ANODE)
+		on ^= mask;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		PORT_RGB = (PORT_RGB & ~mask) | (on & mask);
+	}
+}
+
+/*************************************************************************
+Low-level function to initialize the LED.
+Input:    none
+Returns:  none
+*************************************************************************/
+void RGBLed_Init(void)
+{
+	#if EECONFIG_ENABLE
+	RGB_Type = EECONFIG_Data.rgb_type;
+	#endif
+	RGBLed_Pins(RGB_MASK, 0);							// Turn off the pins
+	DDR_RGB |= (1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B);		// Pins as output
+}
+
+/*************************************************************************
+Change the color of the RGB Led.
+Input:    color 	color the led will shown
+Returns:  none
+*************************************************************************/
+void RGBLed_Color(uint8_t color)
+{
+	uint8_t on;
+	
+	switch(color)
+	{
+		case RED:
+			on = (1<<PIN_R);
+			break;
+		case GREEN:
+			on = (1<<PIN_G);
+			break;
+		case BLUE:
+			on = (1<<PIN_B);
+			break;
+		case YELLOW:
+			on = (1<<PIN_G)|(1<<PIN_R);
+			break;
+		case CYAN:
+			on = (1<<PIN_B)|(1<<PIN_G);
+			break;
+		case MAGENTA:
+			on = (1<<PIN_B)|(1<<PIN_R);
+			break;
+		default:
+			on = 0;
+			break;
+	}
+	RGBLed_Pins(RGB_MASK, on);
+}
+
+/*************************************************************************
+Blink the led every second. The value can be modified if needed.
+Input:    none
+Returns:  none
+*************************************************************************/
+void RGBLed_Blink(void)
+{
+	RGBLed_Pins(RGB_MASK, 0);
+	_delay_ms(1000);
+	RGBLed_Pins(RGB_MASK, RGB_MASK);
+	_delay_ms(1000);
+}
+
+
+
+
@@ -1,99 +1,118 @@
-#ifndef RGBLED_H_
-#define RGBLED_H_
-
-/*************************************************************************
- Title	:   C include file for the RGB-Led library (RGBLED.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic library for use a RGB Led.
-
-       This Library uses macro definitions for the port, 
-       the pin and the type of the Led. The values are only dominant colors.
-       This Library does not include a function to change the brightness of
-       the Led.
-       
-*****************************************************************************/
-
-/**
-*	RGB Type Definitions
-*	Declare the 2 types of RGB Led.
-*
-*/
-#define COMMON_ANODE		0
-#define COMMON_CATHODE		1
-
-/**
-*	RGB Usage Definitions
-*	Choose the type of led and the port definitions.
-*
-*/
-#define TYPE_RGB		COMMON_CATHODE
-#define PORT_RGB		PORTD
-#define DDR_RGB			DDRD
-#define PIN_R			3
-#define PIN_G			4
-#define PIN_B			5
-
-/**
-*	RGB Macros
-*	Macros for both types of RGBs. 
-*
-*/
-#if TYPE_RGB == COMMON_CATHODE
-	#define RGB_CLEAR()		(PORT_RGB &= ~((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
-	#define RGB_ALL()		(PORT_RGB |= (1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B))
-	#define RGB_RED()		(PORT_RGB |= (1<<PIN_R))
-	#define RGB_GREEN()		(PORT_RGB |= (1<<PIN_G))
-	#define RGB_BLUE()		(PORT_RGB |= (1<<PIN_B))
-#else
-	#define RGB_CLEAR()		(PORT_RGB |= ((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
-	#define RGB_ALL()		(PORT_RGB &= ~((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
-	#define RGB_RED()		(PORT_RGB &= ~(1<<PIN_R))
-	#define RGB_GREEN()		(PORT_RGB &= ~(1<<PIN_G))
-	#define RGB_BLUE()		(PORT_RGB &= ~(1<<PIN_B))
-#endif
-
-/**
-*	RGB Colors
-*	Macros for the colors that the LED can shown. 
-*
-*/
-#define RED				0
-#define GREEN			1
-#define BLUE			2
-#define YELLOW			3
-#define CYAN			4
-#define MAGENTA			5
-
-
-
-/**
-*	Functions 
-*/
-
-/**
- @brief		Configure the port of the LED as output.
- @param		none
- @return 	none
-*/
-void RGBLed_Init(void);
-
-/**
- @brief		Change the color of the RGB Led. 
- @param		color 	color the led will shown
- @return 	none
-*/
-void RGBLed_Color(uint8_t color);
-
-/**
- @brief		Blink the led every second. The value can be modified if needed. 
- @param		none
- @return 	none
-*/
-void RGBLed_Blink(void);
-
-
+#ifndef RGBLED_H_
+#define RGBLED_H_
+
+/*************************************************************************
+ Title	:   C include file for the RGB-Led library (RGBLED.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic library for use a RGB Led.
+
+       This Library uses macro definitions for the port, 
+       the pin and the type of the Led. The values are only dominant colors.
+       This Library does not include a function to change the brightness of
+       the Led.
+       
+*****************************************************************************/
+
+#include <stdint.h>
+
+/**
+*	RGB Type Definitions
+*	The 2 types of RGB Led, COMMON_ANODE and COMMON_CATHODE, and the 
+*	TYPE_RGB of the board are in CONFIG.h.
+*
+*/
+#include "../AVR_CONFIG/CONFIG.h"
+
+/**
+*	RGB Usage Definitions
+*	The port definitions. With EECONFIG_ENABLE, RGBLed_Init() takes 
+*	rgb_type of EECONFIG_Data instead of TYPE_RGB.
+*
+*/
+#define PORT_RGB		PORTD
+#define DDR_RGB			DDRD
+#define PIN_R			3
+#define PIN_G			4
+#define PIN_B			5
+#define RGB_MASK		((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B))
+
+/**
+*	RGB Macros
+*	Macros for both types of RGBs. With EECONFIG_ENABLE the type is only
+*	known after RGBLed_Init(), the macros call RGBLed_Pins() instead of 
+*	writing the port.
+*
+*/
+#if EECONFIG_ENABLE
+	#define RGB_CLEAR()		(RGBLed_Pins(RGB_MASK, 0))
+	#define RGB_ALL()		(RGBLed_Pins(RGB_MASK, RGB_MASK))
+	#define RGB_RED()		(RGBLed_Pins((1<<PIN_R), (1<<PIN_R)))
+	#define RGB_GREEN()		(RGBLed_Pins((1<<PIN_G), (1<<PIN_G)))
+	#define RGB_BLUE()		(RGBLed_Pins((1<<PIN_B), (1<<PIN_B)))
+#elif TYPE_RGB == COMMON_CATHODE
+	#define RGB_CLEAR()		(PORT_RGB &= ~((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
+	#define RGB_ALL()		(PORT_RGB |= (1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B))
+	#define RGB_RED()		(PORT_RGB |= (1<<PIN_R))
+	#define RGB_GREEN()		(PORT_RGB |= (1<<PIN_G))
+	#define RGB_BLUE()		(PORT_RGB |= (1<<PIN_B))
+#else
+	#define RGB_CLEAR()		(PORT_RGB |= ((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
+	#define RGB_ALL()		(PORT_RGB &= ~((1<<PIN_R)|(1<<PIN_G)|(1<<PIN_B)))
+	#define RGB_RED()		(PORT_RGB &= ~(1<<PIN_R))
+	#define RGB_GREEN()		(PORT_RGB &= ~(1<<PIN_G))
+	#define RGB_BLUE()		(PORT_RGB &= ~(1<<PIN_B))
+#endif
+
+/**
+*	RGB Colors
+*	Macros for the colors that the LED can shown. 
+*
+*/
+#define RED				0
+#define GREEN			1
+#define BLUE			2
+#define YELLOW			3
+#define CYAN			4
+#define MAGENTA			5
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Configure the port of the LED as output.
+ @param		none
+ @return 	none
+*/
+void RGBLed_Init(void);
+
+/**
+ @brief		Change the color of the RGB Led. 
+ @param		color 	color the led will shown
+ @return 	none
+*/
+void RGBLed_Color(uint8_t color);
+
+/**
+ @brief		Turn on or off some pins of the LED, for the type of RGBLed_Init().
+ @param		mask 	pins to be changed (1<<PIN_R, 1<<PIN_G, 1<<PIN_B)
+ 			on 		pins of the mask to be turned on, the others are turned off
+ @return 	none
+*/
+void RGBLed_Pins(uint8_t mask, uint8_t on);
+
+/**
+ @brief		Blink the led every second. The value can be modified if needed. 
+ @param		none
+ @return 	none
+*/
+void RGBLed_Blink(void);
+
+
 #endif /* RGBLED_H_ */
\ No newline at end of file
@@ -0,0 +1,352 @@
+/*************************************************************************
+ Title	:   UART shell library (SHELL.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Small command line over the UART library.
+
+       The commands are stored in sorted tables in the flash and are 
+       found with a binary search. The arguments are split in place in 
+       the line buffer, no dynamic memory is used.
+
+ USAGE
+       See the C include SHELL.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "SHELL.h"
+#include "../AVR_UART/UART.h"
+#if SHELL_CMD_ADC
+#include "../AVR_ADC/ADC.h"
+#endif
+#if SHELL_CMD_RGB
+#include "../AVR_RGBLED/RGBLED.h"
+#endif
+#if SHELL_CMD_LCD
+#include "../AVR_LCDI2C/LCDI2C.h"
+#endif
+
+#if !SHELL_ENABLE
+	#error "Set SHELL_ENABLE to 1 in CONFIG.h to build SHELL.c"
+#endif
+
+/* Static Variables */
+static char Shell_Line[SHELL_LINE_SIZE];
+static uint8_t Shell_Length;
+static uint8_t Shell_Overflow;				// Chars were lost, the line is rejected
+static uint8_t Shell_LastChar;
+static const command_SHELL* Shell_UserTable;
+static uint8_t Shell_UserCount;
+
+
+
+/*
+**	built-in commands
+*/
+
+static void Shell_Help(uint8_t argc, char** argv);
+
+#if SHELL_CMD_ADC
+/*************************************************************************
+Read a decimal argument. Only digits are accepted, unlike atoi() that 
+returns 0 for "abc" and 3 for "3x".
+Input:    arg 		argument
+		  value 	number read
+Returns:  1 if the argument is a number from 0 to 255
+*************************************************************************/
+static uint8_t Shell_Number(const char* arg, uint8_t* value)
+{
+	uint16_t number = 0;
+	
+	if (*arg == 0x00)
+		return 0;
+	while (*arg != 0x00)
+	{
+		if (*arg < '0' || *arg > '9')
+			return 0;
+		number = number * 10 + (*arg - '0');
+		if (number > 255)
+			return 0;
+		arg++;
+	}
+	*value = number;
+	return 1;
+}
+
+/*************************************************************************
+adc <channel>: start a conversion on the channel and send the value. The
+channel of the application is restored.
+*************************************************************************/
+static void Shell_Adc(uint8_t argc, char** argv)
+{
+	uint8_t channel;
+	uint8_t previous;
+	value_ADC value;
+	
+	if (argc < 2)
+	{
+		USART_putString_P(PSTR("usage: adc <channel>\r\n"));
+		return;
+	}
+	if (!Shell_Number(argv[1], &channel) || (channel > ADC_CH_TEMP && channel < ADC_CH_BANDGAP) || channel > ADC_CH_GND)
+	{
+		USART_putString_P(PSTR("invalid channel\r\n"));
+		return;
+	}
+	/* Not initialized or streaming: ADC_GetValue() would never return */
+	if (!ADC_Ready())
+	{
+		USART_putString_P(PSTR("adc not ready\r\n"));
+		return;
+	}
+	previous = ADC_GetChannel();
+	ADC_SetChannel(channel);
+	ADC_Flush();
+	ADC_Start();
+	value = ADC_GetValue();
+	ADC_SetChannel(previous);
+	USART_putNumber(value);
+	USART_putString_P(PSTR("\r\n"));
+}
+#endif
+
+#if SHELL_CMD_LCD
+/*************************************************************************
+lcd <text>: clear the LCD and write the arguments separated by spaces.
+*************************************************************************/
+static void Shell_Lcd(uint8_t argc, char** argv)
+{
+	uint8_t i;
+	
+	LCD_Clear();
+	for (i = 1; i < argc; i++)
+	{
+		if (i > 1)
+			LCD_Char(' ');
+		LCD_String(argv[i]);
+	}
+}
+#endif
+
+#if SHELL_CMD_RGB
+/* Names of the colors, in the order of the color macros of RGBLED.h */
+static const char Shell_Colors[][8] PROGMEM = 
+{
+	"red", "green", "blue", "yellow", "cyan", "magenta"
+};
+
+/*************************************************************************
+rgb <color>: set the color of the RGB Led. "off" or unknown names clear it.
+*************************************************************************/
+static void Shell_Rgb(uint8_t argc, char** argv)
+{
+	uint8_t color;
+	
+	if (argc < 2)
+	{
+		USART_putString_P(PSTR("usage: rgb <red|green|blue|yellow|cyan|magenta|off>\r\n"));
+		return;
+	}
+	for (color = 0; color < sizeof(Shell_Colors)/sizeof(Shell_Colors[0]); color++)
+	{
+		if (strcmp_P(argv[1], Shell_Colors[color]) == 0)
+			break;
+	}
+	/* A color out of the list clears the Led */
+	RGBLed_Color(color);
+}
+#endif
+
+/* Built-in commands, sorted by name */
+static const command_SHELL Shell_Builtin[] PROGMEM = 
+{
+	#if SHELL_CMD_ADC
+	{ "adc", Shell_Adc },
+	#endif
+	{ "help", Shell_Help },
+	#if SHELL_CMD_LCD
+	{ "lcd", Shell_Lcd },
+	#endif
+	#if SHELL_CMD_RGB
+	{ "rgb", Shell_Rgb },
+	#endif
+};
+#define SHELL_BUILTIN_COUNT		(sizeof(Shell_Builtin)/sizeof(Shell_Builtin[0]))
+
+/*************************************************************************
+help: send the names of all the commands.
+*************************************************************************/
+static void Shell_Help(uint8_t argc, char** argv)
+{
+	uint8_t i;
+	(void)argc;
+	(void)argv;
+	
+	for (i = 0; i < Shell_UserCount; i++)
+	{
+		USART_putString_P(Shell_UserTable[i].name);
+		USART_Transmit(' ');
+	}
+	for (i = 0; i < SHELL_BUILTIN_COUNT; i++)
+	{
+		USART_putString_P(Shell_Builtin[i].name);
+		USART_Transmit(' ');
+	}
+	USART_putString_P(PSTR("\r\n"));
+}
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Binary search of a command in a sorted table of the flash.
+Input:    table 	commands sorted by name
+		  count 	number of commands
+		  name 		name to be found
+Returns:  handler of the command, NULL if it is not in the table
+*************************************************************************/
+static handler_SHELL Shell_Find(const command_SHELL* table, uint8_t count, const char* name)
+{
+	uint8_t low = 0;
+	uint8_t high = count;
+	uint8_t mid;
+	int cmp;					// strcmp_P() can return any int
+	
+	while (low < high)
+	{
+		mid = (low + high) >> 1;
+		cmp = strcmp_P(name, table[mid].name);
+		if (cmp == 0)
+			return (handler_SHELL)pgm_read_ptr(&table[mid].handler);
+		if (cmp < 0)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return NULL;
+}
+
+/*************************************************************************
+Split the line in arguments and run the command.
+Input:    none
+Returns:  none
+*************************************************************************/
+static void Shell_Execute(void)
+{
+	char* argv[SHELL_MAX_ARGS];
+	uint8_t argc = 0;
+	char* p = Shell_Line;
+	handler_SHELL handler;
+	
+	/* Split in place: spaces are replaced by null chars */
+	while (*p != 0x00)
+	{
+		while (*p == ' ')
+			*p++ = 0x00;
+		if (*p == 0x00)
+			break;
+		if (argc == SHELL_MAX_ARGS)
+		{
+			/* Never run a command with its arguments cut */
+			USART_putString_P(PSTR("too many arguments\r\n"));
+			return;
+		}
+		argv[argc++] = p;
+		while (*p != ' ' && *p != 0x00)
+			p++;
+	}
+	if (argc == 0)
+		return;
+	
+	/* Application commands first */
+	handler = NULL;
+	if (Shell_UserTable)
+		handler = Shell_Find(Shell_UserTable, Shell_UserCount, argv[0]);
+	if (handler == NULL)
+		handler = Shell_Find(Shell_Builtin, SHELL_BUILTIN_COUNT, argv[0]);
+	
+	if (handler)
+	{
+		handler(argc, argv);
+	} else
+	{
+		USART_putString(argv[0]);
+		USART_putString_P(PSTR(": unknown command\r\n"));
+	}
+}
+
+/*************************************************************************
+Initialize the shell and send the prompt.
+Input:    table 	commands of the application, sorted
+		  count 	number of commands
+Returns:  none
+*************************************************************************/
+void Shell_Init(const command_SHELL* table, uint8_t count)
+{
+	Shell_UserTable = table;
+	Shell_UserCount = table ? count : 0;
+	Shell_Length = 0;
+	Shell_Overflow = 0;
+	Shell_LastChar = 0;
+	USART_putString_P(PSTR(SHELL_PROMPT));
+}
+
+/*************************************************************************
+Process the received bytes. Only the bytes already in the RX Buffer are
+read, so it never waits.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Shell_Task(void)
+{
+	uint8_t c;
+	
+	while (USART_Available())
+	{
+		c = USART_Receive();
+		
+		if (c == '\n' && Shell_LastChar == '\r')
+		{
+			/* Second half of a CR LF, the line was already run */
+		} else if (c == '\r' || c == '\n')
+		{
+			/* Enter: run the line */
+			USART_putString_P(PSTR("\r\n"));
+			Shell_Line[Shell_Length] = 0x00;
+			if (Shell_Overflow)
+				USART_putString_P(PSTR("line too long\r\n"));
+			else
+				Shell_Execute();
+			Shell_Length = 0;
+			Shell_Overflow = 0;
+			USART_putString_P(PSTR(SHELL_PROMPT));
+		} else if (c == 0x08 || c == 0x7F)
+		{
+			/* Backspace: erase the last char on the terminal too */
+			if (Shell_Length > 0)
+			{
+				Shell_Length--;
+				USART_putString_P(PSTR("\b \b"));
+			}
+		} else if (c >= ' ')
+		{
+			/* Printable char, echo. The line is rejected if it is full */
+			if (Shell_Length < SHELL_LINE_SIZE - 1)
+			{
+				Shell_Line[Shell_Length++] = c;
+				USART_Transmit(c);
+			} else
+			{
+				Shell_Overflow = 1;
+			}
+		}
+		Shell_LastChar = c;
+	}
+}
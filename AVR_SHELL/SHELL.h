@@ -0,0 +1,98 @@
+#ifndef SHELL_H_
+#define SHELL_H_
+
+/*************************************************************************
+ Title	:   C include file for the UART shell library (SHELL.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Small command line over the UART library.
+
+       Shell_Task() takes the received bytes from the RX Buffer without 
+       waiting, echoes them and edits the line (backspace). On enter the 
+       line is split in arguments and the command is searched with a 
+       binary search in tables stored in the flash. The RX ISR keeps 
+       receiving while a command runs. CR, LF and CR LF end a line. Lines 
+       longer than the buffer or with more than SHELL_MAX_ARGS arguments
+       are rejected, never run cut.
+
+       Built-in commands:
+           adc <channel>       read a channel of the ADC, unread values
+                               of the ADC buffer are discarded
+           help                list the commands
+           lcd <text>          write a text on the LCD
+           rgb <color>         set the RGB Led (red, green, ..., off)
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_MEMCONF/MEMCONF.h"
+
+
+/**
+*	Shell Definitions
+*	The line size is set in MEMCONF.h and SHELL_ENABLE in CONFIG.h. 
+*	Choose the built-in commands to be compiled, each one needs its 
+*	library to be initialized.
+*
+*/
+#ifndef SHELL_MAX_ARGS
+#define SHELL_MAX_ARGS		4			/* Command and 3 arguments */
+#endif
+#ifndef SHELL_CMD_ADC
+#define SHELL_CMD_ADC		1
+#endif
+#ifndef SHELL_CMD_RGB
+#define SHELL_CMD_RGB		1
+#endif
+#ifndef SHELL_CMD_LCD
+#define SHELL_CMD_LCD		1
+#endif
+
+#define SHELL_NAME_SIZE		8			// Longest command name is 7 chars
+#define SHELL_PROMPT		"> "
+
+
+/**
+*	Shell Commands
+*	A command receives the arguments like main(), argv[0] is the name of
+*	the command. The tables are stored in the flash (PROGMEM) and have to 
+*	be sorted by name for the binary search.
+*
+*/
+typedef void (*handler_SHELL)(uint8_t argc, char** argv);
+
+typedef struct
+{
+	char name[SHELL_NAME_SIZE];
+	handler_SHELL handler;
+} command_SHELL;
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Initialize the shell and send the prompt. The UART has to be 
+ 			initialized.
+ @param		table 	commands of the application in PROGMEM, sorted by name,
+ 					searched before the built-in ones. NULL if none.
+ 			count 	number of commands of the table
+ @return 	none
+*/
+void Shell_Init(const command_SHELL* table, uint8_t count);
+
+/**
+ @brief		Process the received bytes and run the command of a complete
+ 			line. Does not wait for new bytes, call it from the main loop.
+ @param		none
+ @return 	none
+*/
+void Shell_Task(void);
+
+
+#endif /* SHELL_H_ */
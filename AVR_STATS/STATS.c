@@ -0,0 +1,121 @@
+/*************************************************************************
+ Title	:   Stats library (STATS.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Instrumentation counters for the UART, ADC and I2C libraries.
+
+       Each library counts its lost or delayed events (overruns, full 
+       buffers, NACKs, timeouts) and the maximum duration of its ISRs,
+       measured with Timer1 running free at F_CPU. Stats_Dump() sends 
+       every value through the UART.
+
+ USAGE
+       See the C include STATS.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "STATS.h"
+#include "../AVR_UART/UART.h"
+
+#if STATS_ENABLE
+
+/* Global Variables */
+volatile uint16_t Stats_Counter[STATS_COUNTERS];
+volatile uint16_t Stats_IsrMax[STATS_ISRS];
+
+/* Names of the values sent by Stats_Dump(), kept in flash */
+static const char Stats_CounterName[STATS_COUNTERS][10] PROGMEM = 
+{
+	"RX_OVR=", "TX_FULL=", "ADC_DROP=", "I2C_NACK=", "I2C_TOUT=", "SW_OVR=", "SW_FRAME="
+};
+static const char Stats_IsrName[STATS_ISRS][10] PROGMEM = 
+{
+	"ISR_RX=", "ISR_UDRE=", "ISR_ADC=", "ISR_TWI=", "ISR_SWRX=", "ISR_SWTX="
+};
+
+#endif
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Start Timer1 free running, without prescaler, and clear the counters.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Stats_Init(void)
+{
+	#if STATS_ENABLE
+	/* Normal mode, clock = F_CPU */
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+	
+	Stats_Clear();
+	#endif
+}
+
+/*************************************************************************
+Clear all the counters and the ISR maximums.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Stats_Clear(void)
+{
+	#if STATS_ENABLE
+	uint8_t i;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (i = 0; i < STATS_COUNTERS; i++)
+			Stats_Counter[i] = 0;
+		for (i = 0; i < STATS_ISRS; i++)
+			Stats_IsrMax[i] = 0;
+	}
+	#endif
+}
+
+/*************************************************************************
+Send all the values through the UART as "NAME=value" pairs, one line.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Stats_Dump(void)
+{
+	#if STATS_ENABLE
+	uint8_t i;
+	uint16_t value;
+	
+	for (i = 0; i < STATS_COUNTERS; i++)
+	{
+		/* 16-bit values are also written by the ISRs */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			value = Stats_Counter[i];
+		}
+		USART_putString_P(Stats_CounterName[i]);
+		USART_putNumber(value);
+		USART_Transmit(' ');
+	}
+	
+	for (i = 0; i < STATS_ISRS; i++)
+	{
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			value = Stats_IsrMax[i];
+		}
+		USART_putString_P(Stats_IsrName[i]);
+		USART_putNumber(value);
+		USART_Transmit(' ');
+	}
+	
+	USART_putString_P(PSTR("\r\n"));
+	#endif
+}
@@ -0,0 +1,119 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+/*************************************************************************
+ Title	:   C include file for the Stats library (STATS.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Instrumentation counters for the UART, ADC and I2C libraries.
+
+       Each library counts its lost or delayed events (overruns, full 
+       buffers, NACKs, timeouts) and the maximum duration of its ISRs,
+       measured with Timer1 running free at F_CPU. Stats_Dump() sends 
+       every value through the UART.
+
+       Everything is removed at compile time when STATS_ENABLE is 0.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	Stats Enable
+*	STATS_ENABLE is set in CONFIG.h: 1 compiles the counters and the ISR
+*	probes.
+*
+*/
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	Stats Counters
+*	Events counted by the libraries. Each counter saturates at 0xFFFF.
+*
+*/
+typedef enum
+{
+	STATS_UART_RX_OVERRUN,		// RX byte lost, hardware or buffer full
+	STATS_UART_TX_FULL,			// USART_Transmit() waited for free space
+	STATS_ADC_DROP,				// Conversion lost, buffer full
+	STATS_I2C_NACK,				// Address or data not acknowledged
+	STATS_I2C_TIMEOUT,			// TWI operation did not finish
+	STATS_SWUART_RX_OVERRUN,	// Software UART byte lost, buffer full
+	STATS_SWUART_FRAME,			// Software UART stop bit low
+	STATS_COUNTERS
+} counters_STATS;
+
+
+/**
+*	Stats ISR Probes
+*	ISRs with a duration probe. The value is the maximum number of cycles
+*	between STATS_ISR_BEGIN() and STATS_ISR_END(), without the prologue 
+*	and epilogue added by the compiler.
+*
+*/
+typedef enum
+{
+	STATS_ISR_UART_RX,
+	STATS_ISR_UART_UDRE,
+	STATS_ISR_ADC,
+	STATS_ISR_TWI,
+	STATS_ISR_SWUART_RX,
+	STATS_ISR_SWUART_TX,
+	STATS_ISRS
+} isrs_STATS;
+
+
+/**
+*	Stats Macros
+*	Used by the libraries on the hot paths.
+*
+*/
+#if STATS_ENABLE
+extern volatile uint16_t Stats_Counter[STATS_COUNTERS];
+extern volatile uint16_t Stats_IsrMax[STATS_ISRS];
+
+#define STATS_INC(counter)		do { if (Stats_Counter[counter] != 0xFFFF) Stats_Counter[counter]++; } while (0)
+#define STATS_ISR_BEGIN()		uint16_t stats_start = TCNT1
+#define STATS_ISR_END(isr)		do { uint16_t stats_time = TCNT1 - stats_start; \
+									if (stats_time > Stats_IsrMax[isr]) Stats_IsrMax[isr] = stats_time; } while (0)
+#else
+#define STATS_INC(counter)
+#define STATS_ISR_BEGIN()
+#define STATS_ISR_END(isr)
+#endif
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Start Timer1 free running at F_CPU and clear the counters. 
+ @param		none
+ @return 	none
+*/
+void Stats_Init(void);
+
+/**
+ @brief		Clear all the counters and the ISR maximums. 
+ @param		none
+ @return 	none
+*/
+void Stats_Clear(void);
+
+/**
+ @brief		Send all the counters and ISR maximums through the UART.
+ 			The UART has to be initialized. 
+ @param		none
+ @return 	none
+*/
+void Stats_Dump(void);
+
+
+#endif /* STATS_H_ */
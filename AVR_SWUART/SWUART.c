@@ -0,0 +1,290 @@
+/*************************************************************************
+ Title	:   Software UART library (SWUART.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Interrupt driven UART on any two pins, with Timer2 and the pin 
+       change interrupt of the RX pin.
+
+       The time of the next bit of each direction is kept in 8.8 fixed 
+       point ticks of Timer2. The high byte is written to OCR2A/OCR2B, the
+       fraction is carried to the next bit, so the error of each bit stays
+       under one tick and does not accumulate.
+
+ USAGE
+       See the C include SWUART.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "SWUART.h"
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+#include "../AVR_STATS/STATS.h"
+
+#if !SWUART_ENABLE
+	#error "Set SWUART_ENABLE to 1 in CONFIG.h to build SWUART.c"
+#endif
+
+/* Bit counters of the frame: start, 8 data bits, stop */
+#define SWUART_BIT_START	0
+#define SWUART_BIT_STOP		9
+
+/* Static Variables */
+static uint8_t SWUART_RxBuf[SWUART_RX_BUFFER_SIZE] MEM_SECTION;
+static volatile uint8_t SWUART_RxHead;
+static volatile uint8_t SWUART_RxTail;
+static uint8_t SWUART_TxBuf[SWUART_TX_BUFFER_SIZE] MEM_SECTION;
+static volatile uint8_t SWUART_TxHead;
+static volatile uint8_t SWUART_TxTail;
+
+/* Frame state, only used by the ISRs */
+static uint16_t SWUART_RxTime;				// Next RX sample, 8.8 ticks
+static uint8_t SWUART_RxBit;
+static uint8_t SWUART_RxByte;
+static uint16_t SWUART_TxTime;				// Next TX edge, 8.8 ticks
+static uint8_t SWUART_TxBit;
+static uint8_t SWUART_TxByte;
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Start Timer2 and the pins.
+Input:    none
+Returns:  none
+*************************************************************************/
+void SWUART_Init(void)
+{
+	/* Timer2 in Normal mode, free running. The compare interrupts are 
+	   enabled only during a frame */
+	TCCR2A = 0;
+	TCCR2B = (SWUART_CS << CS20);
+	TIMSK2 &= ~((1 << OCIE2A) | (1 << OCIE2B));
+	
+	/* TX idle high, RX input with pull-up */
+	SWUART_TX_PORT |= (1 << SWUART_TX_BIT);
+	SWUART_TX_DDR |= (1 << SWUART_TX_BIT);
+	SWUART_RX_PORT |= (1 << SWUART_RX_BIT);
+	
+	/* Flush buffers */
+	SWUART_RxHead = 0;
+	SWUART_RxTail = 0;
+	SWUART_TxHead = 0;
+	SWUART_TxTail = 0;
+	
+	/* Wait for a start bit */
+	SWUART_PCMSK |= (1 << SWUART_RX_BIT);
+	PCIFR = (1 << SWUART_PCIF);
+	PCICR |= (1 << SWUART_PCIE);
+}
+
+
+/*************************************************************************
+Pin change of RX: start bit. Takes the time of the edge, schedules the 
+sample of the middle of the start bit and stops watching the pin until 
+the end of the frame.
+*************************************************************************/
+ISR(SWUART_PCINT_vect)
+{
+	uint8_t stamp = TCNT2;
+	
+	/* Only the falling edge starts a frame */
+	if (SWUART_RX_PIN & (1 << SWUART_RX_BIT))
+		return;
+	SWUART_PCMSK &= ~(1 << SWUART_RX_BIT);
+	
+	stamp -= SWUART_RX_LATENCY / SWUART_PRESC;
+	SWUART_RxTime = ((uint16_t)stamp << 8) + SWUART_PERIOD / 2;
+	SWUART_RxBit = SWUART_BIT_START;
+	OCR2A = SWUART_RxTime >> 8;
+	TIFR2 = (1 << OCF2A);
+	TIMSK2 |= (1 << OCIE2A);
+}
+
+/*************************************************************************
+Timer2 Compare Match A: middle of an RX bit. Checks the start bit, shifts 
+in the data bits (LSB first) and stores the byte on a valid stop bit. If 
+the buffer is full the new data is dropped.
+*************************************************************************/
+ISR(TIMER2_COMPA_vect)
+{
+	STATS_ISR_BEGIN();
+	uint8_t level = SWUART_RX_PIN & (1 << SWUART_RX_BIT);
+	uint8_t tmphead;
+	
+	/* Next sample */
+	SWUART_RxTime += SWUART_PERIOD;
+	OCR2A = SWUART_RxTime >> 8;
+	
+	if (SWUART_RxBit == SWUART_BIT_START)
+	{
+		/* A glitch, not a start bit */
+		if (level)
+			SWUART_RxBit = SWUART_BIT_STOP;
+	} else if (SWUART_RxBit < SWUART_BIT_STOP)
+	{
+		SWUART_RxByte >>= 1;
+		if (level)
+			SWUART_RxByte |= 0x80;
+	} else if (!level)
+	{
+		STATS_INC(STATS_SWUART_FRAME);
+	} else
+	{
+		tmphead = (SWUART_RxHead + 1) & SWUART_RX_BUFFER_MASK;
+		/* Drop the data if the buffer is full, unread data is kept */
+		if (tmphead == SWUART_RxTail)
+		{
+			STATS_INC(STATS_SWUART_RX_OVERRUN);
+		} else
+		{
+			SWUART_RxBuf[tmphead] = SWUART_RxByte;
+			SWUART_RxHead = tmphead;
+		}
+	}
+	
+	if (SWUART_RxBit >= SWUART_BIT_STOP)
+	{
+		/* Wait for the next start bit, the edges of this frame are ignored */
+		TIMSK2 &= ~(1 << OCIE2A);
+		PCIFR = (1 << SWUART_PCIF);
+		SWUART_PCMSK |= (1 << SWUART_RX_BIT);
+	}
+	SWUART_RxBit++;
+	STATS_ISR_END(STATS_ISR_SWUART_RX);
+}
+
+/*************************************************************************
+Timer2 Compare Match B: start of a TX bit. Loads the next byte of the 
+buffer at the start bit and disables itself when the buffer is empty.
+*************************************************************************/
+ISR(TIMER2_COMPB_vect)
+{
+	STATS_ISR_BEGIN();
+	uint8_t tmptail;
+	
+	if (SWUART_TxBit == SWUART_BIT_START)
+	{
+		if (SWUART_TxHead == SWUART_TxTail)
+		{
+			/* Nothing to send, the line stays high */
+			TIMSK2 &= ~(1 << OCIE2B);
+			STATS_ISR_END(STATS_ISR_SWUART_TX);
+			return;
+		}
+		tmptail = (SWUART_TxTail + 1) & SWUART_TX_BUFFER_MASK;
+		SWUART_TxTail = tmptail;
+		SWUART_TxByte = SWUART_TxBuf[tmptail];
+		SWUART_TX_PORT &= ~(1 << SWUART_TX_BIT);
+	} else if (SWUART_TxBit < SWUART_BIT_STOP)
+	{
+		if (SWUART_TxByte & 0x01)
+			SWUART_TX_PORT |= (1 << SWUART_TX_BIT);
+		else
+			SWUART_TX_PORT &= ~(1 << SWUART_TX_BIT);
+		SWUART_TxByte >>= 1;
+	} else
+	{
+		SWUART_TX_PORT |= (1 << SWUART_TX_BIT);
+	}
+	
+	/* After the stop bit the next frame starts */
+	if (++SWUART_TxBit > SWUART_BIT_STOP)
+		SWUART_TxBit = SWUART_BIT_START;
+	
+	/* Next edge */
+	SWUART_TxTime += SWUART_PERIOD;
+	OCR2B = SWUART_TxTime >> 8;
+	STATS_ISR_END(STATS_ISR_SWUART_TX);
+}
+
+
+/*************************************************************************
+Receive data from the buffer.
+Input:    none
+Returns:  data received
+*************************************************************************/
+uint8_t SWUART_Receive(void)
+{
+	uint8_t tmptail;
+	
+	/* Wait for incoming data */
+	#if SWUART_SLEEP_WAIT
+	SLEEP_WAIT_WHILE(SWUART_RxHead == SWUART_RxTail, SLEEP_MODE_IDLE);
+	#else
+	while (SWUART_RxHead == SWUART_RxTail);
+	#endif
+	/* Calculate buffer index */
+	tmptail = (SWUART_RxTail + 1) & SWUART_RX_BUFFER_MASK;
+	/* Store new index */
+	SWUART_RxTail = tmptail;
+	/* Return data */
+	return SWUART_RxBuf[tmptail];
+}
+
+/*************************************************************************
+Number of unread bytes in the buffer.
+Input:    none
+Returns:  bytes in the buffer
+*************************************************************************/
+uint8_t SWUART_Available(void)
+{
+	return (SWUART_RxHead - SWUART_RxTail) & SWUART_RX_BUFFER_MASK;
+}
+
+/*************************************************************************
+Send a byte. The first byte after an idle line starts the TX interrupt.
+Input:    data 	byte to be send
+Returns:  none
+*************************************************************************/
+void SWUART_Transmit(uint8_t data)
+{
+	uint8_t tmphead;
+	
+	/* Calculate buffer index */
+	tmphead = (SWUART_TxHead + 1) & SWUART_TX_BUFFER_MASK;
+	/* Wait for free space in buffer */
+	#if SWUART_SLEEP_WAIT
+	/* The start bit of each frame frees one byte and wakes the CPU */
+	SLEEP_WAIT_WHILE(tmphead == SWUART_TxTail, SLEEP_MODE_IDLE);
+	#else
+	while (tmphead == SWUART_TxTail);
+	#endif
+	/* Store data in buffer */
+	SWUART_TxBuf[tmphead] = data;
+	SWUART_TxHead = tmphead;
+	
+	/* Idle line: the start bit begins 4 ticks from now */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (!(TIMSK2 & (1 << OCIE2B)))
+		{
+			SWUART_TxBit = SWUART_BIT_START;
+			SWUART_TxTime = (uint16_t)(uint8_t)(TCNT2 + 4) << 8;
+			OCR2B = SWUART_TxTime >> 8;
+			TIFR2 = (1 << OCF2B);
+			TIMSK2 |= (1 << OCIE2B);
+		}
+	}
+}
+
+/*************************************************************************
+Send a string.
+Input:    StringPtr 	String to be send
+Returns:  none
+*************************************************************************/
+void SWUART_putString(char* StringPtr)
+{
+	while (*StringPtr != 0x00)
+	{
+		SWUART_Transmit(*StringPtr);
+		StringPtr++;
+	}
+}
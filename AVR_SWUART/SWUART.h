@@ -0,0 +1,169 @@
+#ifndef SWUART_H_
+#define SWUART_H_
+
+/*************************************************************************
+ Title	:   C include file for the Software UART library (SWUART.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Interrupt driven UART on any two pins, for a second serial port 
+       (e.g. a GPS module) next to the hardware USART of UART.c.
+
+       Timer2 runs free and both directions share it: Compare Match A 
+       samples the RX bits and Compare Match B shifts out the TX bits. 
+       The start bit is detected with the pin change interrupt of the RX 
+       pin. The bit period is kept in 8.8 fixed point, so the rounding of
+       the timer ticks does not add up along the frame.
+
+       Same ring buffers and API as UART.c. Frame format 8N1.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	Software UART Clock Definitions
+*	Used to obtain the bit period in Timer2 ticks for the desired baud 
+*	rate. The smallest prescaler with a period under 256 ticks is used.
+*	At 16 MHz and 38400 baud: prescaler 8, 52.08 ticks (416 cycles).
+*
+*/
+#ifndef SWUART_BAUD_RATE
+#define SWUART_BAUD_RATE	38400
+#endif
+
+#if (F_CPU / 8 / SWUART_BAUD_RATE) < 256
+	#define SWUART_PRESC		8
+	#define SWUART_CS			2			// CS22:0 of Timer2
+#elif (F_CPU / 32 / SWUART_BAUD_RATE) < 256
+	#define SWUART_PRESC		32
+	#define SWUART_CS			3
+#elif (F_CPU / 64 / SWUART_BAUD_RATE) < 256
+	#define SWUART_PRESC		64
+	#define SWUART_CS			4
+#elif (F_CPU / 128 / SWUART_BAUD_RATE) < 256
+	#define SWUART_PRESC		128
+	#define SWUART_CS			5
+#else
+	#error "SWUART_BAUD_RATE is too low for F_CPU"
+#endif
+
+/* Bit period in ticks, 8.8 fixed point */
+#define SWUART_PERIOD		((((F_CPU) / SWUART_PRESC) * 256UL + (SWUART_BAUD_RATE) / 2) / (SWUART_BAUD_RATE))
+
+/**
+*	Software UART Timing Limits
+*	Each bit is one interrupt. Its length in cycles depends on the 
+*	compiler and is not given here: read STATS_ISR_SWUART_RX/TX of the 
+*	Stats library on the target. The RX bits are sampled in 
+*	the middle, so the latency of the other ISRs has to stay under half a 
+*	bit. SWUART_RX_LATENCY is the delay in cycles from the start edge to 
+*	the read of TCNT2 in the pin change ISR, subtracted from the stamp.
+*
+*/
+#define SWUART_BIT_CYCLES	((F_CPU) / (SWUART_BAUD_RATE))
+
+#if SWUART_BIT_CYCLES < 200
+	#error "SWUART_BAUD_RATE is too high for F_CPU, a bit needs 200 cycles at least"
+#endif
+
+#ifndef SWUART_RX_LATENCY
+#define SWUART_RX_LATENCY	24
+#endif
+
+
+/**
+*	Software UART Pins
+*	Choose the RX and TX pins. The pin change registers and vector of the
+*	RX port have to match: port B is PCINT0, port C is PCINT1 and port D 
+*	is PCINT2. No other pin of the RX port can use its pin change ISR.
+*	Default: RX on PB0 and TX on PB1.
+*
+*/
+#ifndef SWUART_RX_BIT
+#define SWUART_RX_PIN		PINB
+#define SWUART_RX_PORT		PORTB
+#define SWUART_RX_BIT		0
+#define SWUART_PCMSK		PCMSK0
+#define SWUART_PCIE			PCIE0
+#define SWUART_PCIF			PCIF0
+#define SWUART_PCINT_vect	PCINT0_vect
+#endif
+
+#ifndef SWUART_TX_BIT
+#define SWUART_TX_PORT		PORTB
+#define SWUART_TX_DDR		DDRB
+#define SWUART_TX_BIT		1
+#endif
+
+
+/**
+*	Software UART Buffer Definitions
+*	Used to store the data. The sizes of the buffers are set in MEMCONF.h
+* 	and have to be a power of 2. They are counted in the RAM budget when
+*	SWUART_ENABLE is set in CONFIG.h, which this library needs.
+*
+*/
+#include "../AVR_MEMCONF/MEMCONF.h"
+#define SWUART_RX_BUFFER_MASK	(SWUART_RX_BUFFER_SIZE - 1)
+#define SWUART_TX_BUFFER_MASK	(SWUART_TX_BUFFER_SIZE - 1)
+
+
+/**
+*	Software UART Sleep Definitions
+*	Same as USART_SLEEP_WAIT. Timer2 keeps running in Idle mode.
+*
+*/
+#ifndef SWUART_SLEEP_WAIT
+#define SWUART_SLEEP_WAIT	1			/* 1: Idle sleep -- 0: busy wait */
+#endif
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Start Timer2 free running, configure the pins and enable the 
+ 			pin change interrupt of RX. Timer2 can not be used for other
+ 			things. 
+ @param		none
+ @return 	none
+*/
+void SWUART_Init(void);
+
+/**
+ @brief		Receive data from the buffer. Waits if it is empty.
+ @param		none
+ @return 	data received
+*/
+uint8_t SWUART_Receive(void);
+
+/**
+ @brief		Number of unread bytes in the buffer. Does not wait. 
+ @param		none
+ @return 	bytes that SWUART_Receive() can return without waiting
+*/
+uint8_t SWUART_Available(void);
+
+/**
+ @brief		Send a byte. Waits if the buffer is full.
+ @param		data 	byte to be send
+ @return 	none
+*/
+void SWUART_Transmit(uint8_t data);
+
+/**
+ @brief		Send a string. 
+ @param		StringPtr 	String to be send
+ @return 	none
+*/
+void SWUART_putString(char* StringPtr);
+
+
+#endif /* SWUART_H_ */
@@ -0,0 +1,137 @@
+/*************************************************************************
+ Title	:   HD44780 model of the tests (LCDDEC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Display model fed with the TWI log of the model.
+
+ USAGE
+       See the C include LCDDEC.h file for a description of each function
+
+*****************************************************************************/
+
+#include <string.h>
+#include "MOCK.h"
+#include "LCDDEC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+/* Global Variables */
+char LcdDec_Ddram[LCDDEC_DDRAM_SIZE];
+uint8_t LcdDec_Address;
+uint8_t LcdDec_Commands;
+uint8_t LcdDec_Command;
+
+/* Static Variables */
+static uint8_t LcdDec_Pins = 0xFF;			// PCF8574, not reset between tests
+static uint8_t LcdDec_Mode8 = 1;			// HD44780 starts in 8 bits mode
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Let the TWI finish the last Stop.
+Input:    none
+Returns:  none
+*************************************************************************/
+void LcdDec_Idle(void)
+{
+	Mock_Run(Mock_TwiPeriod + 1);
+}
+
+/*************************************************************************
+Store a char or run a command.
+Input:    byte 	data
+		  rs 	1 for a char
+Returns:  none
+*************************************************************************/
+static void LcdDec_Byte(uint8_t byte, uint8_t rs)
+{
+	if (rs)
+	{
+		LcdDec_Ddram[LcdDec_Address++ & 0x7F] = (char)byte;
+		return;
+	}
+	LcdDec_Commands++;
+	LcdDec_Command = byte;
+	if (byte == LCD_CLR)
+	{
+		memset(LcdDec_Ddram, ' ', sizeof(LcdDec_Ddram));
+		LcdDec_Address = 0;
+	} else if (byte & LCD_DDRAM)
+	{
+		LcdDec_Address = byte & 0x7F;
+	} else if ((byte & 0xE0) == 0x20)
+	{
+		/* Function set, DL selects the interface */
+		LcdDec_Mode8 = (byte & 0x10) ? 1 : 0;
+	}
+}
+
+/*************************************************************************
+Decode the bus log: the bytes written to the expander are its pins. In 
+8 bits mode each nibble is a whole byte (D3-D0 are not wired), in 4 bits
+mode two nibbles make a command (RS low) or a char (RS high). The first
+write after power up latches a nibble too: the expander starts with E 
+high, the 8 bits mode of LCD_Init() absorbs it.
+Input:    address 	7 bits address of the expander
+Returns:  none
+*************************************************************************/
+void LcdDec_Decode(uint8_t address)
+{
+	uint16_t i;
+	uint8_t selected = 0;
+	uint8_t first = 0;
+	uint8_t half = 0;
+	uint8_t byte = 0;
+
+	LcdDec_Idle();
+	memset(LcdDec_Ddram, ' ', sizeof(LcdDec_Ddram));
+	LcdDec_Address = 0;
+	LcdDec_Commands = 0;
+	for (i = 0; i < Mock_TwiLogLen; i++)
+	{
+		uint16_t event = Mock_TwiLog[i];
+
+		if (event == MOCK_TWI_START)
+		{
+			first = 1;
+			continue;
+		}
+		if (event == MOCK_TWI_STOP)
+		{
+			selected = 0;
+			continue;
+		}
+		if (first)
+		{
+			selected = (event == I2C_ADD_WR(address));
+			first = 0;
+			continue;
+		}
+		if (!selected)
+			continue;
+		/* Falling edge of E latches the nibble */
+		if ((LcdDec_Pins & (1 << E)) && !(event & (1 << E)))
+		{
+			if (LcdDec_Mode8)
+			{
+				half = 0;
+				LcdDec_Byte(LcdDec_Pins & 0xF0, LcdDec_Pins & (1 << RS));
+			} else
+			{
+				byte = (uint8_t)((byte << 4) | (LcdDec_Pins >> 4));
+				if (++half == 2)
+				{
+					half = 0;
+					LcdDec_Byte(byte, LcdDec_Pins & (1 << RS));
+				}
+			}
+		}
+		LcdDec_Pins = (uint8_t)event;
+	}
+}
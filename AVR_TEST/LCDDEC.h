@@ -0,0 +1,58 @@
+#ifndef LCDDEC_H_
+#define LCDDEC_H_
+
+/*************************************************************************
+ Title	:   C include file for the HD44780 model of the tests (LCDDEC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Decodes the TWI log of the model (Mock_TwiLog): the bytes written
+       to LCD_Add are the pins of the PCF8574, the nibbles latched on the
+       falling edge of E make commands (RS low) or chars (RS high) of an
+       HD44780. Only the clear, the DDRAM address and the function set
+       (8 or 4 bits interface) commands change the model.
+
+       The pins of the expander and the interface mode are kept between
+       decodes, like the shadow of LCDI2C.c and the display itself.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	Display Model
+*	DDRAM of the display after LcdDec_Decode(), spaces when cleared.
+*	Row 1 starts at 0x00 and row 2 at 0x40.
+*
+*/
+#define LCDDEC_DDRAM_SIZE	0x80
+
+extern char LcdDec_Ddram[LCDDEC_DDRAM_SIZE];
+extern uint8_t LcdDec_Address;				// Address counter
+extern uint8_t LcdDec_Commands;				// Commands decoded
+extern uint8_t LcdDec_Command;				// Last command
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Let the TWI finish the last Stop, I2C_Stop() does not wait.
+ @param		none
+ @return 	none
+*/
+void LcdDec_Idle(void);
+
+/**
+ @brief		Clear the display model and decode the whole bus log.
+ @param		address 	7 bits address of the expander
+ @return 	none
+*/
+void LcdDec_Decode(uint8_t address);
+
+
+#endif /* LCDDEC_H_ */
@@ -0,0 +1,45 @@
+# Static RAM of each module: the .data, .bss and .noinit sections of its
+# object, from size -A. Every static is counted, not only the buffers of
+# MEM_TOTAL_BYTES. The objects are built for the host: the pointers take
+# 8 bytes instead of 2, the other types have the sizes of the AVR.
+# Fails if the total exceeds MEM_RAM_BUDGET.
+#
+# cmake -DSIZE=<size> -DOBJECTS=<file|file|...> -DBUDGET=<bytes> -P MEMREPORT.cmake
+
+string(REPLACE "|" ";" objects "${OBJECTS}")
+list(SORT objects)
+
+message("Static RAM of the modules (bytes)")
+message("  module              data    bss     noinit  total")
+set(total 0)
+foreach(object ${objects})
+	execute_process(COMMAND ${SIZE} -A ${object}
+		OUTPUT_VARIABLE out RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${SIZE} failed on ${object}")
+	endif()
+	string(REPLACE "\n" ";" lines "${out}")
+	set(data 0)
+	set(bss 0)
+	set(noinit 0)
+	foreach(line ${lines})
+		if(line MATCHES "^\\.(data|bss|noinit)[^ \t]*[ \t]+([0-9]+)")
+			math(EXPR ${CMAKE_MATCH_1} "${${CMAKE_MATCH_1}} + ${CMAKE_MATCH_2}")
+		endif()
+	endforeach()
+	math(EXPR module "${data} + ${bss} + ${noinit}")
+	math(EXPR total "${total} + ${module}")
+	# UART.c.o or UART.c.obj
+	get_filename_component(name ${object} NAME)
+	string(REGEX REPLACE "\\..*$" "" name "${name}")
+	string(SUBSTRING "${name}                    " 0 20 column)
+	string(SUBSTRING "${data}        " 0 8 data)
+	string(SUBSTRING "${bss}        " 0 8 bss)
+	string(SUBSTRING "${noinit}        " 0 8 noinit)
+	message("  ${column}${data}${bss}${noinit}${module}")
+endforeach()
+message("  total ${total}, MEM_RAM_BUDGET ${BUDGET}")
+
+if(total GREATER BUDGET)
+	message(FATAL_ERROR "The statics of the modules exceed MEM_RAM_BUDGET")
+endif()
@@ -0,0 +1,93 @@
+# Benchmark of the libraries on the AVR core. Each library is built for
+# the ATmega328P and measured with avr-size (flash = text + data, RAM =
+# data + bss, .noinit included). Then SIM_BENCH.c is run in simavr and
+# its "BENCH" lines are listed: cycles per ISR, bytes/s, conversions/s.
+#
+# cmake -DAVR_GCC=<avr-gcc> -DAVR_SIZE=<avr-size> -DSIMAVR=<simavr>
+#       -DROOT=<repository> -DBIN=<work dir> -P SIM.cmake
+
+set(MCU atmega328p)
+set(CLOCK 16000000)
+set(FLAGS -mmcu=${MCU} -DF_CPU=${CLOCK}UL -Os -std=gnu99 -Wall -Wextra
+	-ffunction-sections -fdata-sections)
+
+file(MAKE_DIRECTORY ${BIN})
+
+# Run a tool, stop on error. The output is left in SIM_OUT.
+function(sim_run)
+	execute_process(COMMAND ${ARGN} RESULT_VARIABLE result
+		OUTPUT_VARIABLE out ERROR_VARIABLE out)
+	if(NOT result EQUAL 0)
+		string(REPLACE ";" " " command "${ARGN}")
+		message(FATAL_ERROR "${command}\n${out}")
+	endif()
+	set(SIM_OUT "${out}" PARENT_SCOPE)
+endfunction()
+
+# sim_feature(<name> SOURCES <files> [DEFINES <options>])
+# Objects of one library with its options, and their sizes.
+function(sim_feature name)
+	cmake_parse_arguments(F "" "" "SOURCES;DEFINES" ${ARGN})
+	set(defines)
+	foreach(define ${F_DEFINES})
+		list(APPEND defines -D${define})
+	endforeach()
+	set(objects)
+	foreach(file ${F_SOURCES})
+		get_filename_component(base ${file} NAME_WE)
+		set(object ${BIN}/${name}_${base}.o)
+		sim_run(${AVR_GCC} ${FLAGS} ${defines} -c ${ROOT}/${file} -o ${object})
+		list(APPEND objects ${object})
+	endforeach()
+	sim_run(${AVR_SIZE} --totals ${objects})
+	if(NOT SIM_OUT MATCHES "([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-f]+[ \t]+\\(TOTALS\\)")
+		message(FATAL_ERROR "Unexpected output of ${AVR_SIZE}:\n${SIM_OUT}")
+	endif()
+	math(EXPR flash "${CMAKE_MATCH_1} + ${CMAKE_MATCH_2}")
+	math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+	string(SUBSTRING "${name}                    " 0 20 column)
+	string(SUBSTRING "${flash}        " 0 8 flash)
+	message("  ${column}${flash}${ram}")
+endfunction()
+
+message("Footprint on the ${MCU}, -Os (bytes)")
+message("  feature             flash   RAM")
+sim_feature(uart			SOURCES AVR_UART/UART.c)
+sim_feature(uart_block_rx	SOURCES AVR_UART/UART.c DEFINES USART_BLOCK_RX=1)
+sim_feature(adc				SOURCES AVR_ADC/ADC.c)
+sim_feature(adc_watchdog	SOURCES AVR_ADC/ADC.c DEFINES ADC_WATCHDOG=1 ADC_WD_PRETRIGGER=16)
+sim_feature(adccal			SOURCES AVR_ADC/ADCCAL.c)
+sim_feature(adcstream		SOURCES AVR_ADC/ADCSTREAM.c DEFINES ADC_STREAM=1)
+sim_feature(i2c				SOURCES AVR_I2C/I2C.c)
+sim_feature(lcdi2c			SOURCES AVR_LCDI2C/LCDI2C.c)
+sim_feature(rgbled			SOURCES AVR_RGBLED/RGBLED.c)
+sim_feature(swuart			SOURCES AVR_SWUART/SWUART.c DEFINES SWUART_ENABLE=1)
+sim_feature(stats			SOURCES AVR_STATS/STATS.c DEFINES STATS_ENABLE=1)
+sim_feature(trace			SOURCES AVR_TRACE/TRACE.c DEFINES TRACE_ENABLE=1)
+sim_feature(shell			SOURCES AVR_SHELL/SHELL.c DEFINES SHELL_ENABLE=1)
+sim_feature(eeconfig		SOURCES AVR_EECONFIG/EECONFIG.c DEFINES EECONFIG_ENABLE=1)
+sim_feature(dashboard		SOURCES AVR_DASHBOARD/DASHBOARD.c DEFINES ADC_SCAN=1)
+
+# The benchmark program
+set(ELF ${BIN}/sim_bench.elf)
+sim_run(${AVR_GCC} ${FLAGS} -DSTATS_ENABLE=1 -DSWUART_ENABLE=1 -Wl,--gc-sections -o ${ELF}
+	${ROOT}/AVR_TEST/SIM_BENCH.c ${ROOT}/AVR_UART/UART.c ${ROOT}/AVR_ADC/ADC.c
+	${ROOT}/AVR_RGBLED/RGBLED.c ${ROOT}/AVR_STATS/STATS.c ${ROOT}/AVR_SWUART/SWUART.c)
+
+# simavr prints the lines of the UART, it stops at the final sleep
+execute_process(COMMAND ${SIMAVR} -m ${MCU} -f ${CLOCK} ${ELF}
+	OUTPUT_VARIABLE out ERROR_VARIABLE out TIMEOUT 120)
+string(REGEX MATCHALL "BENCH [a-z0-9_]+ [0-9]+ [a-z/]+" results "${out}")
+if(NOT out MATCHES "BENCH end" OR NOT results)
+	message(FATAL_ERROR "SIM_BENCH.c did not finish in ${SIMAVR}:\n${out}")
+endif()
+
+message("Cycles in ${SIMAVR} at ${CLOCK} Hz")
+foreach(line ${results})
+	string(REGEX REPLACE "^BENCH ([a-z0-9_]+) ([0-9]+) ([a-z/]+)$" "\\1;\\2;\\3" fields "${line}")
+	list(GET fields 0 name)
+	list(GET fields 1 value)
+	list(GET fields 2 unit)
+	string(SUBSTRING "${name}                    " 0 20 column)
+	message("  ${column}${value} ${unit}")
+endforeach()
@@ -0,0 +1,269 @@
+/*************************************************************************
+ Title	:   Cycle benchmark of the libraries under simavr
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  AVR-GCC 4.x, simavr
+ Hardware:  ATmega328P at 16 MHz (simulated)
+
+ DESCRIPTION
+       Firmware run by SIM.cmake in simavr, the cycle accurate simulator
+       of the AVR core. Timer1 counts every cycle, its overflows extend it
+       to 32 bits. Each result is one "BENCH <name> <value> <unit>" line
+       sent through the UART, which simavr prints.
+
+       UART TX     bytes/s of USART_Transmit() at several baud rates,
+                   and the cycles of the UDRE ISR (STATS probe)
+       ADC         conversions/s of ADC_GetValue() in Free Running mode,
+                   and the cycles of the ADC ISR (STATS probe)
+       SWUART TX   bytes/s of SWUART_Transmit() at SWUART_BAUD_RATE, and
+                   the cycles of the Timer2 COMPB ISR (STATS probe)
+       RGB         cycles of one RGBLed_Color() call (no ISR)
+       Latency     cycles from a Timer1 compare match to the first read of
+                   TCNT1 in its ISR, running and asleep in Idle mode. The
+                   difference is the wake-up cost of SLEEP_WAIT_WHILE().
+
+       The STATS probes count the body of the ISR, without the prologue
+       and epilogue. The latency gives the entry up to the first read.
+       The RX side and the LCD need a device on the other end, which the
+       simulator does not have: bench_bus counts the LCD bus instead.
+
+       The program ends with the interrupts disabled and sleep_cpu(),
+       which stops simavr.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <stdlib.h>
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_RGBLED/RGBLED.h"
+#include "../AVR_SWUART/SWUART.h"
+#include "../AVR_STATS/STATS.h"
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+
+#if !STATS_ENABLE
+	#error "SIM_BENCH.c needs STATS_ENABLE"
+#endif
+
+#define SIM_TX_BYTES		64
+#define SIM_ADC_VALUES		64
+#define SIM_SWUART_BYTES	16
+#define SIM_REPORT_BAUD		250000UL
+
+static const uint32_t Sim_Bauds[] PROGMEM = { 9600, 57600, 115200, 250000, 500000, 1000000 };
+#define SIM_BAUDS			(sizeof(Sim_Bauds) / sizeof(Sim_Bauds[0]))
+
+/* Results, sent at the end at SIM_REPORT_BAUD */
+static uint32_t Sim_TxRate[SIM_BAUDS];
+static uint16_t Sim_TxIsr;
+static uint32_t Sim_AdcRate;
+static uint16_t Sim_AdcIsr;
+static uint32_t Sim_SwuartRate;
+static uint16_t Sim_SwuartIsr;
+static uint16_t Sim_RgbCycles;
+static uint16_t Sim_LatencyRun;
+static uint16_t Sim_LatencySleep;
+
+static volatile uint16_t Sim_Overflows;
+static volatile uint16_t Sim_Entry;
+static volatile uint8_t Sim_Fired;
+
+
+/*************************************************************************
+Timer1 extended to 32 bits.
+*************************************************************************/
+ISR(TIMER1_OVF_vect)
+{
+	Sim_Overflows++;
+}
+
+static uint32_t Sim_Cycles(void)
+{
+	uint16_t low;
+	uint16_t high;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		low = TCNT1;
+		high = Sim_Overflows;
+		/* Overflow not served yet */
+		if ((TIFR1 & (1 << TOV1)) && low < 0x8000)
+			high++;
+	}
+	return ((uint32_t)high << 16) | low;
+}
+
+/*************************************************************************
+Timer1 Compare Match A: stamp of the entry.
+*************************************************************************/
+ISR(TIMER1_COMPA_vect)
+{
+	Sim_Entry = TCNT1;
+	TIMSK1 &= ~(1 << OCIE1A);
+	Sim_Fired = 1;
+}
+
+static uint16_t Sim_Latency(uint8_t sleep)
+{
+	Sim_Fired = 0;
+	cli();
+	OCR1A = TCNT1 + 2000;
+	TIFR1 = (1 << OCF1A);
+	TIMSK1 |= (1 << OCIE1A);
+	sei();
+	if (sleep)
+		SLEEP_WAIT_WHILE(!Sim_Fired, SLEEP_MODE_IDLE);
+	else
+		while (!Sim_Fired);
+	return Sim_Entry - OCR1A;
+}
+
+/*************************************************************************
+Send SIM_TX_BYTES at a baud rate, until the last stop bit.
+Returns:  bytes/s
+*************************************************************************/
+static uint32_t Sim_Transmit(uint32_t baud)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint8_t i;
+
+	USART_Init((F_CPU + 4UL * baud) / (8UL * baud) - 1);
+	/* TXC0 is cleared by writing one */
+	UCSR0A = (1 << U2X0) | (1 << TXC0);
+	start = Sim_Cycles();
+	for (i = 0; i < SIM_TX_BYTES - 1; i++)
+		USART_Transmit('.');
+	USART_Transmit('\n');
+	while ((UCSR0B & (1 << UDRIE0)) || !(UCSR0A & (1 << TXC0)));
+	cycles = Sim_Cycles() - start;
+	return (SIM_TX_BYTES * F_CPU) / cycles;
+}
+
+/*************************************************************************
+Read SIM_ADC_VALUES conversions in Free Running mode.
+Returns:  conversions/s
+*************************************************************************/
+static uint32_t Sim_Adc(void)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint8_t i;
+
+	ADC_Init();
+	ADC_StartAuto();
+	/* The first conversion takes 25 ADC clocks, the others 13 */
+	ADC_GetValue();
+	start = Sim_Cycles();
+	for (i = 0; i < SIM_ADC_VALUES; i++)
+		ADC_GetValue();
+	cycles = Sim_Cycles() - start;
+	ADC_Stop();
+	return (SIM_ADC_VALUES * F_CPU) / cycles;
+}
+
+/*************************************************************************
+Send SIM_SWUART_BYTES with the software UART, until the last stop bit.
+Returns:  bytes/s
+*************************************************************************/
+static uint32_t Sim_Swuart(void)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint8_t i;
+
+	SWUART_Init();
+	start = Sim_Cycles();
+	for (i = 0; i < SIM_SWUART_BYTES; i++)
+		SWUART_Transmit('.');
+	while (TIMSK2 & (1 << OCIE2B));
+	cycles = Sim_Cycles() - start;
+	return (SIM_SWUART_BYTES * F_CPU) / cycles;
+}
+
+static void Sim_Number(uint32_t value)
+{
+	char number[11];
+
+	ultoa(value, number, 10);
+	USART_putString(number);
+}
+
+static void Sim_Print(const char* name, uint32_t value, const char* unit)
+{
+	USART_putString_P(PSTR("BENCH "));
+	USART_putString_P(name);
+	USART_Transmit(' ');
+	Sim_Number(value);
+	USART_Transmit(' ');
+	USART_putString_P(unit);
+	USART_Transmit('\n');
+}
+
+int main(void)
+{
+	uint32_t start;
+	uint16_t overhead;
+	uint8_t i;
+
+	Stats_Init();
+	TIMSK1 = (1 << TOIE1);
+	RGBLed_Init();
+	sei();
+
+	for (i = 0; i < SIM_BAUDS; i++)
+	{
+		Stats_Clear();
+		Sim_TxRate[i] = Sim_Transmit(pgm_read_dword(&Sim_Bauds[i]));
+	}
+	Sim_TxIsr = Stats_IsrMax[STATS_ISR_UART_UDRE];
+
+	Stats_Clear();
+	Sim_AdcRate = Sim_Adc();
+	Sim_AdcIsr = Stats_IsrMax[STATS_ISR_ADC];
+
+	Stats_Clear();
+	Sim_SwuartRate = Sim_Swuart();
+	Sim_SwuartIsr = Stats_IsrMax[STATS_ISR_SWUART_TX];
+
+	/* Cycles of Sim_Cycles() itself */
+	start = Sim_Cycles();
+	overhead = Sim_Cycles() - start;
+	start = Sim_Cycles();
+	RGBLed_Color(CYAN);
+	Sim_RgbCycles = Sim_Cycles() - start - overhead;
+
+	Sim_LatencyRun = Sim_Latency(0);
+	Sim_LatencySleep = Sim_Latency(1);
+
+	/* Report */
+	USART_Init((F_CPU + 4UL * SIM_REPORT_BAUD) / (8UL * SIM_REPORT_BAUD) - 1);
+	USART_Transmit('\n');
+	for (i = 0; i < SIM_BAUDS; i++)
+	{
+		USART_putString_P(PSTR("BENCH uart_tx_"));
+		Sim_Number(pgm_read_dword(&Sim_Bauds[i]));
+		USART_Transmit(' ');
+		Sim_Number(Sim_TxRate[i]);
+		USART_putString_P(PSTR(" bytes/s\n"));
+	}
+	Sim_Print(PSTR("isr_uart_udre"), Sim_TxIsr, PSTR("cycles"));
+	Sim_Print(PSTR("adc_scan"), Sim_AdcRate, PSTR("conversions/s"));
+	Sim_Print(PSTR("isr_adc"), Sim_AdcIsr, PSTR("cycles"));
+	Sim_Print(PSTR("swuart_tx"), Sim_SwuartRate, PSTR("bytes/s"));
+	Sim_Print(PSTR("isr_swuart_tx"), Sim_SwuartIsr, PSTR("cycles"));
+	Sim_Print(PSTR("rgb_color"), Sim_RgbCycles, PSTR("cycles"));
+	Sim_Print(PSTR("isr_latency_running"), Sim_LatencyRun, PSTR("cycles"));
+	Sim_Print(PSTR("isr_latency_idle"), Sim_LatencySleep, PSTR("cycles"));
+	Sim_Print(PSTR("wake_up"), Sim_LatencySleep - Sim_LatencyRun, PSTR("cycles"));
+	USART_putString_P(PSTR("BENCH end\n"));
+
+	/* Last stop bit, then stop the simulator */
+	while (UCSR0B & (1 << UDRIE0));
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	return 0;
+}
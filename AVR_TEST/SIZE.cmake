@@ -0,0 +1,67 @@
+# Code and data of the drivers in the executables of bench_size_c and 
+# bench_size_cpp, from the symbols listed by nm, for each program of 
+# SIZE_C.c: the Size_ function and the symbols of its driver, vectors and
+# constants included. The model, the tests and the C library are left out.
+# Fails if the C++ code of a program is larger than the C code.
+#
+# cmake -DNM=<nm> -DC_EXE=<file> -DCPP_EXE=<file> -P SIZE.cmake
+
+# Symbols of each program, C and C++ (mangled) names
+set(SIZE_PROGRAMS uart rgb lcd)
+set(SIZE_uart "^(USART_|_ZN3avr4Uart|_ZN3avr3Adc)|Size_Uart")
+set(SIZE_rgb "^(RGBLed_|_ZN3avr6RgbLed)|Size_Rgb")
+set(SIZE_lcd "^(LCD_|I2C_|TWI_vect|_ZN3avr3Lcd)|Size_Lcd")
+
+# Sets <prefix>_<program>_code and <prefix>_<program>_data
+function(size_count exe prefix)
+	execute_process(COMMAND ${NM} -S --defined-only ${exe}
+		OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${NM} failed on ${exe}")
+	endif()
+	string(REPLACE "\n" ";" symbols "${symbols}")
+	foreach(program ${SIZE_PROGRAMS})
+		set(code 0)
+		set(data 0)
+		foreach(line ${symbols})
+			if(line MATCHES "^[0-9a-f]+ ([0-9a-f]+) ([tTWdDbBrRVu]) (.+)$")
+				set(type ${CMAKE_MATCH_2})
+				set(name ${CMAKE_MATCH_3})
+				math(EXPR bytes "0x${CMAKE_MATCH_1}")
+				if(name MATCHES "${SIZE_${program}}")
+					# The template functions are weak (W), their statics unique (u)
+					if(type MATCHES "[tTW]")
+						math(EXPR code "${code} + ${bytes}")
+					else()
+						math(EXPR data "${data} + ${bytes}")
+					endif()
+				endif()
+			endif()
+		endforeach()
+		if(code EQUAL 0)
+			message(FATAL_ERROR "No symbols of ${program} were found in ${exe}")
+		endif()
+		set(${prefix}_${program}_code ${code} PARENT_SCOPE)
+		set(${prefix}_${program}_data ${data} PARENT_SCOPE)
+	endforeach()
+endfunction()
+
+size_count(${C_EXE} c)
+size_count(${CPP_EXE} cpp)
+
+message("           C code  data  C++ code  data  (host -Os, relative only)")
+set(larger)
+foreach(program ${SIZE_PROGRAMS})
+	string(SUBSTRING "${program}          " 0 11 column)
+	string(SUBSTRING "${c_${program}_code}        " 0 8 c_code)
+	string(SUBSTRING "${c_${program}_data}        " 0 6 c_data)
+	string(SUBSTRING "${cpp_${program}_code}        " 0 10 cpp_code)
+	message("  ${column}${c_code}${c_data}${cpp_code}${cpp_${program}_data}")
+	if(cpp_${program}_code GREATER c_${program}_code)
+		list(APPEND larger ${program})
+	endif()
+endforeach()
+
+if(larger)
+	message(FATAL_ERROR "The C++ code is larger than the C code: ${larger}")
+endif()
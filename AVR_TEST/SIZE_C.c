@@ -0,0 +1,136 @@
+/*************************************************************************
+ Title	:   Size benchmark of the C drivers (AVR_UART, AVR_RGBLED, AVR_LCDI2C)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The programs of SIZE_CPP.cpp written with the C libraries, one per
+       driver, with the same features on both sides:
+
+       Size_Uart   UART.c against Uart<>: sends the values of the channels
+                   0 and 1, high byte first, and echoes the received bytes
+                   up to a '\r'. Adc<> only polls, so the ADC is read here
+                   with the same polled code (Size_Adc*) instead of the 
+                   ISR and the buffer of ADC.c.
+       Size_Rgb    RGBLED.c against RgbLed<>: init and one color.
+       Size_Lcd    LCDI2C.c against Lcd<>: init, a text, a number on the
+                   second row and the backlight off.
+
+       Both versions are checked on the model to give the same output,
+       SIZE.cmake compares the code and data of each program.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "LCDDEC.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_RGBLED/RGBLED.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+#define SIZE_CHANNELS		2
+
+
+/* Polled ADC, as Adc<TenBit, 0, 1> */
+static void Size_AdcInit(void)
+{
+	ADMUX = (1 << REFS0);
+	ADCSRA = (1 << ADEN) | (ADC_PRESC << ADPS0);
+}
+
+static uint16_t Size_AdcRead(uint8_t channel)
+{
+	ADMUX = (1 << REFS0) | (channel << MUX0);
+	ADCSRA |= (1 << ADSC);
+	while (ADCSRA & (1 << ADSC));
+	return ADC;
+}
+
+void Size_Uart(void)
+{
+	uint8_t i;
+	uint8_t data;
+	uint16_t value;
+
+	USART_Init(MYUBRR);
+	Size_AdcInit();
+	sei();
+	for (i = 0; i < SIZE_CHANNELS; i++)
+	{
+		value = Size_AdcRead(i);
+		USART_Transmit(value >> 8);
+		USART_Transmit(value & 0xFF);
+	}
+	do
+	{
+		data = USART_Receive();
+		USART_Transmit(data);
+	} while (data != '\r');
+}
+
+void Size_Rgb(uint8_t color)
+{
+	RGBLed_Init();
+	RGBLed_Color(color);
+}
+
+void Size_Lcd(uint16_t number)
+{
+	static char text[] = "Value:";
+
+	LCD_Init();
+	LCD_String(text);
+	LCD_GotoXY(2, 0);
+	LCD_Number(number);
+	LCD_Backlight(0);
+}
+
+static void Test_Uart(void)
+{
+	static const uint8_t rx[] = "size\r";
+	static const uint8_t tx[] = { 0x01, 0x23, 0x03, 0xFE, 's', 'i', 'z', 'e', '\r' };
+
+	Mock_AdcValue[0] = 0x123;
+	Mock_AdcValue[1] = 0x3FE;
+	Mock_UartInject(rx, sizeof(rx) - 1);
+	Size_Uart();
+	Mock_Run(2000);
+	TEST_EQUAL(Mock_UartTxLen, sizeof(tx));
+	TEST_MEMORY(Mock_UartTx, tx, sizeof(tx));
+}
+
+static void Test_Rgb(void)
+{
+	/* Pins 3, 4 and 5 of port D, on for each color */
+	static const uint8_t on[] = { 0x08, 0x10, 0x20, 0x18, 0x30, 0x28 };
+	uint8_t color;
+
+	for (color = RED; color <= MAGENTA; color++)
+	{
+		Size_Rgb(color);
+		TEST_EQUAL(DDRD & RGB_MASK, RGB_MASK);
+		TEST_EQUAL(PORTD & RGB_MASK, (TYPE_RGB == COMMON_CATHODE) ? on[color] : RGB_MASK & ~on[color]);
+	}
+}
+
+static void Test_Lcd(void)
+{
+	I2C_Init();
+	sei();
+	Size_Lcd(1234);
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "Value: ", 7);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "1234 ", 5);
+	/* Same bus as Lcd<>, the backlight off at the end */
+	TEST_EQUAL(Mock_TwiLogLen, SIZE_LCD_BUS);
+	TEST_EQUAL(Mock_TwiLog[Mock_TwiLogLen - 2] & (1 << BL), 0);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Uart);
+	TEST_RUN(Test_Rgb);
+	TEST_RUN(Test_Lcd);
+	return TEST_END();
+}
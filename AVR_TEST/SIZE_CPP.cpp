@@ -0,0 +1,120 @@
+/*************************************************************************
+ Title	:   Size benchmark of the C++ templates (AVR_CPP)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The programs of SIZE_C.c written with Uart<>, Adc<>, RgbLed<> and
+       Lcd<>, with the buffer sizes, baud rate, pins and address of the 
+       C build.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+extern "C"
+{
+#include "LCDDEC.h"
+}
+#include "../AVR_CONFIG/CONFIG.h"
+#include "../AVR_MEMCONF/MEMCONF.h"
+#include "../AVR_CPP/UART.hpp"
+#include "../AVR_CPP/ADC.hpp"
+#include "../AVR_CPP/RGBLED.hpp"
+#include "../AVR_CPP/LCDI2C.hpp"
+
+typedef avr::Uart<USART_RX_BUFFER_SIZE, UART_BAUD_RATE> Serial;
+typedef avr::Adc<avr::TenBit, 0, 1> Sensors;
+typedef avr::RgbLed<avr::RgbPins<avr::PortD, 3, 4, 5>,
+					(TYPE_RGB == COMMON_CATHODE) ? avr::CommonCathode : avr::CommonAnode> Led;
+typedef avr::Lcd<LCD_Add, 16, 2> Display;
+
+AVRCPP_UART_ISR(Serial)
+
+
+void Size_Uart(void)
+{
+	uint8_t i;
+	uint8_t data;
+	Sensors::Value values[Sensors::Count];
+
+	Serial::init();
+	Sensors::init();
+	sei();
+	Sensors::scan(values);
+	for (i = 0; i < Sensors::Count; i++)
+	{
+		Serial::transmit(values[i] >> 8);
+		Serial::transmit(values[i] & 0xFF);
+	}
+	do
+	{
+		data = Serial::receive();
+		Serial::transmit(data);
+	} while (data != '\r');
+}
+
+void Size_Rgb(uint8_t color)
+{
+	Led::init();
+	Led::color((avr::Color)color);
+}
+
+void Size_Lcd(uint16_t number)
+{
+	Display::init();
+	Display::print("Value:");
+	Display::gotoXY(2, 0);
+	Display::print(number);
+	Display::backlight(false);
+}
+
+static void Test_Uart(void)
+{
+	static const uint8_t rx[] = "size\r";
+	static const uint8_t tx[] = { 0x01, 0x23, 0x03, 0xFE, 's', 'i', 'z', 'e', '\r' };
+
+	Mock_AdcValue[0] = 0x123;
+	Mock_AdcValue[1] = 0x3FE;
+	Mock_UartInject(rx, sizeof(rx) - 1);
+	Size_Uart();
+	Mock_Run(2000);
+	TEST_EQUAL(Mock_UartTxLen, sizeof(tx));
+	TEST_MEMORY(Mock_UartTx, tx, sizeof(tx));
+}
+
+static void Test_Rgb(void)
+{
+	/* Pins 3, 4 and 5 of port D, on for each color */
+	static const uint8_t on[] = { 0x08, 0x10, 0x20, 0x18, 0x30, 0x28 };
+	const uint8_t all = 0x38;
+	uint8_t color;
+
+	for (color = avr::Red; color <= avr::Magenta; color++)
+	{
+		Size_Rgb(color);
+		TEST_EQUAL(DDRD & all, all);
+		TEST_EQUAL(PORTD & all, (TYPE_RGB == COMMON_CATHODE) ? on[color] : all & ~on[color]);
+	}
+}
+
+static void Test_Lcd(void)
+{
+	I2C_Init();
+	sei();
+	Size_Lcd(1234);
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "Value: ", 7);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "1234 ", 5);
+	/* Same bus as LCDI2C.c, the backlight off at the end */
+	TEST_EQUAL(Mock_TwiLogLen, SIZE_LCD_BUS);
+	TEST_EQUAL(Mock_TwiLog[Mock_TwiLogLen - 2] & (1 << 3), 0);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Uart);
+	TEST_RUN(Test_Rgb);
+	TEST_RUN(Test_Lcd);
+	return TEST_END();
+}
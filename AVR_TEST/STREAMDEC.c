@@ -0,0 +1,137 @@
+/*************************************************************************
+ Title	:   ADCSTREAM decoder (STREAMDEC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Receiver side of the blocks sent by AVR_ADC/ADCSTREAM.c.
+
+ USAGE
+       See the C include STREAMDEC.h file for a description of each function
+
+*****************************************************************************/
+
+#include <string.h>
+#include <util/crc16.h>
+#include "STREAMDEC.h"
+#include "../AVR_ADC/ADCSTREAM.h"
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Start a decoder.
+Input:    dec 		decoder
+		  samples 	output buffer
+		  size 		number of samples of the buffer
+Returns:  none
+*************************************************************************/
+void StreamDec_Init(decoder_STREAMDEC* dec, uint16_t* samples, uint32_t size)
+{
+	memset(dec, 0, sizeof(*dec));
+	dec->seq = -1;
+	dec->samples = samples;
+	dec->size = size;
+}
+
+/*************************************************************************
+Check the CRC of a complete block and unpack its samples. The high bits
+of sample n of a group are at bits 2n+1:2n of the fifth byte.
+Input:    dec 		decoder, block[] has len bytes
+Returns:  1 if the block was good
+*************************************************************************/
+static uint8_t StreamDec_Block(decoder_STREAMDEC* dec)
+{
+	uint8_t groups = dec->block[3];
+	uint8_t crc = 0;
+	uint16_t i;
+	uint8_t n;
+	const uint8_t* group;
+	
+	for (i = 2; i < dec->len - 1; i++)
+		crc = _crc_ibutton_update(crc, dec->block[i]);
+	if (crc != dec->block[dec->len - 1])
+		return 0;
+	
+	/* Missing sequence numbers, modulo 256 */
+	if (dec->seq >= 0)
+		dec->lost += (uint8_t)(dec->block[2] - dec->seq - 1);
+	dec->seq = dec->block[2];
+	dec->blocks++;
+	
+	for (group = &dec->block[ADCSTREAM_HEADER]; groups; groups--, group += 5)
+	{
+		for (n = 0; n < 4; n++)
+		{
+			if (dec->count < dec->size)
+				dec->samples[dec->count++] = group[n] | (((group[4] >> (2 * n)) & 0x03) << 8);
+		}
+	}
+	return 1;
+}
+
+/*************************************************************************
+Drop the first byte of block[] and decode the others again, to find a 
+sync inside a block that was not good.
+Input:    dec 		decoder
+Returns:  Good blocks found in the bytes
+*************************************************************************/
+static uint32_t StreamDec_Resync(decoder_STREAMDEC* dec)
+{
+	uint8_t again[STREAMDEC_MAX_BLOCK];
+	uint16_t n = dec->len - 1;
+	
+	memcpy(again, &dec->block[1], n);
+	dec->len = 0;
+	return StreamDec_Feed(dec, again, n);
+}
+
+/*************************************************************************
+Decode received bytes.
+Input:    dec 		decoder
+		  data 		bytes
+		  len 		number of bytes
+Returns:  Good blocks found
+*************************************************************************/
+uint32_t StreamDec_Feed(decoder_STREAMDEC* dec, const uint8_t* data, uint32_t len)
+{
+	uint32_t good = 0;
+	
+	while (len--)
+	{
+		dec->block[dec->len++] = *data++;
+		
+		/* Sync bytes */
+		if ((dec->len == 1 && dec->block[0] != ADCSTREAM_SYNC1) ||
+			(dec->len == 2 && dec->block[1] != ADCSTREAM_SYNC2))
+		{
+			good += StreamDec_Resync(dec);
+			continue;
+		}
+		if (dec->len < ADCSTREAM_HEADER)
+			continue;
+		
+		if (dec->block[3] == 0 || dec->block[3] > STREAMDEC_MAX_GROUPS)
+		{
+			dec->bad++;
+			good += StreamDec_Resync(dec);
+			continue;
+		}
+		if (dec->len < ADCSTREAM_HEADER + dec->block[3] * 5 + 1)
+			continue;
+		
+		if (StreamDec_Block(dec))
+		{
+			good++;
+			dec->len = 0;
+		} else
+		{
+			dec->bad++;
+			good += StreamDec_Resync(dec);
+		}
+	}
+	return good;
+}
@@ -0,0 +1,77 @@
+#ifndef STREAMDEC_H_
+#define STREAMDEC_H_
+
+/*************************************************************************
+ Title	:   C include file for the ADCSTREAM decoder (STREAMDEC.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Receiver side of the blocks sent by AVR_ADC/ADCSTREAM.c, to be 
+       used on the PC. Bytes are fed as they arrive from the serial 
+       port, in pieces of any size. The decoder finds the sync bytes, 
+       checks the CRC-8, unpacks the 4 samples of every 5-byte group 
+       and counts the blocks lost from the gaps of the sequence.
+
+       A block with a wrong CRC or number of groups is dropped and the 
+       search of the sync bytes restarts after its first byte.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	Decoder Definitions
+*	Bigger blocks can not be sent by USART_TransmitBlock().
+*
+*/
+#define STREAMDEC_MAX_GROUPS	50
+#define STREAMDEC_MAX_BLOCK		(4 + STREAMDEC_MAX_GROUPS * 5 + 1)
+
+
+/**
+*	Decoder State
+*	Counters can be read at any time.
+*
+*/
+typedef struct
+{
+	uint8_t block[STREAMDEC_MAX_BLOCK];	// Bytes of the current block
+	uint16_t len;						// Bytes in block[]
+	int16_t seq;						// Last good sequence, -1 none yet
+	uint16_t* samples;					// Decoded samples
+	uint32_t count;						// Samples in samples[]
+	uint32_t size;						// Size of samples[]
+	uint32_t blocks;					// Good blocks
+	uint32_t lost;						// Blocks missing in the sequence
+	uint32_t bad;						// Blocks with wrong CRC or groups
+} decoder_STREAMDEC;
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Start a decoder. The samples of every good block are appended 
+ 			to samples[], the ones that do not fit are discarded.
+ @param		dec 		decoder
+ 			samples 	output buffer
+ 			size 		number of samples of the buffer
+ @return 	none
+*/
+void StreamDec_Init(decoder_STREAMDEC* dec, uint16_t* samples, uint32_t size);
+
+/**
+ @brief		Decode received bytes.
+ @param		dec 		decoder
+ 			data 		bytes, in the order of the serial port
+ 			len 		number of bytes
+ @return 	Good blocks found in these bytes
+*/
+uint32_t StreamDec_Feed(decoder_STREAMDEC* dec, const uint8_t* data, uint32_t len);
+
+
+#endif /* STREAMDEC_H_ */
@@ -0,0 +1,75 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+/*************************************************************************
+ Title	:   C include file for the host tests of the libraries
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Checks of the tests in AVR_TEST. Each test is a function run by
+       TEST_RUN() after a reset of the model (mock/MOCK.h). A failed check
+       prints its line and the test goes on. main() returns TEST_END().
+
+ USAGE
+       int main(void)
+       {
+           TEST_RUN(Test_Transmit);
+           return TEST_END();
+       }
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "MOCK.h"
+
+static unsigned Test_Checks;
+static unsigned Test_Failures;
+
+#define TEST_ASSERT(cond) \
+	do { \
+		Test_Checks++; \
+		if (!(cond)) \
+		{ \
+			Test_Failures++; \
+			printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define TEST_EQUAL(value, expected) \
+	do { \
+		long test_v = (long)(value); \
+		long test_e = (long)(expected); \
+		Test_Checks++; \
+		if (test_v != test_e) \
+		{ \
+			Test_Failures++; \
+			printf("%s:%d: failed: %s is %ld, expected %ld\n", \
+				   __FILE__, __LINE__, #value, test_v, test_e); \
+		} \
+	} while (0)
+
+#define TEST_MEMORY(value, expected, len) \
+	do { \
+		Test_Checks++; \
+		if (memcmp((value), (expected), (len)) != 0) \
+		{ \
+			Test_Failures++; \
+			printf("%s:%d: failed: %s differs from %s\n", \
+				   __FILE__, __LINE__, #value, #expected); \
+		} \
+	} while (0)
+
+#define TEST_RUN(test) \
+	do { \
+		Mock_Reset(); \
+		printf("%s\n", #test); \
+		test(); \
+	} while (0)
+
+#define TEST_END() \
+	(printf("%u checks, %u failed\n", Test_Checks, Test_Failures), Test_Failures != 0)
+
+#endif /* TEST_H_ */
@@ -0,0 +1,273 @@
+/*************************************************************************
+ Title	:   Host test of the ADC library (AVR_ADC)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs ADC.c on the model of the ADC: registers of ADC_Init(), single
+       conversions, channel changes, Free Running mode and the buffer when
+       it is full. Built for ADC_MODE TENBIT and EIGHTBIT, with the
+       watchdog and its pre-trigger capture, and with the channel scan.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "../AVR_ADC/ADC.h"
+
+#if ADC_MODE == EIGHTBIT
+#define TEST_VALUE(raw)		((raw) >> 2)
+#else
+#define TEST_VALUE(raw)		(raw)
+#endif
+
+/* Each conversion reads the next value of the ramp */
+static uint16_t Test_Ramp;
+
+static uint16_t Test_RampSource(uint8_t channel)
+{
+	(void)channel;
+	return (Test_Ramp++ * 4) & 0x3FF;
+}
+
+
+static void Test_Init(void)
+{
+	ADC_Init();
+#if ADC_MODE == EIGHTBIT
+	TEST_EQUAL(ADMUX, (1 << REFS0) | (1 << ADLAR) | ADC_CHANNEL);
+#else
+	TEST_EQUAL(ADMUX, (1 << REFS0) | ADC_CHANNEL);
+#endif
+	TEST_EQUAL(ADCSRA, (1 << ADEN) | (1 << ADIE) | (ADC_PRESC << ADPS0));
+	TEST_EQUAL(ADC_Available(), 0);
+}
+
+static void Test_Single(void)
+{
+	Mock_AdcValue[ADC_CHANNEL] = 0x2A5;
+	ADC_Init();
+	sei();
+	ADC_Start();
+	/* Sleeps until the ISR stores the value */
+	TEST_EQUAL(ADC_GetValue(), TEST_VALUE(0x2A5));
+	TEST_EQUAL(Mock_AdcConversions, 1);
+	TEST_EQUAL(ADCSRA & (1 << ADSC), 0);
+	TEST_ASSERT(Mock_Sleeps > 0);
+	/* Single mode: no more conversions */
+	Mock_Run(200);
+	TEST_EQUAL(Mock_AdcConversions, 1);
+	TEST_EQUAL(ADC_Available(), 0);
+}
+
+static void Test_SetChannel(void)
+{
+	Mock_AdcValue[3] = 100;
+	Mock_AdcValue[ADC_CHANNEL] = 900;
+	ADC_Init();
+	sei();
+	ADC_SetChannel(3);
+	TEST_EQUAL(ADMUX & 0x0F, 3);
+	TEST_EQUAL(ADMUX & (1 << REFS0), (1 << REFS0));
+	ADC_Start();
+	TEST_EQUAL(ADC_GetValue(), TEST_VALUE(100));
+	ADC_SetChannel(ADC_CHANNEL);
+	ADC_Start();
+	TEST_EQUAL(ADC_GetValue(), TEST_VALUE(900));
+}
+
+static void Test_FreeRunning(void)
+{
+	uint16_t i;
+	uint32_t conversions;
+
+	Test_Ramp = 0;
+	Mock_AdcSource = Test_RampSource;
+	ADC_Init();
+	sei();
+	ADC_StartAuto();
+	/* Read faster than the conversions: nothing is lost */
+	for (i = 0; i < 100; i++)
+		TEST_EQUAL(ADC_GetValue(), TEST_VALUE((i * 4) & 0x3FF));
+	ADC_Stop();
+	/* The current conversion is finished, then the ADC stops */
+	Mock_Run(200);
+	conversions = Mock_AdcConversions;
+	Mock_Run(200);
+	TEST_EQUAL(Mock_AdcConversions, conversions);
+	TEST_ASSERT(ADC_Available() <= 1);
+}
+
+static void Test_BufferFull(void)
+{
+	uint8_t i;
+
+	Test_Ramp = 0;
+	Mock_AdcSource = Test_RampSource;
+	ADC_Init();
+	sei();
+	ADC_StartAuto();
+	Mock_Run(Mock_AdcPeriod * (ADC_BUFFER_SIZE * 3));
+	ADC_Stop();
+	Mock_Run(Mock_AdcPeriod * 2);
+	/* The ring keeps size - 1 values, the newest ones are dropped */
+	TEST_EQUAL(ADC_Available(), ADC_BUFFER_SIZE - 1);
+	TEST_ASSERT(Mock_AdcConversions > ADC_BUFFER_SIZE);
+	for (i = 0; i < ADC_BUFFER_SIZE - 1; i++)
+		TEST_EQUAL(ADC_GetValue(), TEST_VALUE(i * 4));
+	TEST_EQUAL(ADC_Available(), 0);
+}
+
+#if ADC_WATCHDOG && ADC_WD_PRETRIGGER
+static void Test_Capture(void)
+{
+	/* Crossing long after the buffer is full: 41st conversion */
+	const uint16_t high = 160;
+	value_ADC capture[ADC_WD_PRETRIGGER];
+	uint8_t i;
+
+	Test_Ramp = 0;
+	Mock_AdcSource = Test_RampSource;
+	ADC_Init();
+	/* Release what the previous tests raised with the thresholds at 0 */
+	for (i = 0; i < ADC_WD_CHANNELS; i++)
+		ADC_SetThreshold(i, 0, TEST_VALUE(0x3FF), 0);
+	ADC_GetCapture(capture);
+	ADC_SetThreshold(ADC_CHANNEL, 0, TEST_VALUE(high), 0);
+	sei();
+	ADC_StartAuto();
+	Mock_Run(Mock_AdcPeriod * 48);
+	ADC_Stop();
+	Mock_Run(Mock_AdcPeriod * 2);
+	TEST_ASSERT(Mock_AdcConversions > ADC_BUFFER_SIZE * 4);
+	TEST_EQUAL(ADC_Available(), ADC_BUFFER_SIZE - 1);
+
+	TEST_EQUAL(ADC_EventChannels(), 1 << ADC_CHANNEL);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), ADC_EVT_HIGH);
+	/* The window ends with the crossing value, not with the stale buffer */
+	TEST_EQUAL(ADC_GetCapture(capture), ADC_CHANNEL);
+	for (i = 0; i < ADC_WD_PRETRIGGER; i++)
+		TEST_EQUAL(capture[i], TEST_VALUE(high + 4 * (i + 1 - ADC_WD_PRETRIGGER + 1)));
+	TEST_EQUAL(ADC_GetCapture(capture), 0xFF);
+
+	/* A crossing before the history is filled again has no capture */
+	ADC_SetThreshold(ADC_CHANNEL, 0, TEST_VALUE(high), 0);
+	ADC_Start();
+	Mock_Run(Mock_AdcPeriod + 1);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), ADC_EVT_HIGH);
+	TEST_EQUAL(ADC_GetCapture(capture), 0xFF);
+}
+#endif
+
+#if ADC_WATCHDOG
+static void Test_Convert(uint16_t raw)
+{
+	Mock_AdcValue[ADC_CHANNEL] = raw;
+	ADC_Start();
+	ADC_GetValue();
+}
+
+static void Test_Hysteresis(void)
+{
+	ADC_Init();
+	sei();
+	/* Leave the high zone under 400 - 50 */
+	ADC_SetThreshold(ADC_CHANNEL, 0, TEST_VALUE(400), TEST_VALUE(50));
+	Test_Convert(600);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), ADC_EVT_HIGH);
+	Test_Convert(390);
+	Test_Convert(600);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), 0);
+	Test_Convert(300);
+	Test_Convert(600);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), ADC_EVT_HIGH);
+
+	/* Hysteresis over the threshold: high - hyst would wrap with a 
+	   16 bits int and re-arm on every value. Saturated, it never leaves */
+	ADC_SetThreshold(ADC_CHANNEL, 0, TEST_VALUE(400), TEST_VALUE(800));
+	Test_Convert(600);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), ADC_EVT_HIGH);
+	Test_Convert(0);
+	Test_Convert(600);
+	TEST_EQUAL(ADC_GetEvents(ADC_CHANNEL), 0);
+}
+#endif
+
+#if ADC_SCAN
+/* Channels of the conversions, in order */
+static uint8_t Test_Order[16];
+static uint8_t Test_OrderLen;
+
+static uint16_t Test_OrderSource(uint8_t channel)
+{
+	if (Test_OrderLen < sizeof(Test_Order))
+		Test_Order[Test_OrderLen++] = channel;
+	return 100 * channel;
+}
+
+static void Test_Scan(void)
+{
+	static const uint8_t order[] = { 1, 2, 5, 1, 2, 5, 1, 2, 5 };
+	uint32_t conversions;
+	#if ADC_WATCHDOG
+	uint8_t i;
+	#endif
+
+	Mock_AdcSource = Test_OrderSource;
+	Test_OrderLen = 0;
+	ADC_Init();
+	sei();
+	ADC_StartScan((1 << 1) | (1 << 2) | (1 << 5));
+	Mock_Run(9 * Mock_AdcPeriod + 50);
+
+	/* The ISR restarts the conversions, the channels go round */
+	TEST_ASSERT(Test_OrderLen >= 9);
+	TEST_MEMORY(Test_Order, order, sizeof(order));
+	TEST_EQUAL(ADC_ScanChannels(), (1 << 1) | (1 << 2) | (1 << 5));
+	TEST_EQUAL(ADC_GetScan(5), TEST_VALUE(500));
+	TEST_EQUAL(ADC_ScanChannels(), (1 << 1) | (1 << 2));
+	TEST_EQUAL(ADC_GetScan(1), TEST_VALUE(100));
+	TEST_EQUAL(ADC_GetScan(2), TEST_VALUE(200));
+	TEST_EQUAL(ADC_GetScan(8), 0);
+	/* Nothing in the buffer */
+	TEST_EQUAL(ADC_Available(), 0);
+
+	/* The watchdog sees the channel of each value */
+	#if ADC_WATCHDOG
+	/* Events of the other tests, the thresholds are not reset */
+	for (i = 0; i < ADC_WD_CHANNELS; i++)
+		ADC_GetEvents(i);
+	ADC_SetThreshold(1, 0, TEST_VALUE(150), 0);
+	ADC_SetThreshold(2, 0, TEST_VALUE(150), 0);
+	ADC_SetThreshold(5, 0, TEST_VALUE(600), 0);
+	Mock_Run(3 * Mock_AdcPeriod + 50);
+	TEST_EQUAL(ADC_EventChannels(), (1 << 2));
+	#endif
+
+	/* Stopped after the current conversion */
+	ADC_Stop();
+	Mock_Run(2 * Mock_AdcPeriod);
+	conversions = Mock_AdcConversions;
+	Mock_Run(4 * Mock_AdcPeriod);
+	TEST_EQUAL(Mock_AdcConversions, conversions);
+}
+#endif
+
+int main(void)
+{
+	TEST_RUN(Test_Init);
+	TEST_RUN(Test_Single);
+	TEST_RUN(Test_SetChannel);
+	TEST_RUN(Test_FreeRunning);
+	TEST_RUN(Test_BufferFull);
+#if ADC_WATCHDOG && ADC_WD_PRETRIGGER
+	TEST_RUN(Test_Capture);
+#endif
+#if ADC_WATCHDOG
+	TEST_RUN(Test_Hysteresis);
+#endif
+#if ADC_SCAN
+	TEST_RUN(Test_Scan);
+#endif
+	return TEST_END();
+}
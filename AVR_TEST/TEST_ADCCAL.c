@@ -0,0 +1,143 @@
+/*************************************************************************
+ Title	:   Host test of the ADC calibration library (AVR_ADC/ADCCAL)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs ADCCAL.c on the model of the ADC. The multiplier and the 
+       (counts * ADCCAL_Mult) >> 16 conversion are checked with known
+       pairs, computed by hand from the formulas of ADCCAL.h. Built with
+       ADC_STREAM, to check that the bandgap is not read while the 
+       stream takes the conversions.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_ADC/ADCCAL.h"
+#include "../AVR_ADC/ADCSTREAM.h"
+#include "../AVR_UART/UART.h"
+
+
+/* 1.1V against AVCC = 5V: 1100 * 1024 / 5000 = 225.28 */
+#define TEST_BANDGAP_RAW	225
+
+
+static void Test_Defaults(void)
+{
+	Mock_EepromErase();
+	ADC_Init();
+	ADCCAL_Init();
+	/* VCC 5000 mV, gain 1.0: Mult = 5000 * 16384 * 4 / 1024 = 320000 */
+	TEST_EQUAL(ADCCAL_ToMillivolts(0), 0);
+	TEST_EQUAL(ADCCAL_ToMillivolts(1), 4);			// 320000 >> 16
+	TEST_EQUAL(ADCCAL_ToMillivolts(512), 2500);
+	TEST_EQUAL(ADCCAL_ToMillivolts(1023), 4995);	// 327360000 >> 16
+}
+
+static void Test_Correction(void)
+{
+	Mock_EepromErase();
+	ADC_Init();
+	ADCCAL_Init();
+	/* Gain 1.05 = 17203 in Q2.14: Mult = 5000 * 17203 * 4 / 1024 = 335996 */
+	ADCCAL_SetCorrection(3, 17203);
+	TEST_EQUAL(ADCCAL_ToMillivolts(3), 0);
+	TEST_EQUAL(ADCCAL_ToMillivolts(2), 0);
+	TEST_EQUAL(ADCCAL_ToMillivolts(515), 2624);		// 512 * 335996 >> 16
+	TEST_EQUAL(ADCCAL_ToMillivolts(1023), 5229);	// 1020 * 335996 >> 16
+	/* Stored: a new Init loads the same correction */
+	ADCCAL_Init();
+	TEST_EQUAL(ADCCAL_ToMillivolts(515), 2624);
+	ADCCAL_SetCorrection(0, ADCCAL_GAIN_ONE);
+}
+
+static void Test_MeasureVcc(void)
+{
+	Mock_EepromErase();
+	Mock_AdcValue[ADC_CH_BANDGAP] = TEST_BANDGAP_RAW;
+	Mock_AdcValue[ADC_CHANNEL] = 0x3FF;
+	ADC_Init();
+	ADCCAL_Init();
+	sei();
+	/* 1100 * 1024 * 8 / (225 * 8) = 5006 */
+	TEST_EQUAL(ADCCAL_MeasureVcc(), 5006);
+	TEST_EQUAL(ADMUX & 0x0F, ADC_CHANNEL);
+	TEST_EQUAL(ADC_Available(), 0);
+	/* Mult = 5006 * 16384 * 4 / 1024 = 320384 */
+	TEST_EQUAL(ADCCAL_ToMillivolts(512), 2503);
+	/* The channel is back */
+	ADC_Start();
+	TEST_EQUAL(ADC_GetValue(), 0x3FF);
+}
+
+static void Test_CalibrateBandgap(void)
+{
+	Mock_EepromErase();
+	Mock_AdcValue[ADC_CH_BANDGAP] = TEST_BANDGAP_RAW;
+	ADC_Init();
+	ADCCAL_Init();
+	sei();
+	/* 5000 * 1800 / 8192 = 1098 */
+	TEST_EQUAL(ADCCAL_CalibrateBandgap(5000), 1098);
+	TEST_EQUAL(ADCCAL_ToMillivolts(512), 2500);
+	/* Measured again with the stored reference: 1098 * 1024 / 225 = 4997 */
+	ADCCAL_Init();
+	TEST_EQUAL(ADCCAL_MeasureVcc(), 4997);
+}
+
+static void Test_NotReady(void)
+{
+	uint32_t conversions;
+	uint16_t vcc, mv;
+
+	/* A VCC of its own: 1100 * 1024 * 8 / (225 * 8) = 5006 */
+	Mock_EepromErase();
+	Mock_AdcValue[ADC_CH_BANDGAP] = TEST_BANDGAP_RAW;
+	ADC_Init();
+	ADCCAL_Init();
+	sei();
+	TEST_EQUAL(ADCCAL_MeasureVcc(), 5006);
+
+	/* ADC not initialized: ADEN is 0 after reset */
+	Mock_Reset();
+	Mock_AdcValue[ADC_CH_BANDGAP] = 100;
+	sei();
+	mv = ADCCAL_ToMillivolts(512);
+	TEST_EQUAL(ADC_Ready(), 0);
+	/* The last VCC is kept */
+	vcc = ADCCAL_MeasureVcc();
+	TEST_EQUAL(vcc, 5006);
+	TEST_EQUAL(ADCCAL_ToMillivolts(512), mv);
+	TEST_EQUAL(ADCCAL_CalibrateBandgap(5000), 0);
+	TEST_EQUAL(Mock_AdcConversions, 0);
+
+	/* Stream running: the ISR never fills the buffer */
+	USART_Init(MYUBRR);
+	ADC_Init();
+	TEST_EQUAL(ADC_Ready(), 1);
+	ADCSTREAM_Start();
+	ADC_StartAuto();
+	TEST_EQUAL(ADC_Ready(), 0);
+	TEST_EQUAL(ADCCAL_MeasureVcc(), vcc);
+	TEST_EQUAL(ADCCAL_CalibrateBandgap(5000), 0);
+	TEST_EQUAL(ADMUX & 0x0F, ADC_CHANNEL);
+	conversions = Mock_AdcConversions;
+	Mock_Run(Mock_AdcPeriod * 4);
+	TEST_ASSERT(Mock_AdcConversions > conversions);
+	ADC_Stop();
+	ADCSTREAM_Stop();
+	Mock_Run(Mock_AdcPeriod * 2);
+	TEST_EQUAL(ADC_Ready(), 1);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Defaults);
+	TEST_RUN(Test_Correction);
+	TEST_RUN(Test_MeasureVcc);
+	TEST_RUN(Test_CalibrateBandgap);
+	TEST_RUN(Test_NotReady);
+	return TEST_END();
+}
@@ -0,0 +1,133 @@
+/*************************************************************************
+ Title	:   Host test of the ADC streaming library (AVR_ADC/ADCSTREAM)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Round trip of the stream: conversions of the ADC model are packed
+       by the ISR, sent by the USART model and decoded from Mock_UartTx 
+       with STREAMDEC.c, then compared with the values of the source. 
+       Also checks the sequence gaps of the dropped blocks and the 
+       recovery after a corrupted block.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "TEST.h"
+#include "STREAMDEC.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_ADC/ADCSTREAM.h"
+#include "../AVR_UART/UART.h"
+
+#define TEST_SAMPLES		(ADCSTREAM_GROUPS * 4)	// Samples of a block
+#define TEST_BLOCKS			6
+
+/* Every conversion reads the next value, all 10 bits change */
+static uint16_t Test_Index;
+
+static uint16_t Test_Value(uint16_t index)
+{
+	return (index * 37 + 5) & 0x3FF;
+}
+
+static uint16_t Test_Source(uint8_t channel)
+{
+	(void)channel;
+	return Test_Value(Test_Index++);
+}
+
+/* Stream TEST_BLOCKS blocks and wait until the UART sent them */
+static void Test_Stream(void)
+{
+	Test_Index = 0;
+	Mock_AdcSource = Test_Source;
+	USART_Init(MYUBRR);
+	ADC_Init();
+	sei();
+	ADCSTREAM_Start();
+	ADC_StartAuto();
+	while (Test_Index < TEST_BLOCKS * TEST_SAMPLES)
+		Mock_Run(1);
+	ADC_Stop();
+	ADCSTREAM_Stop();
+	Mock_Run(Mock_UartTxPeriod * ADCSTREAM_BLOCK * 3);
+}
+
+
+static void Test_RoundTrip(void)
+{
+	static uint16_t samples[TEST_BLOCKS * TEST_SAMPLES];
+	decoder_STREAMDEC dec;
+	uint32_t i;
+
+	Test_Stream();
+	TEST_EQUAL(ADCSTREAM_Dropped(), 0);
+	TEST_EQUAL(Mock_UartTxLen, TEST_BLOCKS * ADCSTREAM_BLOCK);
+
+	/* Fed in pieces that do not match the blocks */
+	StreamDec_Init(&dec, samples, TEST_BLOCKS * TEST_SAMPLES);
+	for (i = 0; i < Mock_UartTxLen; i += 7)
+		StreamDec_Feed(&dec, &Mock_UartTx[i], (Mock_UartTxLen - i < 7) ? Mock_UartTxLen - i : 7);
+	TEST_EQUAL(dec.blocks, TEST_BLOCKS);
+	TEST_EQUAL(dec.lost, 0);
+	TEST_EQUAL(dec.bad, 0);
+	TEST_EQUAL(dec.seq, TEST_BLOCKS - 1);
+	TEST_EQUAL(dec.count, TEST_BLOCKS * TEST_SAMPLES);
+	for (i = 0; i < dec.count; i++)
+		TEST_EQUAL(samples[i], Test_Value(i));
+}
+
+static void Test_Corrupt(void)
+{
+	static uint16_t samples[TEST_BLOCKS * TEST_SAMPLES];
+	static uint8_t data[MOCK_UART_SIZE];
+	static const uint8_t noise[] = { 0x00, ADCSTREAM_SYNC1, 0x13, ADCSTREAM_SYNC1 };
+	decoder_STREAMDEC dec;
+	uint32_t i;
+
+	Test_Stream();
+	memcpy(data, Mock_UartTx, Mock_UartTxLen);
+	/* A sample of block 2 changes: its CRC fails */
+	data[2 * ADCSTREAM_BLOCK + ADCSTREAM_HEADER + 1] ^= 0x40;
+
+	StreamDec_Init(&dec, samples, TEST_BLOCKS * TEST_SAMPLES);
+	/* Bytes before the first block, e.g. a port opened late */
+	StreamDec_Feed(&dec, noise, sizeof(noise));
+	StreamDec_Feed(&dec, data, Mock_UartTxLen);
+	TEST_EQUAL(dec.blocks, TEST_BLOCKS - 1);
+	TEST_EQUAL(dec.bad, 1);
+	TEST_EQUAL(dec.lost, 1);
+	/* Blocks 0, 1, then 3 onwards */
+	for (i = 0; i < 2 * TEST_SAMPLES; i++)
+		TEST_EQUAL(samples[i], Test_Value(i));
+	for (; i < dec.count; i++)
+		TEST_EQUAL(samples[i], Test_Value(i + TEST_SAMPLES));
+}
+
+static void Test_Dropped(void)
+{
+	static uint16_t samples[TEST_BLOCKS * TEST_SAMPLES];
+	decoder_STREAMDEC dec;
+
+	/* The UART needs more time for a block than the ADC */
+	Mock_UartTxPeriod = Mock_AdcPeriod * TEST_SAMPLES / ADCSTREAM_BLOCK * 2;
+	Test_Stream();
+	TEST_ASSERT(ADCSTREAM_Dropped() > 0);
+
+	StreamDec_Init(&dec, samples, TEST_BLOCKS * TEST_SAMPLES);
+	StreamDec_Feed(&dec, Mock_UartTx, Mock_UartTxLen);
+	TEST_EQUAL(dec.bad, 0);
+	TEST_EQUAL(dec.blocks + ADCSTREAM_Dropped(), TEST_BLOCKS);
+	/* Only the drops before the last received block are seen as gaps */
+	TEST_EQUAL(dec.lost, (uint32_t)dec.seq + 1 - dec.blocks);
+	TEST_EQUAL(samples[0], Test_Value(0));
+}
+
+int main(void)
+{
+	TEST_RUN(Test_RoundTrip);
+	TEST_RUN(Test_Corrupt);
+	TEST_RUN(Test_Dropped);
+	return TEST_END();
+}
@@ -0,0 +1,99 @@
+/*************************************************************************
+ Title	:   Bus benchmark of the libraries on the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Counts what the drivers put on the buses and the interrupts they 
+       need, which the model gives exactly: I2C bytes and transfers of a 
+       full refresh of the LCD, UDRE interrupts per byte sent and ADC 
+       interrupts per conversion. The bus time is computed from I2C_VEL.
+       The counts are checked, so a change that sends more bytes fails.
+
+       Cycles per ISR and the flash/RAM footprint need the AVR core and
+       AVR-GCC: they are measured by bench_sim (SIM_BENCH.c) in simavr.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+
+static void Test_LcdRefresh(void)
+{
+	char line[LCD_COLS + 1];
+	uint16_t i;
+	uint16_t transfers = 0;
+	uint16_t bytes = 0;
+	uint32_t bus_us;
+
+	memset(line, 'x', LCD_COLS);
+	line[LCD_COLS] = 0;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	Mock_Run(Mock_TwiPeriod + 1);
+	Mock_TwiLogLen = 0;
+
+	/* Every char of the display */
+	LCD_GotoXY(1, 0);
+	LCD_String(line);
+	LCD_GotoXY(2, 0);
+	LCD_String(line);
+	Mock_Run(Mock_TwiPeriod + 1);
+
+	for (i = 0; i < Mock_TwiLogLen; i++)
+	{
+		if (Mock_TwiLog[i] == MOCK_TWI_START)
+			transfers++;
+		else if (Mock_TwiLog[i] != MOCK_TWI_STOP)
+			bytes++;
+	}
+	/* 9 bits per byte, about 2 bits for the Start and the Stop */
+	bus_us = (uint32_t)((bytes * 9UL + transfers * 2UL) * 1000000UL / I2C_VEL);
+	printf("  LCD %ux%u refresh: %u transfers, %u bytes, %lu us at %lu Hz\n",
+		   LCD_COLS, LCD_ROWS, transfers, bytes, (unsigned long)bus_us, (unsigned long)I2C_VEL);
+	/* One transfer per char or command: address and 4 expander bytes, 
+	   one more when RS changes (first char of a row, second GotoXY) */
+	TEST_EQUAL(transfers, 2 * LCD_COLS + 2);
+	TEST_EQUAL(bytes, 5 + (LCD_COLS * 5 + 1) + 6 + (LCD_COLS * 5 + 1));
+}
+
+static void Test_UartInterrupts(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	USART_putString("0123456789");
+	Mock_Run(20 * Mock_UartTxPeriod);
+	printf("  UART TX: %u bytes, %lu UDRE interrupts\n",
+		   Mock_UartTxLen, (unsigned long)Mock_Interrupts);
+	/* One per byte and the last one disables the interrupt */
+	TEST_EQUAL(Mock_UartTxLen, 10);
+	TEST_EQUAL(Mock_Interrupts, 11);
+}
+
+static void Test_AdcInterrupts(void)
+{
+	uint8_t i;
+
+	ADC_Init();
+	sei();
+	ADC_StartAuto();
+	for (i = 0; i < 32; i++)
+		ADC_GetValue();
+	ADC_Stop();
+	printf("  ADC: %lu conversions, %lu interrupts\n",
+		   (unsigned long)Mock_AdcConversions, (unsigned long)Mock_Interrupts);
+	TEST_EQUAL(Mock_Interrupts, Mock_AdcConversions);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_LcdRefresh);
+	TEST_RUN(Test_UartInterrupts);
+	TEST_RUN(Test_AdcInterrupts);
+	return TEST_END();
+}
@@ -0,0 +1,147 @@
+/*************************************************************************
+ Title	:   Host test of the ADC to LCD dashboard (AVR_DASHBOARD)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs Dashboard_Task() on the ADC and TWI models and reads the LCD
+       back with the HD44780 model (LCDDEC.c). Checks that each call 
+       makes one LCD transfer at most, that the scan converts at full 
+       speed while a field is drawn, the text of the fields, the credits
+       of Dashboard_Tick() and the deadband.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "LCDDEC.h"
+#include "../AVR_DASHBOARD/DASHBOARD.h"
+#include "../AVR_I2C/I2C.h"
+
+static field_DASHBOARD Test_Fields[] = 
+{
+	{ 1, 0, "A:", 0, 4, 0, 0, 0, 0, 0, 0, 0 },
+	{ 2, 0, "Volts:", 1, 5, 2, 10, 0, 0, 0, 0, 0 },
+};
+
+#define TEST_FIELDS		(sizeof(Test_Fields) / sizeof(Test_Fields[0]))
+
+static uint16_t Test_Starts(void)
+{
+	uint16_t starts = 0;
+	uint16_t i;
+
+	for (i = 0; i < Mock_TwiLogLen; i++)
+		if (Mock_TwiLog[i] == MOCK_TWI_START)
+			starts++;
+	return starts;
+}
+
+/* Calls of Dashboard_Task() in a row, the time is the one of the calls.
+   Returns the LCD transfers made. */
+static uint16_t Test_Tasks(uint8_t calls)
+{
+	uint16_t first = Test_Starts();
+	uint16_t starts;
+
+	while (calls--)
+	{
+		starts = Test_Starts();
+		Dashboard_Task();
+		TEST_ASSERT(Test_Starts() - starts <= 1);
+	}
+	return Test_Starts() - first;
+}
+
+/* Time of the main loop away from the dashboard: each channel is 
+   converted again */
+static void Test_Scan(void)
+{
+	Mock_Run(TEST_FIELDS * (Mock_AdcPeriod + 4));
+}
+
+static void Test_Start(void)
+{
+	Mock_AdcValue[0] = 291;
+	Mock_AdcValue[1] = 1023;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	ADC_Init();
+	Dashboard_Init(Test_Fields, TEST_FIELDS);
+}
+
+static void Test_Draw(void)
+{
+	Test_Start();
+	Test_Scan();
+
+	/* The credit of the init draws the first field: cursor and 4 chars */
+	TEST_EQUAL(Test_Tasks(12), 1 + 4);
+
+	/* The second one waits for a tick */
+	Dashboard_Tick();
+	TEST_EQUAL(Test_Tasks(12), 1 + 5);
+
+	LcdDec_Idle();
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "A: 291", 6);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "Volts:10.23", 11);
+}
+
+static void Test_Rate(void)
+{
+	uint32_t ticks;
+	uint32_t conversions;
+
+	Test_Start();
+	Test_Scan();
+
+	/* The ADC does not wait for the LCD: during the drawing of a field 
+	   the conversions follow each other, a few ticks of ISR apart */
+	ticks = Mock_Ticks;
+	conversions = Mock_AdcConversions;
+	TEST_EQUAL(Test_Tasks(5), 1 + 4);
+	ticks = Mock_Ticks - ticks;
+	conversions = Mock_AdcConversions - conversions;
+	printf("  %lu conversions in %lu ticks of drawing (%u per conversion)\n",
+		(unsigned long)conversions, (unsigned long)ticks, Mock_AdcPeriod);
+	TEST_ASSERT(conversions * (Mock_AdcPeriod + 8) >= ticks);
+
+	/* Both channels, in turn */
+	TEST_EQUAL(ADC_ScanChannels(), 0x03);
+	TEST_EQUAL(ADC_GetScan(0), 291);
+	TEST_EQUAL(ADC_GetScan(1), 1023);
+}
+
+static void Test_Deadband(void)
+{
+	/* Both fields on the LCD, one credit each */
+	Test_Start();
+	Test_Scan();
+	TEST_EQUAL(Test_Tasks(10), 1 + 4);
+	Dashboard_Tick();
+	TEST_EQUAL(Test_Tasks(10), 1 + 5);
+
+	/* 1023 to 1015 is inside the deadband of 10 */
+	Mock_AdcValue[1] = 1015;
+	Dashboard_Tick();
+	Test_Scan();
+	TEST_EQUAL(Test_Tasks(10), 0);
+
+	/* 1023 to 1000 is not */
+	Mock_AdcValue[1] = 1000;
+	Test_Scan();
+	TEST_EQUAL(Test_Tasks(10), 1 + 5);
+	LcdDec_Idle();
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "Volts:10.00", 11);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Draw);
+	TEST_RUN(Test_Rate);
+	TEST_RUN(Test_Deadband);
+	return TEST_END();
+}
@@ -0,0 +1,239 @@
+/*************************************************************************
+ Title	:   Host test of the EEPROM configuration library (AVR_EECONFIG)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs EECONFIG.c on the EEPROM of the model: an erased EEPROM, the
+       round-robin of the slots and the writes of each one, the sequence
+       wrapping past 255, a broken newest record and the records of an 
+       older layout. Built with EECONFIG_ENABLE, the drivers have to take
+       their parameters from EECONFIG_Data at init.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include <stddef.h>
+#include "TEST.h"
+#include "LCDDEC.h"
+#include "../AVR_EECONFIG/EECONFIG.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+#include "../AVR_RGBLED/RGBLED.h"
+
+#define TEST_ROUNDS			3
+
+/* The store is the only EEMEM variable of the test */
+static uint8_t* Test_Slot(uint8_t slot)
+{
+	uint16_t size;
+	uint8_t* store = Mock_Eeprom(&size);
+
+	TEST_EQUAL(size, EECONFIG_SLOTS * EECONFIG_SLOT_SIZE);
+	return store + slot * EECONFIG_SLOT_SIZE;
+}
+
+/* Slot changed since a copy of the store, 0xFF if none or more than one */
+static uint8_t Test_Changed(const uint8_t* copy)
+{
+	uint8_t changed = 0xFF;
+	uint8_t slot;
+
+	for (slot = 0; slot < EECONFIG_SLOTS; slot++)
+	{
+		if (memcmp(copy + slot * EECONFIG_SLOT_SIZE, Test_Slot(slot), EECONFIG_SLOT_SIZE) == 0)
+			continue;
+		if (changed != 0xFF)
+			return 0xFF;
+		changed = slot;
+	}
+	return changed;
+}
+
+static void Test_Erased(void)
+{
+	Mock_EepromErase();
+	EECONFIG_Data.adc_channel = 7;
+	TEST_EQUAL(EECONFIG_Init(), 0);
+	TEST_EQUAL(EECONFIG_Data.uart_ubrr, MYUBRR);
+	TEST_EQUAL(EECONFIG_Data.adc_channel, ADC_CHANNEL);
+	TEST_EQUAL(EECONFIG_Data.lcd_addr, LCD_Add);
+	TEST_EQUAL(EECONFIG_Data.rgb_type, TYPE_RGB);
+	TEST_EQUAL(Mock_EepromWrites, 0);
+}
+
+static void Test_RoundRobin(void)
+{
+	uint8_t copy[EECONFIG_SLOTS * EECONFIG_SLOT_SIZE];
+	uint32_t writes[EECONFIG_SLOTS] = { 0 };
+	uint32_t before;
+	uint8_t slot;
+	uint8_t i;
+
+	Mock_EepromErase();
+	EECONFIG_Init();
+	for (i = 0; i < TEST_ROUNDS * EECONFIG_SLOTS; i++)
+	{
+		memcpy(copy, Test_Slot(0), sizeof(copy));
+		before = Mock_EepromWrites;
+		EECONFIG_Data.uart_ubrr = 100 + i;
+		EECONFIG_Save();
+		/* One slot per save, the next one */
+		slot = Test_Changed(copy);
+		TEST_EQUAL(slot, i % EECONFIG_SLOTS);
+		if (slot < EECONFIG_SLOTS)
+			writes[slot] += Mock_EepromWrites - before;
+		/* Only a record: header, config and CRC */
+		TEST_ASSERT(Mock_EepromWrites - before <= 3 + sizeof(config_EECONFIG) + 2);
+		TEST_EQUAL(EECONFIG_Init(), 1);
+		TEST_EQUAL(EECONFIG_Data.uart_ubrr, 100 + i);
+	}
+	/* The first round writes the whole record, the others the changes */
+	for (slot = 1; slot < EECONFIG_SLOTS; slot++)
+		TEST_EQUAL(writes[slot], writes[0]);
+	TEST_ASSERT(writes[0] > 0);
+	TEST_ASSERT(writes[0] <= TEST_ROUNDS * (3 + sizeof(config_EECONFIG) + 2));
+}
+
+static void Test_SeqWrap(void)
+{
+	uint16_t i;
+	uint8_t ok = 1;
+
+	Mock_EepromErase();
+	EECONFIG_Init();
+	for (i = 0; i < 300; i++)
+	{
+		EECONFIG_Data.uart_ubrr = i;
+		EECONFIG_Save();
+		EECONFIG_Init();
+		if (EECONFIG_Data.uart_ubrr != i)
+			ok = 0;
+	}
+	TEST_ASSERT(ok);
+	/* The last record has seq 299 mod 256 */
+	TEST_EQUAL(Test_Slot(299 % EECONFIG_SLOTS)[0], 299 & 0xFF);
+	TEST_EQUAL(EECONFIG_Data.uart_ubrr, 299);
+}
+
+static void Test_Corrupt(void)
+{
+	Mock_EepromErase();
+	EECONFIG_Init();
+	EECONFIG_Data.adc_channel = 3;
+	EECONFIG_Save();
+	EECONFIG_Data.adc_channel = 5;
+	EECONFIG_Save();
+	/* A bit of the newest record lost, e.g. a reset during the write */
+	Test_Slot(1)[3 + 2] ^= 0x01;
+	TEST_EQUAL(EECONFIG_Init(), 1);
+	TEST_EQUAL(EECONFIG_Data.adc_channel, 3);
+	/* The next save replaces the broken record */
+	EECONFIG_Data.adc_channel = 6;
+	EECONFIG_Save();
+	EECONFIG_Init();
+	TEST_EQUAL(EECONFIG_Data.adc_channel, 6);
+	/* A broken CRC */
+	Test_Slot(1)[3 + sizeof(config_EECONFIG)] ^= 0x80;
+	EECONFIG_Init();
+	TEST_EQUAL(EECONFIG_Data.adc_channel, 3);
+}
+
+/* Write a record by hand */
+static void Test_Record(uint8_t slot, uint8_t seq, uint8_t version, const uint8_t* data, uint8_t size)
+{
+	uint8_t* record = Test_Slot(slot);
+	uint16_t crc = 0xFFFF;
+	uint8_t i;
+
+	record[0] = seq;
+	record[1] = version;
+	record[2] = size;
+	memcpy(&record[3], data, size);
+	for (i = 0; i < 3 + size; i++)
+		crc = _crc16_update(crc, record[i]);
+	record[i] = (uint8_t)crc;
+	record[i + 1] = (uint8_t)(crc >> 8);
+}
+
+static void Test_Versions(void)
+{
+	config_EECONFIG old;
+
+	/* Version 0 had only uart_ubrr and adc_channel */
+	old.uart_ubrr = 207;
+	old.adc_channel = 4;
+	Mock_EepromErase();
+	Test_Record(2, 10, 0, (const uint8_t*)&old, offsetof(config_EECONFIG, adc_channel) + 1);
+	TEST_EQUAL(EECONFIG_Init(), 1);
+	TEST_EQUAL(EECONFIG_Data.uart_ubrr, 207);
+	TEST_EQUAL(EECONFIG_Data.adc_channel, 4);
+	TEST_EQUAL(EECONFIG_Data.lcd_addr, LCD_Add);
+	TEST_EQUAL(EECONFIG_Data.rgb_type, TYPE_RGB);
+	/* A newer layout is not used, even if it is the newest record */
+	old.adc_channel = 6;
+	Test_Record(3, 11, EECONFIG_VERSION + 1, (const uint8_t*)&old, sizeof(old));
+	TEST_EQUAL(EECONFIG_Init(), 1);
+	TEST_EQUAL(EECONFIG_Data.adc_channel, 4);
+	/* The next save goes after the newest record, with this version */
+	EECONFIG_Save();
+	TEST_EQUAL(Test_Slot(3)[0], 11);
+	TEST_EQUAL(Test_Slot(3)[1], EECONFIG_VERSION);
+	TEST_EQUAL(Test_Slot(3)[2], sizeof(config_EECONFIG));
+}
+
+static void Test_Drivers(void)
+{
+	uint8_t channel = (ADC_CHANNEL == 5) ? 6 : 5;
+	uint8_t type = (TYPE_RGB == COMMON_ANODE) ? COMMON_CATHODE : COMMON_ANODE;
+
+	Mock_EepromErase();
+	EECONFIG_Init();
+	EECONFIG_Data.adc_channel = channel;
+	EECONFIG_Data.lcd_addr = 0x3F;
+	EECONFIG_Data.rgb_type = type;
+	EECONFIG_Save();
+	EECONFIG_Defaults();
+	TEST_EQUAL(EECONFIG_Init(), 1);
+
+	/* ADC: the channel of ADMUX */
+	ADC_Init();
+	TEST_EQUAL(ADMUX & 0x0F, channel);
+
+	/* LCD: the address of the transfers */
+	Mock_TwiAddress = 0x3F;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLog[1], I2C_ADD_WR(0x3F));
+	LcdDec_Decode(0x3F);
+	TEST_EQUAL(LcdDec_Commands, 7);
+
+	/* RGB: the pins of the other type, also for the macros */
+	RGBLed_Init();
+	RGBLed_Color(RED);
+	TEST_EQUAL(PORT_RGB & RGB_MASK, (type == COMMON_CATHODE) ? (1 << PIN_R) : RGB_MASK & ~(1 << PIN_R));
+	RGB_CLEAR();
+	TEST_EQUAL(PORT_RGB & RGB_MASK, (type == COMMON_CATHODE) ? 0 : RGB_MASK);
+	RGB_GREEN();
+	RGB_BLUE();
+	TEST_EQUAL(PORT_RGB & RGB_MASK, (type == COMMON_CATHODE) ? (1 << PIN_G) | (1 << PIN_B) : (1 << PIN_R));
+
+	/* An invalid channel is replaced by ADC_CHANNEL */
+	EECONFIG_Data.adc_channel = 9;
+	ADC_Init();
+	TEST_EQUAL(ADMUX & 0x0F, ADC_CHANNEL);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Erased);
+	TEST_RUN(Test_RoundRobin);
+	TEST_RUN(Test_SeqWrap);
+	TEST_RUN(Test_Corrupt);
+	TEST_RUN(Test_Versions);
+	TEST_RUN(Test_Drivers);
+	return TEST_END();
+}
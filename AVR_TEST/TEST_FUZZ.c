@@ -0,0 +1,531 @@
+/*************************************************************************
+ Title	:   Seeded random test of the rings and the shell parser
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Random operations, from a xorshift generator with a fixed seed, 
+       on the USART and ADC rings and on the line editor and parser of 
+       the shell. The index arithmetic wraps many times per run. Built 
+       with USART_RX_BUFFER_SIZE and ADC_BUFFER_SIZE of 2, 8, 64 and 256.
+       Checked invariants:
+           rings   never more than size - 1 values. The values are their
+                   sequence numbers: each one read is the next one, or a
+                   later one when the values in between were counted as
+                   drops by the Stats library (or flushed), and at the 
+                   end the skipped values are exactly the drops.
+           TX      every byte sent is on the line, in order.
+           shell   the output of each byte is the one of a reference 
+                   line editor and argument splitter written here.
+       Mock_Preempt makes the ISRs run at random register accesses inside
+       USART_Receive(), USART_Transmit() and ADC_GetValue(). The ticks of
+       the model per call of each are printed.
+
+ USAGE
+       test_fuzz_<size> [seed] [rounds]       a failure prints its seed
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <stdlib.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_SHELL/SHELL.h"
+#include "../AVR_STATS/STATS.h"
+
+/* Values of the rings: their sequence number, modulo the range */
+#define FUZZ_UART_MASK		0xFF
+#define FUZZ_ADC_MASK		0x3FF
+
+static uint32_t Fuzz_Seed = 1;
+static uint32_t Fuzz_State;
+static uint32_t Fuzz_Rounds = 2000;
+
+/* Sequence numbers of the next value produced and of the next one 
+   expected by the reader, values skipped by the reader */
+static uint32_t Fuzz_Produced;
+static uint32_t Fuzz_Next;
+static uint32_t Fuzz_Skipped;
+
+/* Ticks of the model in the calls of a driver function, without the 
+   ticks asleep. The ISRs that preempt the call are included */
+typedef struct
+{
+	const char* name;
+	uint32_t calls;
+	uint32_t ticks;
+	uint32_t max;
+} cost_FUZZ;
+
+static cost_FUZZ Fuzz_Receive = { "USART_Receive", 0, 0, 0 };
+static cost_FUZZ Fuzz_Transmit = { "USART_Transmit", 0, 0, 0 };
+static cost_FUZZ Fuzz_GetValue = { "ADC_GetValue", 0, 0, 0 };
+static uint32_t Fuzz_Begin;
+static uint8_t Fuzz_Inside;					// 1 in a call of a driver
+
+
+static uint32_t Fuzz_Random(void)
+{
+	/* xorshift32, never 0 */
+	Fuzz_State ^= Fuzz_State << 13;
+	Fuzz_State ^= Fuzz_State >> 17;
+	Fuzz_State ^= Fuzz_State << 5;
+	return Fuzz_State;
+}
+
+static uint32_t Fuzz_Below(uint32_t n)
+{
+	return Fuzz_Random() % n;
+}
+
+/* Mock_Preempt: one register access out of 4 of a driver call finishes
+   the events in progress, their ISRs run inside the call */
+static uint8_t Fuzz_Preempt(void)
+{
+	return Fuzz_Inside && Fuzz_Below(4) == 0;
+}
+
+static void Fuzz_Start(void)
+{
+	Fuzz_State = Fuzz_Seed ? Fuzz_Seed : 1;
+	Fuzz_Produced = 0;
+	Fuzz_Next = 0;
+	Fuzz_Skipped = 0;
+	Stats_Init();
+	Mock_Preempt = Fuzz_Preempt;
+}
+
+static void Fuzz_Enter(void)
+{
+	Fuzz_Inside = 1;
+	Fuzz_Begin = Mock_Ticks - Mock_SleepTicks;
+}
+
+static void Fuzz_Leave(cost_FUZZ* cost)
+{
+	uint32_t ticks = Mock_Ticks - Mock_SleepTicks - Fuzz_Begin;
+
+	Fuzz_Inside = 0;
+	cost->calls++;
+	cost->ticks += ticks;
+	if (ticks > cost->max)
+		cost->max = ticks;
+}
+
+static void Fuzz_Cost(const cost_FUZZ* cost)
+{
+	if (cost->calls)
+		printf("  %-15s %5.1f ticks per call, %lu max\n", cost->name,
+			(double)cost->ticks / cost->calls, (unsigned long)cost->max);
+}
+
+/* The value read has to be the next one, or a later one when the values
+   in between were counted as dropped (drops) and not skipped yet. The 
+   values carry their sequence number modulo mask + 1, the tests keep 
+   less than mask + 1 values between the producer and the reader. */
+static void Fuzz_Check(uint16_t value, uint16_t mask, uint32_t drops)
+{
+	uint32_t skip = (value - Fuzz_Next) & mask;
+
+	if (skip > drops - Fuzz_Skipped)
+	{
+		printf("  seed %lu: value %lu read, %lu expected, %lu drops not skipped\n",
+			(unsigned long)Fuzz_Seed, (unsigned long)value, 
+			(unsigned long)(Fuzz_Next & mask), (unsigned long)(drops - Fuzz_Skipped));
+		TEST_ASSERT(0);
+	}
+	Fuzz_Skipped += skip;
+	Fuzz_Next += skip + 1;
+}
+
+
+/*
+**	USART rings
+*/
+
+static uint8_t Fuzz_UartReceive(void)
+{
+	uint8_t c;
+
+	Fuzz_Enter();
+	c = USART_Receive();
+	Fuzz_Leave(&Fuzz_Receive);
+	return c;
+}
+
+static void Fuzz_TxCheck(const uint8_t* sent, uint16_t len)
+{
+	Mock_Run((uint32_t)Mock_UartTxPeriod * (USART_TX_BUFFER_SIZE + 2));
+	TEST_EQUAL(Mock_UartTxLen, len);
+	TEST_MEMORY(Mock_UartTx, sent, len);
+	Mock_UartTxLen = 0;
+}
+
+static void Test_UartRing(void)
+{
+	uint8_t burst[32];
+	uint8_t sent[16];
+	uint32_t round;
+	uint8_t n;
+	uint8_t i;
+
+	Fuzz_Start();
+	USART_Init(MYUBRR);
+	sei();
+
+	for (round = 0; round < Fuzz_Rounds * 4; round++)
+	{
+		switch (Fuzz_Below(4))
+		{
+			case 0:
+				/* Bursts can be longer than the free space of the ring.
+				   Less than 256 bytes wait for the reader */
+				n = 1 + Fuzz_Below(sizeof(burst));
+				if (Fuzz_Produced - Fuzz_Next + n > FUZZ_UART_MASK)
+					break;
+				for (i = 0; i < n; i++)
+					burst[i] = (uint8_t)(Fuzz_Produced++ & FUZZ_UART_MASK);
+				Mock_UartInject(burst, n);
+				break;
+			case 1:
+				Mock_Run(Fuzz_Below(Mock_UartRxPeriod * 8));
+				break;
+			case 2:
+				n = USART_Available();
+				/* A full ring of 256 is 255 values, the most of uint8_t */
+				#if USART_RX_BUFFER_SIZE < 256
+				TEST_ASSERT(n <= USART_RX_BUFFER_MASK);
+				#endif
+				n = Fuzz_Below(n + 1);
+				while (n--)
+					Fuzz_Check(Fuzz_UartReceive(), FUZZ_UART_MASK, Stats_Counter[STATS_UART_RX_OVERRUN]);
+				break;
+			default:
+				n = 1 + Fuzz_Below(sizeof(sent));
+				for (i = 0; i < n; i++)
+				{
+					sent[i] = (uint8_t)Fuzz_Random();
+					Fuzz_Enter();
+					USART_Transmit(sent[i]);
+					Fuzz_Leave(&Fuzz_Transmit);
+				}
+				Fuzz_TxCheck(sent, n);
+				break;
+		}
+	}
+
+	/* Receive the rest: each byte injected was read or dropped */
+	while (Mock_UartPending() || USART_Available())
+	{
+		Mock_Run(Mock_UartRxPeriod);
+		while (USART_Available())
+			Fuzz_Check(Fuzz_UartReceive(), FUZZ_UART_MASK, Stats_Counter[STATS_UART_RX_OVERRUN]);
+	}
+	Fuzz_Skipped += Fuzz_Produced - Fuzz_Next;
+	TEST_EQUAL(Mock_UartRxLost, 0);
+	TEST_EQUAL(Fuzz_Skipped, Stats_Counter[STATS_UART_RX_OVERRUN]);
+	printf("  %lu bytes, %lu dropped, %lu preemptions\n", (unsigned long)Fuzz_Produced, 
+		(unsigned long)Fuzz_Skipped, (unsigned long)Mock_Preemptions);
+	Fuzz_Cost(&Fuzz_Receive);
+	Fuzz_Cost(&Fuzz_Transmit);
+}
+
+
+/*
+**	ADC ring
+*/
+
+static uint16_t Fuzz_AdcSource(uint8_t channel)
+{
+	(void)channel;
+	return Fuzz_Produced++ & FUZZ_ADC_MASK;
+}
+
+static value_ADC Fuzz_AdcGetValue(void)
+{
+	value_ADC value;
+
+	Fuzz_Enter();
+	value = ADC_GetValue();
+	Fuzz_Leave(&Fuzz_GetValue);
+	return value;
+}
+
+static void Test_AdcRing(void)
+{
+	uint32_t flushed = 0;
+	uint32_t round;
+	uint8_t n;
+
+	Fuzz_Start();
+	Mock_AdcSource = Fuzz_AdcSource;
+	ADC_Init();
+	sei();
+	ADC_StartAuto();
+
+	for (round = 0; round < Fuzz_Rounds * 4; round++)
+	{
+		switch (Fuzz_Below(8))
+		{
+			case 0:
+				/* The unread values are discarded, counted like drops */
+				cli();
+				n = ADC_Available();
+				ADC_Flush();
+				sei();
+				flushed += n;
+				TEST_EQUAL(ADC_Available(), 0);
+				break;
+			case 1:
+			case 2:
+			case 3:
+				n = ADC_Available();
+				/* A full ring of 256 is 255 values, the most of uint8_t */
+				#if ADC_BUFFER_SIZE < 256
+				TEST_ASSERT(n <= ADC_BUFFER_MASK);
+				#endif
+				n = Fuzz_Below(n + 1);
+				while (n--)
+					Fuzz_Check(Fuzz_AdcGetValue(), FUZZ_ADC_MASK, Stats_Counter[STATS_ADC_DROP] + flushed);
+				break;
+			default:
+				/* Less than 1024 conversions wait for the reader */
+				if (Fuzz_Produced - Fuzz_Next < FUZZ_ADC_MASK - 32)
+					Mock_Run(Fuzz_Below(Mock_AdcPeriod * 12));
+				break;
+		}
+	}
+	ADC_Stop();
+	Mock_Run(Mock_AdcPeriod * 2);
+	while (ADC_Available())
+		Fuzz_Check(Fuzz_AdcGetValue(), FUZZ_ADC_MASK, Stats_Counter[STATS_ADC_DROP] + flushed);
+	Fuzz_Skipped += Fuzz_Produced - Fuzz_Next;
+	TEST_EQUAL(Fuzz_Skipped, Stats_Counter[STATS_ADC_DROP] + flushed);
+	printf("  %lu values, %lu dropped, %lu flushed, %lu preemptions\n", (unsigned long)Fuzz_Produced,
+		(unsigned long)Stats_Counter[STATS_ADC_DROP], (unsigned long)flushed, (unsigned long)Mock_Preemptions);
+	Fuzz_Cost(&Fuzz_GetValue);
+}
+
+
+/*
+**	Shell
+*/
+
+/* "a" and "ab" print their arguments: "<argc>:arg,arg\r\n" */
+static void Fuzz_Args(uint8_t argc, char** argv)
+{
+	uint8_t i;
+
+	USART_Transmit('0' + argc);
+	USART_Transmit(':');
+	for (i = 1; i < argc; i++)
+	{
+		if (i > 1)
+			USART_Transmit(',');
+		USART_putString(argv[i]);
+	}
+	USART_putString_P(PSTR("\r\n"));
+}
+
+static const command_SHELL Fuzz_Table[] PROGMEM = 
+{
+	{ "a", Fuzz_Args },
+	{ "ab", Fuzz_Args },
+};
+
+/* Reference shell */
+static char Fuzz_Expected[MOCK_UART_SIZE];
+static uint16_t Fuzz_ExpectedLen;
+static char Fuzz_Line[SHELL_LINE_SIZE];
+static uint8_t Fuzz_Length;
+static uint8_t Fuzz_Overflow;
+static uint8_t Fuzz_Last;
+static uint16_t Fuzz_Count[4];				// Lines: too long, too many, run, unknown
+
+static void Fuzz_Out(const char* s)
+{
+	while (*s)
+		Fuzz_Expected[Fuzz_ExpectedLen++] = *s++;
+}
+
+static void Fuzz_Execute(void)
+{
+	char* argv[SHELL_MAX_ARGS + 1];
+	char buf[4];
+	uint8_t argc = 0;
+	uint8_t i;
+	char* token;
+
+	Fuzz_Line[Fuzz_Length] = 0;
+	for (token = strtok(Fuzz_Line, " "); token; token = strtok(NULL, " "))
+	{
+		if (argc > SHELL_MAX_ARGS)
+			break;
+		argv[argc++] = token;
+	}
+	if (argc > SHELL_MAX_ARGS)
+	{
+		Fuzz_Count[1]++;
+		Fuzz_Out("too many arguments\r\n");
+	} else if (argc == 0)
+	{
+	} else if (strcmp(argv[0], "a") == 0 || strcmp(argv[0], "ab") == 0)
+	{
+		Fuzz_Count[2]++;
+		buf[0] = '0' + argc;
+		buf[1] = ':';
+		buf[2] = 0;
+		Fuzz_Out(buf);
+		for (i = 1; i < argc; i++)
+		{
+			if (i > 1)
+				Fuzz_Out(",");
+			Fuzz_Out(argv[i]);
+		}
+		Fuzz_Out("\r\n");
+	} else if (strcmp(argv[0], "help") == 0)
+	{
+		Fuzz_Count[2]++;
+		Fuzz_Out("a ab help \r\n");
+	} else
+	{
+		Fuzz_Count[3]++;
+		Fuzz_Out(argv[0]);
+		Fuzz_Out(": unknown command\r\n");
+	}
+}
+
+static void Fuzz_Byte(uint8_t c)
+{
+	char echo[2] = { (char)c, 0 };
+
+	if (c == '\n' && Fuzz_Last == '\r')
+	{
+	} else if (c == '\r' || c == '\n')
+	{
+		Fuzz_Out("\r\n");
+		if (Fuzz_Overflow)
+		{
+			Fuzz_Count[0]++;
+			Fuzz_Out("line too long\r\n");
+		}
+		else
+			Fuzz_Execute();
+		Fuzz_Length = 0;
+		Fuzz_Overflow = 0;
+		Fuzz_Out(SHELL_PROMPT);
+	} else if (c == 0x08 || c == 0x7F)
+	{
+		if (Fuzz_Length > 0)
+		{
+			Fuzz_Length--;
+			Fuzz_Out("\b \b");
+		}
+	} else if (c >= ' ')
+	{
+		if (Fuzz_Length < SHELL_LINE_SIZE - 1)
+		{
+			Fuzz_Line[Fuzz_Length++] = c;
+			Fuzz_Out(echo);
+		} else
+		{
+			Fuzz_Overflow = 1;
+		}
+	}
+	Fuzz_Last = c;
+}
+
+/* Mostly chars of the commands and spaces, some edits and line ends */
+static uint8_t Fuzz_ShellChar(void)
+{
+	static const char common[] = "aab  x\b\x7F\x01";
+	uint32_t r = Fuzz_Below(64);
+
+	/* About 30 chars per line, some lines do not fit */
+	if (r < 2)
+		return (r == 0) ? '\r' : '\n';
+	if (r < 56)
+		return common[r % (sizeof(common) - 1)];
+	return (uint8_t)Fuzz_Random();
+}
+
+/* Whole lines, to reach the commands and the argument limit */
+static const char* const Fuzz_Lines[] = 
+{
+	"help\r", "ab x y\r", "a b c d e\r", " a  b \r\n"
+};
+
+static void Test_Shell(void)
+{
+	uint8_t burst[USART_RX_BUFFER_SIZE - 1];
+	uint32_t round;
+	uint8_t n;
+	uint8_t i;
+
+	Fuzz_Start();
+	USART_Init(MYUBRR);
+	sei();
+	Fuzz_Length = 0;
+	Fuzz_Overflow = 0;
+	Fuzz_Last = 0;
+	Fuzz_ExpectedLen = 0;
+	memset(Fuzz_Count, 0, sizeof(Fuzz_Count));
+	Fuzz_Out(SHELL_PROMPT);
+	Shell_Init(Fuzz_Table, sizeof(Fuzz_Table) / sizeof(Fuzz_Table[0]));
+
+	for (round = 0; round < Fuzz_Rounds; round++)
+	{
+		/* The RX ring never overflows, so the output is exact */
+		n = 1 + Fuzz_Below(sizeof(burst));
+		for (i = 0; i < n; i++)
+		{
+			const char* line = Fuzz_Lines[Fuzz_Below(sizeof(Fuzz_Lines) / sizeof(Fuzz_Lines[0]))];
+			uint8_t len = strlen(line);
+
+			if (i + len <= n && Fuzz_Below(8) == 0)
+			{
+				memcpy(&burst[i], line, len);
+				i += len - 1;
+				continue;
+			}
+			burst[i] = Fuzz_ShellChar();
+		}
+		for (i = 0; i < n; i++)
+			Fuzz_Byte(burst[i]);
+
+		/* The whole burst fits in the RX ring */
+		Mock_UartInject(burst, n);
+		Mock_Run((uint32_t)Mock_UartRxPeriod * (n + 1));
+		Shell_Task();
+		Mock_Run((uint32_t)Mock_UartTxPeriod * (USART_TX_BUFFER_SIZE + 2));
+
+		TEST_EQUAL(Mock_UartTxLen, Fuzz_ExpectedLen);
+		if (Mock_UartTxLen != Fuzz_ExpectedLen || memcmp(Mock_UartTx, Fuzz_Expected, Fuzz_ExpectedLen) != 0)
+		{
+			printf("  seed %lu, round %lu: output differs\n", (unsigned long)Fuzz_Seed, (unsigned long)round);
+			TEST_ASSERT(0);
+			break;
+		}
+		Mock_UartTxLen = 0;
+		Fuzz_ExpectedLen = 0;
+	}
+	TEST_EQUAL(Stats_Counter[STATS_UART_RX_OVERRUN], 0);
+	printf("  lines: %u too long, %u too many arguments, %u run, %u unknown\n",
+		   Fuzz_Count[0], Fuzz_Count[1], Fuzz_Count[2], Fuzz_Count[3]);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		Fuzz_Seed = strtoul(argv[1], NULL, 0);
+	if (argc > 2)
+		Fuzz_Rounds = strtoul(argv[2], NULL, 0);
+	printf("seed %lu, %lu rounds\n", (unsigned long)Fuzz_Seed, (unsigned long)Fuzz_Rounds);
+
+	TEST_RUN(Test_UartRing);
+	TEST_RUN(Test_AdcRing);
+	TEST_RUN(Test_Shell);
+	return TEST_END();
+}
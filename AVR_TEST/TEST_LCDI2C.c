@@ -0,0 +1,370 @@
+/*************************************************************************
+ Title	:   Host test of the LCD - I2C adapter library (AVR_LCDI2C, AVR_I2C)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs LCDI2C.c and I2C.c on the model of the TWI. The bytes of the
+       bus are given to a model of the PCF8574 and the HD44780 (LCDDEC.c)
+       and the test checks the text shown by the display. The I2C register functions are 
+       checked against the bus log. Built with and without I2C_SLEEP_WAIT,
+       the second one also checks I2C_TIMEOUT. The 20x4 and 40x2 builds
+       check the address of each row and the wrap of other geometries,
+       the LCD_GPIO_MASK build the spare pin of LCD_SetPins().
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/twi.h>
+#include "TEST.h"
+#include "LCDDEC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+/* DDRAM address of each row */
+#if LCD_COLS == 20
+static const uint8_t Test_RowAddress[4] = { 0x00, 0x40, 0x14, 0x54 };
+#else
+static const uint8_t Test_RowAddress[4] = { 0x00, 0x40, 0x10, 0x50 };
+#endif
+
+static uint16_t Test_Count(uint16_t event)
+{
+	uint16_t i;
+	uint16_t count = 0;
+
+	for (i = 0; i < Mock_TwiLogLen; i++)
+		if (Mock_TwiLog[i] == event)
+			count++;
+	return count;
+}
+
+
+/* 1 if every byte written to the expander since from has pins at value */
+static uint8_t Test_Pins(uint16_t from, uint8_t pins, uint8_t value)
+{
+	uint16_t i;
+
+	for (i = from; i < Mock_TwiLogLen; i++)
+	{
+		if (Mock_TwiLog[i] == MOCK_TWI_START)
+			i++;			// Address
+		else if (Mock_TwiLog[i] != MOCK_TWI_STOP && (Mock_TwiLog[i] & pins) != value)
+			return 0;
+	}
+	return 1;
+}
+
+
+static void Test_Init(void)
+{
+	I2C_Init();
+	TEST_EQUAL(TWBR, MYTWBR);
+	TEST_EQUAL(TWSR & 0x03, MYTWPS);
+	TEST_EQUAL(TWCR & (1 << TWEN), (1 << TWEN));
+	sei();
+	LCD_Init();
+	LcdDec_Idle();
+	/* One transfer per command, every byte acknowledged */
+	TEST_EQUAL(Test_Count(MOCK_TWI_START), 5);
+	TEST_EQUAL(Test_Count(MOCK_TWI_STOP), 5);
+	TEST_EQUAL(Mock_TwiLog[0], MOCK_TWI_START);
+	TEST_EQUAL(Mock_TwiLog[1], I2C_ADD_WR(LCD_Add));
+	TEST_EQUAL(Mock_TwiLog[Mock_TwiLogLen - 1], MOCK_TWI_STOP);
+	LcdDec_Decode(LCD_Add);
+	/* 0x33 and 0x32 are 4 commands of the 8 bits mode, then 3 more */
+	TEST_EQUAL(LcdDec_Commands, 7);
+#if I2C_SLEEP_WAIT
+	/* The I2C functions sleep until the TWI interrupt */
+	TEST_ASSERT(Mock_Sleeps > 0);
+#else
+	TEST_EQUAL(Mock_Sleeps, 0);
+#endif
+}
+
+static void Test_String(void)
+{
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LCD_String("Hello");
+	LCD_GotoXY(2, 3);
+	LCD_Number(1234);
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "Hello ", 6);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "   1234 ", 8);
+}
+
+static void Test_Wrap(void)
+{
+	char text[LCD_COLS + 5];
+	uint8_t i;
+
+	for (i = 0; i < LCD_COLS + 4; i++)
+		text[i] = (char)('A' + i % 26);
+	text[LCD_COLS + 4] = 0;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	/* A row and 4 chars: the last 4 continue on the second row */
+	LCD_String(text);
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], text, LCD_COLS);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], &text[LCD_COLS], 4);
+	TEST_EQUAL(LcdDec_Ddram[0x44], ' ');
+	TEST_EQUAL(LcdDec_Ddram[LCD_COLS], ' ');
+	/* The end of the last row continues on the first one */
+	LCD_GotoXY(LCD_ROWS, LCD_COLS - 1);
+	LCD_String("yz");
+	LcdDec_Decode(LCD_Add);
+	TEST_EQUAL(LcdDec_Ddram[Test_RowAddress[LCD_ROWS - 1] + LCD_COLS - 1], 'y');
+	TEST_EQUAL(LcdDec_Ddram[0x00], 'z');
+}
+
+static void Test_Geometry(void)
+{
+	uint8_t row;
+
+	I2C_Init();
+	sei();
+	LCD_Init();
+	for (row = 1; row <= LCD_ROWS; row++)
+	{
+		LCD_GotoXY(row, 2);
+		LCD_Char('0' + row);
+		LcdDec_Decode(LCD_Add);
+		TEST_EQUAL(LcdDec_Command, LCD_DDRAM | (Test_RowAddress[row - 1] + 2));
+		TEST_EQUAL(LcdDec_Ddram[Test_RowAddress[row - 1] + 2], '0' + row);
+	}
+	/* A row out of the display sends nothing */
+	LcdDec_Idle();
+	row = Mock_TwiLogLen;
+	LCD_GotoXY(LCD_ROWS + 1, 0);
+	LCD_GotoXY(0, 0);
+	TEST_EQUAL(Mock_TwiLogLen, row);
+}
+
+static void Test_Scroll(void)
+{
+	char text[LCD_LINE_LEN + 1];
+	uint16_t len;
+	uint8_t commands;
+	uint8_t i;
+
+	for (i = 0; i < LCD_LINE_LEN; i++)
+		text[i] = (char)('a' + i % 26);
+	text[LCD_LINE_LEN] = 0;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	/* The whole line is written, without wrapping to the next row */
+	LCD_Marquee(1, text);
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], text, LCD_LINE_LEN);
+	TEST_EQUAL(LcdDec_Ddram[0x40], ' ');
+	commands = LcdDec_Commands;
+	/* Each step is one command in one transfer: Start, address, 2 nibbles
+	   with E high and low, Stop. After the chars RS goes low first */
+	len = Mock_TwiLogLen;
+	LCD_ScrollLeft();
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen - len, 8);
+	LcdDec_Decode(LCD_Add);
+	TEST_EQUAL(LcdDec_Commands, commands + 1);
+	TEST_EQUAL(LcdDec_Command, LCD_SHIFT_LEFT);
+	len = Mock_TwiLogLen;
+	LCD_ScrollRight();
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen - len, 7);
+	LcdDec_Decode(LCD_Add);
+	TEST_EQUAL(LcdDec_Commands, commands + 2);
+	TEST_EQUAL(LcdDec_Command, LCD_SHIFT_RIGHT);
+}
+
+static void Test_Backlight(void)
+{
+	uint16_t len;
+
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LcdDec_Idle();
+	len = Mock_TwiLogLen;
+	LCD_Backlight(0);
+	LcdDec_Idle();
+	/* One write to the expander with BL low */
+	TEST_EQUAL(Mock_TwiLogLen - len, 4);
+	TEST_EQUAL(Mock_TwiLog[len + 2] & (1 << BL), 0);
+	/* The same state again is not written */
+	len = Mock_TwiLogLen;
+	LCD_Backlight(0);
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen, len);
+	LCD_Backlight(1);
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLog[len + 2] & (1 << BL), (1 << BL));
+}
+
+static void Test_Pattern(void)
+{
+	uint16_t len;
+	uint8_t on = 0;
+	uint8_t writes = 0;
+	uint8_t bl = 1;
+	uint8_t i;
+
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LcdDec_Idle();
+	/* 2 ticks on, 3 off: on at ticks 0, 1, 5, 6 and 10 */
+	LCD_BacklightPattern(2, 3);
+	for (i = 0; i < 11; i++)
+	{
+		len = Mock_TwiLogLen;
+		LCD_BacklightTick();
+		LcdDec_Idle();
+		if (Mock_TwiLogLen != len)
+		{
+			/* A change is one write of the expander */
+			TEST_EQUAL(Mock_TwiLogLen - len, 4);
+			TEST_EQUAL(Mock_TwiLog[len], MOCK_TWI_START);
+			TEST_EQUAL(Mock_TwiLog[len + 3], MOCK_TWI_STOP);
+			TEST_ASSERT((Mock_TwiLog[len + 2] & (1 << BL)) != (bl << BL));
+			bl = (Mock_TwiLog[len + 2] & (1 << BL)) ? 1 : 0;
+			writes++;
+		}
+		on += bl;
+	}
+	TEST_EQUAL(on, 5);
+	/* Off at 2, on at 5, off at 7, on at 10: no write on the other ticks */
+	TEST_EQUAL(writes, 4);
+	/* A char keeps the state of the pattern */
+	LCD_BacklightTick();
+	len = Mock_TwiLogLen;
+	LCD_Char('B');
+	LcdDec_Idle();
+	TEST_ASSERT(Test_Pins(len, (1 << BL), (1 << BL)));
+	/* LCD_Backlight() stops the pattern */
+	LCD_Backlight(0);
+	LcdDec_Idle();
+	len = Mock_TwiLogLen;
+	for (i = 0; i < 5; i++)
+		LCD_BacklightTick();
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen, len);
+}
+
+#if LCD_GPIO_MASK
+static void Test_SetPins(void)
+{
+	uint16_t len;
+
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LcdDec_Idle();
+	len = Mock_TwiLogLen;
+	LCD_SetPins(LCD_GPIO_MASK, LCD_GPIO_MASK);
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen - len, 4);
+	TEST_EQUAL(Mock_TwiLog[len + 2] & LCD_GPIO_MASK, LCD_GPIO_MASK);
+	/* No change: nothing sent. Pins out of the mask are ignored */
+	len = Mock_TwiLogLen;
+	LCD_SetPins(LCD_GPIO_MASK, LCD_GPIO_MASK);
+	LCD_SetPins(0xFF & ~LCD_GPIO_MASK, 0x00);
+	LcdDec_Idle();
+	TEST_EQUAL(Mock_TwiLogLen, len);
+	/* Commands, chars and the backlight keep the pins */
+	LCD_GotoXY(1, 0);
+	LCD_Char('P');
+	LCD_Backlight(0);
+	LCD_Backlight(1);
+	LcdDec_Idle();
+	TEST_ASSERT(Test_Pins(len, LCD_GPIO_MASK, LCD_GPIO_MASK));
+	len = Mock_TwiLogLen;
+	LCD_SetPins(LCD_GPIO_MASK, 0x00);
+	LCD_Char('Q');
+	LcdDec_Idle();
+	TEST_ASSERT(Test_Pins(len, LCD_GPIO_MASK, 0x00));
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "PQ ", 3);
+}
+#endif
+
+static void Test_Nack(void)
+{
+	I2C_Init();
+	sei();
+	/* No device at the address */
+	TEST_EQUAL(I2C_Start(I2C_ADD_WR(0x50)), TW_MT_SLA_NACK);
+	I2C_Stop();
+	TEST_EQUAL(Mock_TwiLog[1], I2C_ADD_WR(0x50) | MOCK_TWI_NACK);
+	Mock_TwiAddress = 0x50;
+	Mock_TwiNackData = 1;
+	TEST_EQUAL(I2C_Start(I2C_ADD_WR(0x50)), I2C_OK);
+	TEST_EQUAL(I2C_Transmit(0x12), TW_MT_DATA_NACK);
+	I2C_Stop();
+}
+
+static void Test_Registers(void)
+{
+	static const uint8_t device[] = { 0x11, 0x22, 0x33 };
+	static const uint8_t data[] = { 0xA0, 0xA1 };
+	uint8_t buf[3];
+
+	I2C_Init();
+	sei();
+	Mock_TwiAddress = 0x50;
+	TEST_EQUAL(I2C_WriteReg16(0x50, 0x0102, data, 2), I2C_OK);
+	LcdDec_Idle();
+	{
+		static const uint16_t bus[] = { MOCK_TWI_START, 0xA0, 0x01, 0x02, 0xA0, 0xA1, MOCK_TWI_STOP };
+		TEST_EQUAL(Mock_TwiLogLen, 7);
+		TEST_MEMORY(Mock_TwiLog, bus, sizeof(bus));
+	}
+	Mock_TwiLogLen = 0;
+	Mock_TwiData = device;
+	Mock_TwiDataLen = 3;
+	TEST_EQUAL(I2C_ReadReg(0x50, 0x07, buf, 3), I2C_OK);
+	TEST_MEMORY(buf, device, 3);
+	LcdDec_Idle();
+	{
+		/* Repeated Start, the last byte is not acknowledged */
+		static const uint16_t bus[] = { MOCK_TWI_START, 0xA0, 0x07, MOCK_TWI_START, 0xA1,
+										0x11, 0x22, 0x33 | MOCK_TWI_NACK, MOCK_TWI_STOP };
+		TEST_EQUAL(Mock_TwiLogLen, 9);
+		TEST_MEMORY(Mock_TwiLog, bus, sizeof(bus));
+	}
+}
+
+#if !I2C_SLEEP_WAIT && I2C_TIMEOUT
+static void Test_Timeout(void)
+{
+	I2C_Init();
+	/* The Start never finishes: given up after I2C_TIMEOUT polls */
+	Mock_TwiHang = 1;
+	TEST_EQUAL(I2C_Start(I2C_ADD_WR(LCD_Add)), TW_NO_INFO);
+	TEST_EQUAL(Mock_TwiLogLen, 0);
+	TEST_ASSERT(Mock_Ticks >= I2C_TIMEOUT);
+}
+#endif
+
+int main(void)
+{
+	TEST_RUN(Test_Init);
+	TEST_RUN(Test_String);
+	TEST_RUN(Test_Wrap);
+	TEST_RUN(Test_Geometry);
+	TEST_RUN(Test_Scroll);
+	TEST_RUN(Test_Backlight);
+	TEST_RUN(Test_Pattern);
+#if LCD_GPIO_MASK
+	TEST_RUN(Test_SetPins);
+#endif
+	TEST_RUN(Test_Nack);
+	TEST_RUN(Test_Registers);
+#if !I2C_SLEEP_WAIT && I2C_TIMEOUT
+	TEST_RUN(Test_Timeout);
+#endif
+	return TEST_END();
+}
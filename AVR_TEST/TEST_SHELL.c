@@ -0,0 +1,144 @@
+/*************************************************************************
+ Title	:   Host test of the UART shell library (AVR_SHELL)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Lines are typed through the USART model and the answer of the 
+       shell is read back from Mock_UartTx. Checks the line editing, the
+       search of the commands, the argument checks of "adc" and its 
+       behavior without a usable ADC, and the text of "lcd" on the 
+       HD44780 model (LCDDEC.c).
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "TEST.h"
+#include "LCDDEC.h"
+#include "../AVR_SHELL/SHELL.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+/* Answer of the shell to the last line */
+static char Test_Out[MOCK_UART_SIZE + 1];
+
+static uint8_t Test_Argc;
+
+static void Test_Args(uint8_t argc, char** argv)
+{
+	(void)argv;
+	Test_Argc = argc;
+	USART_putString_P(PSTR("args\r\n"));
+}
+
+static const command_SHELL Test_Table[] PROGMEM = 
+{
+	{ "args", Test_Args },
+};
+
+
+/* Type a line and collect the answer, with the prompt */
+static const char* Test_Line(const char* line)
+{
+	Mock_UartTxLen = 0;
+	Mock_UartInject((const uint8_t*)line, strlen(line));
+	while (Mock_UartPending() || USART_Available())
+	{
+		Mock_Run(Mock_UartRxPeriod);
+		Shell_Task();
+	}
+	Mock_Run(Mock_UartTxPeriod * 64);
+	memcpy(Test_Out, Mock_UartTx, Mock_UartTxLen);
+	Test_Out[Mock_UartTxLen] = 0;
+	return Test_Out;
+}
+
+#define TEST_LINE(line, answer) \
+	do { \
+		const char* out = Test_Line(line); \
+		if (strcmp(out, answer) != 0) \
+			printf("  answer: \"%s\"\n", out); \
+		TEST_ASSERT(strcmp(out, answer) == 0); \
+	} while (0)
+
+static void Test_Start(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	Shell_Init(Test_Table, 1);
+	Mock_Run(Mock_UartTxPeriod * 8);
+}
+
+
+static void Test_Commands(void)
+{
+	Test_Start();
+	TEST_MEMORY(Mock_UartTx, "> ", 2);
+	TEST_LINE("help\r", "help\r\nargs adc help lcd rgb \r\n> ");
+	TEST_LINE("args a  b\n", "args a  b\r\nargs\r\n> ");
+	TEST_EQUAL(Test_Argc, 3);
+	TEST_LINE("foo\r\n", "foo\r\nfoo: unknown command\r\n> ");
+	TEST_LINE("args 1 2 3 4\r", "args 1 2 3 4\r\ntoo many arguments\r\n> ");
+	/* Backspace */
+	TEST_LINE("hx\belp\r", "hx\b \belp\r\nargs adc help lcd rgb \r\n> ");
+}
+
+static void Test_AdcArguments(void)
+{
+	Test_Start();
+	ADC_Init();
+	TEST_LINE("adc\r", "adc\r\nusage: adc <channel>\r\n> ");
+	TEST_LINE("adc abc\r", "adc abc\r\ninvalid channel\r\n> ");
+	TEST_LINE("adc 3x\r", "adc 3x\r\ninvalid channel\r\n> ");
+	TEST_LINE("adc 9\r", "adc 9\r\ninvalid channel\r\n> ");
+	TEST_LINE("adc 259\r", "adc 259\r\ninvalid channel\r\n> ");
+	TEST_EQUAL(Mock_AdcConversions, 0);
+}
+
+static void Test_Adc(void)
+{
+	Mock_AdcValue[3] = 0x155;
+	Test_Start();
+	ADC_Init();
+#if ADC_MODE == EIGHTBIT
+	TEST_LINE("adc 3\r", "adc 3\r\n85\r\n> ");
+#else
+	TEST_LINE("adc 3\r", "adc 3\r\n341\r\n> ");
+#endif
+	/* The channel of the application is back */
+	TEST_EQUAL(ADC_GetChannel(), ADC_CHANNEL);
+	TEST_EQUAL(Mock_AdcConversions, 1);
+}
+
+static void Test_AdcNotReady(void)
+{
+	/* ADC_Init() not called: ADEN is 0 */
+	Test_Start();
+	TEST_LINE("adc 3\r", "adc 3\r\nadc not ready\r\n> ");
+	TEST_EQUAL(Mock_AdcConversions, 0);
+}
+
+static void Test_Lcd(void)
+{
+	Test_Start();
+	I2C_Init();
+	LCD_Init();
+	/* 19 chars: the separator counts in the column, the row wraps at 16 */
+	TEST_LINE("lcd 0123456789 abcdefgh\r", "lcd 0123456789 abcdefgh\r\n> ");
+	LcdDec_Decode(LCD_Add);
+	TEST_MEMORY(&LcdDec_Ddram[0x00], "0123456789 abcde", 16);
+	TEST_MEMORY(&LcdDec_Ddram[0x40], "fgh ", 4);
+	TEST_EQUAL(LcdDec_Ddram[0x10], ' ');
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Commands);
+	TEST_RUN(Test_AdcArguments);
+	TEST_RUN(Test_Adc);
+	TEST_RUN(Test_AdcNotReady);
+	TEST_RUN(Test_Lcd);
+	return TEST_END();
+}
@@ -0,0 +1,155 @@
+/*************************************************************************
+ Title	:   Host test of the sleep waits (AVR_UART, AVR_ADC, AVR_I2C)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The functions that wait for an ISR sleep in Idle mode only if the 
+       caller had the interrupts enabled, and give SREG back as it was.
+       Checked for USART_Receive(), ADC_GetValue() and the I2C functions.
+
+       The last tests measure the waits: how many times the CPU woke up 
+       and the share of the ticks it was asleep. The model counts register
+       accesses, not cycles, so the share is only relative. On a board, the
+       saving is that share of the waiting time multiplied by the active
+       minus the Idle supply current of the datasheet, at the same F_CPU 
+       and VCC (e.g. measured with a shunt on VCC).
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_ADC/ADC.h"
+#include "../AVR_LCDI2C/LCDI2C.h"
+
+#define TEST_I		(SREG & (1 << SREG_I))
+
+
+static void Test_UartKeepsI(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	Mock_UartInject((const uint8_t*)"xy", 2);
+	Mock_Run(3 * Mock_UartRxPeriod);
+	/* Data already there: returned with the interrupts still disabled */
+	cli();
+	TEST_EQUAL(USART_Receive(), 'x');
+	TEST_EQUAL(USART_Receive(), 'y');
+	TEST_EQUAL(TEST_I, 0);
+	TEST_EQUAL(Mock_Sleeps, 0);
+	/* Enabled: it sleeps and they stay enabled */
+	sei();
+	Mock_UartInject((const uint8_t*)"z", 1);
+	TEST_EQUAL(USART_Receive(), 'z');
+	TEST_EQUAL(TEST_I, (1 << SREG_I));
+	TEST_ASSERT(Mock_Sleeps > 0);
+}
+
+static void Test_AdcKeepsI(void)
+{
+	Mock_AdcValue[ADC_CHANNEL] = 300;
+	ADC_Init();
+	sei();
+	ADC_Start();
+	Mock_Run(2 * Mock_AdcPeriod);
+	cli();
+	TEST_EQUAL(ADC_GetValue(), 300);
+	TEST_EQUAL(TEST_I, 0);
+	TEST_EQUAL(Mock_Sleeps, 0);
+	sei();
+	ADC_Start();
+	TEST_EQUAL(ADC_GetValue(), 300);
+	TEST_EQUAL(TEST_I, (1 << SREG_I));
+	TEST_ASSERT(Mock_Sleeps > 0);
+}
+
+static void Test_I2cKeepsI(void)
+{
+	uint16_t i;
+	uint16_t stops = 0;
+
+	/* Interrupts disabled: TWINT is polled */
+	I2C_Init();
+	LCD_Init();
+	Mock_Run(Mock_TwiPeriod + 1);
+	for (i = 0; i < Mock_TwiLogLen; i++)
+		stops += (Mock_TwiLog[i] == MOCK_TWI_STOP);
+	TEST_EQUAL(stops, 5);
+	TEST_EQUAL(TEST_I, 0);
+	TEST_EQUAL(Mock_Sleeps, 0);
+	sei();
+	LCD_String("Hi");
+	TEST_EQUAL(TEST_I, (1 << SREG_I));
+	TEST_ASSERT(Mock_Sleeps > 0);
+}
+
+/*************************************************************************
+Print the wake-ups and the share of the ticks in sleep since the start.
+*************************************************************************/
+static unsigned Test_Report(const char* what, unsigned items)
+{
+	unsigned share = (unsigned)((100ULL * Mock_SleepTicks) / Mock_Ticks);
+
+	printf("  %s: %u items, %lu ticks, %lu wake-ups, %u%% of the ticks asleep\n",
+		   what, items, (unsigned long)Mock_Ticks, (unsigned long)Mock_Sleeps, share);
+	return share;
+}
+
+static void Test_MeasureUart(void)
+{
+	uint8_t data[64];
+	uint8_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i;
+	/* A slow sender: 200 ticks per byte */
+	Mock_UartRxPeriod = 200;
+	USART_Init(MYUBRR);
+	sei();
+	Mock_UartInject(data, sizeof(data));
+	for (i = 0; i < sizeof(data); i++)
+		TEST_EQUAL(USART_Receive(), data[i]);
+	/* One wake-up per byte, asleep most of the time */
+	TEST_EQUAL(Mock_Sleeps, sizeof(data));
+	TEST_ASSERT(Test_Report("USART_Receive", sizeof(data)) >= 90);
+}
+
+static void Test_MeasureAdc(void)
+{
+	uint8_t i;
+
+	Mock_AdcPeriod = 100;
+	ADC_Init();
+	sei();
+	ADC_StartAuto();
+	for (i = 0; i < 64; i++)
+		ADC_GetValue();
+	ADC_Stop();
+	TEST_ASSERT(Mock_Sleeps >= 64);
+	TEST_ASSERT(Test_Report("ADC_GetValue", 64) >= 80);
+}
+
+static void Test_MeasureI2c(void)
+{
+	/* A byte on the bus is much longer than the code between them */
+	Mock_TwiPeriod = 100;
+	I2C_Init();
+	sei();
+	LCD_Init();
+	LCD_String("Hello");
+	/* Each I2C operation is one sleep */
+	TEST_ASSERT(Mock_Sleeps > 0);
+	TEST_ASSERT(Test_Report("LCD_Init + LCD_String", 5) >= 75);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_UartKeepsI);
+	TEST_RUN(Test_AdcKeepsI);
+	TEST_RUN(Test_I2cKeepsI);
+	TEST_RUN(Test_MeasureUart);
+	TEST_RUN(Test_MeasureAdc);
+	TEST_RUN(Test_MeasureI2c);
+	return TEST_END();
+}
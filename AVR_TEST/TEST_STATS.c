@@ -0,0 +1,76 @@
+/*************************************************************************
+ Title	:   Host test of the Stats library (AVR_STATS)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs STATS.c with STATS_ENABLE on the model: Timer1 of Stats_Init(),
+       Stats_Clear() and the line sent by Stats_Dump(), with the names
+       read from flash.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_STATS/STATS.h"
+
+
+static void Test_Init(void)
+{
+	Stats_Counter[STATS_ADC_DROP] = 7;
+	Stats_IsrMax[STATS_ISR_TWI] = 9;
+	Stats_Init();
+	TEST_EQUAL(TCCR1A, 0);
+	TEST_EQUAL(TCCR1B, (1 << CS10));
+	TEST_EQUAL(Stats_Counter[STATS_ADC_DROP], 0);
+	TEST_EQUAL(Stats_IsrMax[STATS_ISR_TWI], 0);
+}
+
+static void Test_Saturate(void)
+{
+	Stats_Clear();
+	Stats_Counter[STATS_I2C_NACK] = 0xFFFE;
+	STATS_INC(STATS_I2C_NACK);
+	STATS_INC(STATS_I2C_NACK);
+	TEST_EQUAL(Stats_Counter[STATS_I2C_NACK], 0xFFFF);
+}
+
+static void Test_Dump(void)
+{
+	static const char counters[] = 
+		"RX_OVR=1 TX_FULL=0 ADC_DROP=300 I2C_NACK=0 I2C_TOUT=0 SW_OVR=0 SW_FRAME=65535 ";
+	static const char* const isrs[] = 
+		{ "ISR_RX=", "ISR_UDRE=", "ISR_ADC=", "ISR_TWI=", "ISR_SWRX=", "ISR_SWTX=" };
+	uint8_t i;
+	char line[MOCK_UART_SIZE + 1];
+
+	USART_Init(MYUBRR);
+	Stats_Init();
+	sei();
+	Stats_Counter[STATS_UART_RX_OVERRUN] = 1;
+	Stats_Counter[STATS_ADC_DROP] = 300;
+	Stats_Counter[STATS_SWUART_FRAME] = 0xFFFF;
+	Stats_Dump();
+	Mock_Run(4000);
+	memcpy(line, Mock_UartTx, Mock_UartTxLen);
+	line[Mock_UartTxLen] = 0;
+	printf("  %s", line);
+
+	/* The counters are fixed, the ISR maximums depend on the model */
+	TEST_MEMORY(line, counters, sizeof(counters) - 1);
+	for (i = 0; i < STATS_ISRS; i++)
+		TEST_ASSERT(strstr(line, isrs[i]) != NULL);
+	TEST_MEMORY(line + Mock_UartTxLen - 3, " \r\n", 3);
+	/* Dump sent bytes with the UDRE ISR, so its probe has a value */
+	TEST_ASSERT(Stats_IsrMax[STATS_ISR_UART_UDRE] > 0);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Init);
+	TEST_RUN(Test_Saturate);
+	TEST_RUN(Test_Dump);
+	return TEST_END();
+}
@@ -0,0 +1,281 @@
+/*************************************************************************
+ Title	:   Host test of the Software UART library (AVR_SWUART)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Timer2 and the pin change interrupt are not in the model: the test
+       is the line and the timer. It sets the level of RX in PINB and 
+       runs the ISRs of each bit with Mock_Interrupt(), then reads the TX
+       pin from PORTB after each bit. Checks the frames, the schedule of
+       OCR2A/OCR2B in 8.8 ticks, a glitch instead of a start bit and a 
+       low stop bit, counted by the Stats library.
+
+       Test_Timing sends a stream of frames and compares each TX edge, at
+       the compare match of Timer2, with the ideal time of its bit from 
+       the start edge of the frame. It prints the worst error in % of a 
+       bit at SWUART_BAUD_RATE and the register accesses (ticks of the 
+       model) of each ISR, the STATS probe included. The cycles of the 
+       ISRs on the AVR are measured by bench_sim.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TEST.h"
+#include "../AVR_SWUART/SWUART.h"
+#include "../AVR_STATS/STATS.h"
+
+#define TEST_PINB			0x23
+#define TEST_TCNT2			0xB2
+
+#define TEST_FRAME_BITS		10
+#define TEST_STREAM			64			// Frames of Test_Timing
+
+/* Vectors of SWUART.c, the model does not run them */
+void SWUART_PCINT_vect(void);
+void TIMER2_COMPA_vect(void);
+void TIMER2_COMPB_vect(void);
+
+/* Most ticks of the model in each ISR */
+enum { TEST_ISR_PCINT, TEST_ISR_COMPA, TEST_ISR_COMPB, TEST_ISRS };
+static uint32_t Test_IsrTicks[TEST_ISRS];
+
+static void Test_Isr(uint8_t isr, vector_MOCK vector)
+{
+	uint32_t ticks = Mock_Ticks;
+
+	Mock_Interrupt(vector);
+	if (Mock_Ticks - ticks > Test_IsrTicks[isr])
+		Test_IsrTicks[isr] = Mock_Ticks - ticks;
+}
+
+static void Test_Rx(uint8_t level)
+{
+	if (level)
+		Mock_Io[TEST_PINB] |= (1 << SWUART_RX_BIT);
+	else
+		Mock_Io[TEST_PINB] &= ~(1 << SWUART_RX_BIT);
+}
+
+/* Levels of a frame: start, 8 data bits LSB first, stop */
+static void Test_Frame(uint8_t data, uint8_t start, uint8_t stop, uint8_t* levels)
+{
+	uint8_t i;
+
+	levels[0] = start;
+	for (i = 0; i < 8; i++)
+		levels[i + 1] = (data >> i) & 1;
+	levels[9] = stop;
+}
+
+/* Falling edge at TCNT2 = stamp, then one sample per bit. Returns the 
+   number of samples run before the pin change was enabled again. */
+static uint8_t Test_Receive(uint8_t stamp, const uint8_t* levels)
+{
+	uint16_t time;
+	uint8_t i;
+
+	Mock_Io[TEST_TCNT2] = stamp;
+	Test_Rx(0);
+	Test_Isr(TEST_ISR_PCINT, SWUART_PCINT_vect);
+	TEST_EQUAL(SWUART_PCMSK & (1 << SWUART_RX_BIT), 0);
+	TEST_ASSERT(TIMSK2 & (1 << OCIE2A));
+
+	/* Middle of the start bit, with the latency of the pin change ISR */
+	time = ((uint16_t)(uint8_t)(stamp - SWUART_RX_LATENCY / SWUART_PRESC) << 8) + SWUART_PERIOD / 2;
+	TEST_EQUAL(OCR2A, time >> 8);
+
+	for (i = 0; i < TEST_FRAME_BITS; i++)
+	{
+		Test_Rx(levels[i]);
+		Test_Isr(TEST_ISR_COMPA, TIMER2_COMPA_vect);
+		time += SWUART_PERIOD;
+		TEST_EQUAL(OCR2A, time >> 8);
+		if (SWUART_PCMSK & (1 << SWUART_RX_BIT))
+			break;
+	}
+	/* Idle line until the next frame */
+	Test_Rx(1);
+	TEST_EQUAL(TIMSK2 & (1 << OCIE2A), 0);
+	return i + 1;
+}
+
+static void Test_Init(void)
+{
+	SWUART_Init();
+	TEST_EQUAL(TCCR2B, (SWUART_CS << CS20));
+	TEST_ASSERT(SWUART_TX_PORT & (1 << SWUART_TX_BIT));
+	TEST_ASSERT(SWUART_TX_DDR & (1 << SWUART_TX_BIT));
+	TEST_ASSERT(SWUART_PCMSK & (1 << SWUART_RX_BIT));
+	TEST_ASSERT(PCICR & (1 << SWUART_PCIE));
+	TEST_EQUAL(TIMSK2 & ((1 << OCIE2A) | (1 << OCIE2B)), 0);
+}
+
+static void Test_Frames(void)
+{
+	static const uint8_t data[] = { 0x55, 0xA3, 0x00, 0xFF };
+	uint8_t levels[TEST_FRAME_BITS];
+	uint8_t i;
+
+	SWUART_Init();
+	Stats_Init();
+	for (i = 0; i < sizeof(data); i++)
+	{
+		Test_Frame(data[i], 0, 1, levels);
+		/* The stamps wrap around 255 */
+		TEST_EQUAL(Test_Receive(250 + i * 3, levels), TEST_FRAME_BITS);
+	}
+	TEST_EQUAL(SWUART_Available(), sizeof(data));
+	for (i = 0; i < sizeof(data); i++)
+		TEST_EQUAL(SWUART_Receive(), data[i]);
+	TEST_EQUAL(Stats_Counter[STATS_SWUART_FRAME], 0);
+}
+
+static void Test_BadStart(void)
+{
+	uint8_t levels[TEST_FRAME_BITS];
+
+	SWUART_Init();
+	Stats_Init();
+
+	/* A rising edge does not start a frame */
+	Test_Rx(1);
+	Test_Isr(TEST_ISR_PCINT, SWUART_PCINT_vect);
+	TEST_ASSERT(SWUART_PCMSK & (1 << SWUART_RX_BIT));
+	TEST_EQUAL(TIMSK2 & (1 << OCIE2A), 0);
+
+	/* A glitch: high again in the middle of the start bit */
+	Test_Frame(0x00, 1, 1, levels);
+	TEST_EQUAL(Test_Receive(10, levels), 1);
+	TEST_EQUAL(SWUART_Available(), 0);
+
+	/* The next frame is received */
+	Test_Frame('k', 0, 1, levels);
+	TEST_EQUAL(Test_Receive(40, levels), TEST_FRAME_BITS);
+	TEST_EQUAL(SWUART_Available(), 1);
+	TEST_EQUAL(SWUART_Receive(), 'k');
+	TEST_EQUAL(Stats_Counter[STATS_SWUART_FRAME], 0);
+}
+
+static void Test_BadStop(void)
+{
+	uint8_t levels[TEST_FRAME_BITS];
+
+	SWUART_Init();
+	Stats_Init();
+	Test_Frame(0x3C, 0, 0, levels);
+	TEST_EQUAL(Test_Receive(0, levels), TEST_FRAME_BITS);
+	TEST_EQUAL(SWUART_Available(), 0);
+	TEST_EQUAL(Stats_Counter[STATS_SWUART_FRAME], 1);
+
+	Test_Frame(0x3C, 0, 1, levels);
+	TEST_EQUAL(Test_Receive(100, levels), TEST_FRAME_BITS);
+	TEST_EQUAL(SWUART_Receive(), 0x3C);
+}
+
+static void Test_Transmit(void)
+{
+	static const uint8_t data[] = { 0x96, 0x01 };
+	uint8_t levels[TEST_FRAME_BITS];
+	uint16_t time;
+	uint8_t i;
+	uint8_t j;
+
+	SWUART_Init();
+	Mock_Io[TEST_TCNT2] = 253;
+	for (i = 0; i < sizeof(data); i++)
+		SWUART_Transmit(data[i]);
+
+	/* The start bit of an idle line is 4 ticks away */
+	TEST_ASSERT(TIMSK2 & (1 << OCIE2B));
+	time = (uint16_t)(uint8_t)(253 + 4) << 8;
+	TEST_EQUAL(OCR2B, time >> 8);
+
+	/* The frames are back to back, one edge per bit */
+	for (i = 0; i < sizeof(data); i++)
+	{
+		Test_Frame(data[i], 0, 1, levels);
+		for (j = 0; j < TEST_FRAME_BITS; j++)
+		{
+			Test_Isr(TEST_ISR_COMPB, TIMER2_COMPB_vect);
+			TEST_EQUAL((SWUART_TX_PORT >> SWUART_TX_BIT) & 1, levels[j]);
+			time += SWUART_PERIOD;
+			TEST_EQUAL(OCR2B, time >> 8);
+		}
+	}
+
+	/* End of the stop bit: nothing left, the line stays high */
+	Test_Isr(TEST_ISR_COMPB, TIMER2_COMPB_vect);
+	TEST_EQUAL(TIMSK2 & (1 << OCIE2B), 0);
+	TEST_ASSERT(SWUART_TX_PORT & (1 << SWUART_TX_BIT));
+}
+
+static void Test_Timing(void)
+{
+	const double bit = (double)F_CPU / SWUART_PRESC / SWUART_BAUD_RATE;
+	double error;
+	double worst = 0;
+	uint32_t time = 0;
+	uint32_t start = 0;
+	uint8_t ocr;
+	uint16_t frames = 0;
+	uint16_t edges = 0;
+	uint8_t j = 0;
+
+	SWUART_Init();
+	Stats_Init();
+	Mock_Io[TEST_TCNT2] = 200;
+	/* The ring holds SWUART_TX_BUFFER_SIZE - 1 frames */
+	while (frames < SWUART_TX_BUFFER_SIZE - 1)
+		SWUART_Transmit((uint8_t)(0x35 + frames++));
+
+	ocr = Mock_Io[TEST_TCNT2];
+	while (TIMSK2 & (1 << OCIE2B))
+	{
+		/* Timer2 runs to the next match, less than 256 ticks */
+		time += (uint8_t)(OCR2B - ocr) ? (uint8_t)(OCR2B - ocr) : 256;
+		ocr = OCR2B;
+		Mock_Io[TEST_TCNT2] = ocr;
+		Test_Isr(TEST_ISR_COMPB, TIMER2_COMPB_vect);
+		if (!(TIMSK2 & (1 << OCIE2B)))
+			break;
+
+		/* Bit j of the frame starts at this edge */
+		if (j == 0)
+			start = time;
+		error = ((double)(time - start) - j * bit) * 100.0 / bit;
+		if (error < 0)
+			error = -error;
+		if (error > worst)
+			worst = error;
+		edges++;
+		if (++j == TEST_FRAME_BITS)
+			j = 0;
+
+		/* The start bit freed a byte of the ring: the stream goes on */
+		if (j == 1 && frames < TEST_STREAM)
+			SWUART_Transmit((uint8_t)(0x35 + frames++));
+	}
+	TEST_EQUAL(edges, TEST_STREAM * TEST_FRAME_BITS);
+	/* The 8.8 period keeps every edge within one tick of Timer2 */
+	TEST_ASSERT(worst < 100.0 / bit);
+
+	printf("  SWUART %lu baud, prescaler %u, %.3f ticks per bit, %u/256 (%+.3f%%)\n",
+		   (unsigned long)SWUART_BAUD_RATE, SWUART_PRESC, bit, (unsigned)SWUART_PERIOD,
+		   (SWUART_PERIOD / 256.0 - bit) * 100.0 / bit);
+	printf("  TX edges: %u, worst error %.2f%% of a bit\n", edges, worst);
+	printf("  Ticks per ISR: PCINT %lu, COMPA %lu, COMPB %lu\n",
+		   (unsigned long)Test_IsrTicks[TEST_ISR_PCINT], (unsigned long)Test_IsrTicks[TEST_ISR_COMPA],
+		   (unsigned long)Test_IsrTicks[TEST_ISR_COMPB]);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Init);
+	TEST_RUN(Test_Frames);
+	TEST_RUN(Test_BadStart);
+	TEST_RUN(Test_BadStop);
+	TEST_RUN(Test_Transmit);
+	TEST_RUN(Test_Timing);
+	return TEST_END();
+}
@@ -0,0 +1,190 @@
+/*************************************************************************
+ Title	:   Host test of the Trace library (AVR_TRACE)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs TRACE.c with TRACE_ENABLE on the model: the records dropped 
+       by a full ring, the lines of Trace_Dump() and the events pushed 
+       while it runs, which are kept or counted and never lost silently.
+       The WRAP records of the Timer1 overflows make the deltas exact.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdio.h>
+#include <string.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+#include "../AVR_TRACE/TRACE.h"
+
+#define TEST_PUSHED			(TRACE_SIZE + 4)
+
+static uint8_t Test_Records(void)
+{
+	return (uint8_t)((Trace_Head - Trace_Tail) & TRACE_MASK);
+}
+
+static void Test_Full(void)
+{
+	uint8_t i;
+
+	Trace_Init();
+	TEST_EQUAL(TCCR1B, (TRACE_CLOCK << CS10));
+	for (i = 0; i < TEST_PUSHED; i++)
+		TRACE(TRACE_USER + i, i);
+	/* One slot of the ring is always empty */
+	TEST_EQUAL(Test_Records(), TRACE_SIZE - 1);
+	TEST_EQUAL(Trace_Lost, TEST_PUSHED - (TRACE_SIZE - 1));
+
+	/* The oldest records are kept */
+	TEST_EQUAL(Trace_Buffer[(Trace_Tail + 1) & TRACE_MASK].arg, 0);
+	TEST_EQUAL(Trace_Buffer[Trace_Head].arg, TRACE_SIZE - 2);
+
+	Trace_Enable(0);
+	TRACE(TRACE_USER, 0);
+	TEST_EQUAL(Trace_Lost, TEST_PUSHED - (TRACE_SIZE - 1));
+	Trace_Enable(1);
+}
+
+static void Test_Dump(void)
+{
+	static const char first[] = " +0 EVT";
+	static const char lost[] = "LOST=5\r\n";
+	char text[MOCK_UART_SIZE + 1];
+	uint8_t i;
+
+	USART_Init(MYUBRR);
+	sei();
+	Mock_UartTxLen = 0;
+	Trace_Dump();
+	TEST_EQUAL(Test_Records(), 0);
+	TEST_EQUAL(Trace_Lost, 0);
+
+	Mock_Run(20000);
+	memcpy(text, Mock_UartTx, Mock_UartTxLen);
+	text[Mock_UartTxLen] = 0;
+	TEST_ASSERT(strstr(text, first) != NULL);
+	TEST_MEMORY(text + Mock_UartTxLen - (sizeof(lost) - 1), lost, sizeof(lost) - 1);
+
+	/* One line per record and the LOST line */
+	for (i = 0; text[0] != 0; i++)
+	{
+		char* end = strstr(text, "\r\n");
+		TEST_ASSERT(end != NULL);
+		memmove(text, end + 2, strlen(end + 2) + 1);
+	}
+	TEST_EQUAL(i, TRACE_SIZE);
+}
+
+static void Test_During(void)
+{
+	static const uint8_t rx[] = "abc";
+	uint8_t i;
+	uint8_t tmptail;
+
+	/* Drop the UDRE events of the previous test */
+	Trace_Init();
+	USART_Init(MYUBRR);
+	sei();
+	TRACE(TRACE_USER, 1);
+	TRACE(TRACE_USER, 2);
+
+	/* The bytes arrive while the records are sent */
+	Mock_UartInject(rx, sizeof(rx) - 1);
+	Trace_Dump();
+
+	/* Only the RX events of the dump are in the ring, no UDRE */
+	TEST_EQUAL(Test_Records(), sizeof(rx) - 1);
+	tmptail = Trace_Tail;
+	for (i = 0; i < sizeof(rx) - 1; i++)
+	{
+		tmptail = (tmptail + 1) & TRACE_MASK;
+		TEST_EQUAL(Trace_Buffer[tmptail].id, TRACE_UART_RX);
+		TEST_EQUAL(Trace_Buffer[tmptail].arg, rx[i]);
+	}
+	TEST_EQUAL(Trace_Lost, 0);
+	TEST_EQUAL(Trace_On, 1);
+	Mock_Run(20000);
+}
+
+/* Record n from the tail */
+static record_TRACE* Test_Record(uint8_t n)
+{
+	return &Trace_Buffer[(Trace_Tail + n) & TRACE_MASK];
+}
+
+/* Delta of the line of an EVT<id> in the dump */
+static unsigned long Test_Delta(const char* text, uint8_t id)
+{
+	char name[12];
+	unsigned long delta;
+	const char* line;
+
+	sprintf(name, " EVT%u ", id);
+	line = strstr(text, name);
+	TEST_ASSERT(line != NULL);
+	if (line == NULL)
+		return 0;
+	while (line > text && line[-1] != '\n')
+		line--;
+	TEST_EQUAL(sscanf(line, "%*u +%lu", &delta), 1);
+	return delta;
+}
+
+static void Test_Wrap(void)
+{
+	char text[MOCK_UART_SIZE + 1];
+	uint32_t ticks[3];
+	unsigned long delta;
+
+	Trace_Init();
+	TEST_EQUAL(TIMSK1 & (1 << TOIE1), (1 << TOIE1));
+	USART_Init(MYUBRR);
+	sei();
+	TRACE(TRACE_USER, 0);
+	ticks[0] = Mock_Ticks;
+	/* Two overflows served by the ISR */
+	Mock_Run(2 * 65536UL + 1000);
+	TRACE(TRACE_USER + 1, 1);
+	ticks[1] = Mock_Ticks;
+	TEST_EQUAL(Test_Records(), 3);
+	TEST_EQUAL(Test_Record(2)->id, TRACE_WRAP);
+	TEST_EQUAL(Test_Record(2)->arg, 2);
+	TEST_EQUAL(Test_Record(2)->stamp, Test_Record(3)->stamp);
+	TEST_EQUAL(Trace_Wraps, 0);
+
+	/* An overflow with the interrupts disabled is counted by the push */
+	cli();
+	Mock_Run(65536UL);
+	TRACE(TRACE_USER + 2, 2);
+	ticks[2] = Mock_Ticks;
+	sei();
+	Mock_Run(100);
+	TEST_EQUAL(Test_Records(), 5);
+	TEST_EQUAL(Test_Record(4)->id, TRACE_WRAP);
+	TEST_EQUAL(Test_Record(4)->arg, 1);
+	TEST_EQUAL(Trace_Wraps, 0);
+
+	/* The deltas of the dump are the ticks between the stamps */
+	Mock_UartTxLen = 0;
+	Trace_Dump();
+	Mock_Run(20000);
+	memcpy(text, Mock_UartTx, Mock_UartTxLen);
+	text[Mock_UartTxLen] = 0;
+	TEST_ASSERT(strstr(text, "WRAP") == NULL);
+	TEST_EQUAL(Test_Delta(text, TRACE_USER), 0);
+	delta = Test_Delta(text, TRACE_USER + 1);
+	TEST_ASSERT(delta + 8 > ticks[1] - ticks[0] && delta < ticks[1] - ticks[0] + 8);
+	delta = Test_Delta(text, TRACE_USER + 2);
+	TEST_ASSERT(delta + 8 > ticks[2] - ticks[1] && delta < ticks[2] - ticks[1] + 8);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Full);
+	TEST_RUN(Test_Dump);
+	TEST_RUN(Test_During);
+	TEST_RUN(Test_Wrap);
+	return TEST_END();
+}
@@ -0,0 +1,142 @@
+/*************************************************************************
+ Title	:   Host test of the UART library (AVR_UART)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Runs UART.c on the model of USART0: registers of USART_Init(), 
+       bytes sent by the UDRE ISR, bytes received by the RX ISR and the 
+       behavior of both buffers when they are full. Built again at 57600
+       baud, where a truncated UBRR is not the nearest one.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdlib.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+
+
+static void Test_Init(void)
+{
+	USART_Init(MYUBRR);
+	TEST_EQUAL(UBRR0H, MYUBRR >> 8);
+	TEST_EQUAL(UBRR0L, MYUBRR & 0xFF);
+	TEST_EQUAL(UCSR0A & (1 << U2X0), (1 << U2X0));
+	TEST_EQUAL(UCSR0B, (1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0));
+	TEST_EQUAL(UCSR0C, (1 << UCSZ01) | (1 << UCSZ00));
+	TEST_EQUAL(USART_Available(), 0);
+}
+
+static void Test_Baud(void)
+{
+	long real = (long)(F_CPU / (8UL * (MYUBRR + 1)));
+	long lower = (long)(F_CPU / (8UL * (MYUBRR + 2)));
+	long upper = (long)(F_CPU / (8UL * MYUBRR));
+
+	/* MYUBRR is the divisor nearest to UART_BAUD_RATE */
+	printf("  %lu baud: UBRR %lu, %ld baud\n", (unsigned long)UART_BAUD_RATE, (unsigned long)MYUBRR, real);
+	TEST_ASSERT(labs(real - UART_BAUD_RATE) <= labs(lower - UART_BAUD_RATE));
+	TEST_ASSERT(labs(real - UART_BAUD_RATE) <= labs(upper - UART_BAUD_RATE));
+	TEST_EQUAL(UART_BAUD_REAL, real);
+}
+
+static void Test_Transmit(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	USART_putString("Hello");
+	Mock_Run(200);
+	TEST_EQUAL(Mock_UartTxLen, 5);
+	TEST_MEMORY(Mock_UartTx, "Hello", 5);
+	/* The UDRE ISR disables itself with the buffer empty */
+	TEST_EQUAL(UCSR0B & (1 << UDRIE0), 0);
+}
+
+static void Test_TransmitFull(void)
+{
+	const char* text = "0123456789abcdefghijklmnopqrstuv";
+
+	USART_Init(MYUBRR);
+	sei();
+	/* Four times the buffer: USART_Transmit() has to wait */
+	USART_putString((char*)text);
+	Mock_Run(500);
+	TEST_EQUAL(Mock_UartTxLen, 32);
+	TEST_MEMORY(Mock_UartTx, text, 32);
+	TEST_ASSERT(Mock_Sleeps > 0);
+}
+
+static void Test_TransmitBlock(void)
+{
+	static const uint8_t block[] = { 'X', 'Y', 'Z' };
+
+	USART_Init(MYUBRR);
+	sei();
+	TEST_EQUAL(USART_TransmitBlock(block, 3), 1);
+	/* Only one block at a time */
+	TEST_EQUAL(USART_TransmitBlock(block, 3), 0);
+	USART_Transmit('a');
+	TEST_ASSERT(USART_BlockBusy() > 0);
+	Mock_Run(200);
+	TEST_EQUAL(USART_BlockBusy(), 0);
+	TEST_EQUAL(Mock_UartTxLen, 4);
+	TEST_MEMORY(Mock_UartTx, "XYZa", 4);
+}
+
+static void Test_PutNumber(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	USART_putNumber(65535);
+	USART_putNumber(0);
+	Mock_Run(200);
+	TEST_EQUAL(Mock_UartTxLen, 6);
+	TEST_MEMORY(Mock_UartTx, "655350", 6);
+}
+
+static void Test_Receive(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	Mock_UartInject((const uint8_t*)"abc", 3);
+	/* Sleeps until the RX ISR stores each byte */
+	TEST_EQUAL(USART_Receive(), 'a');
+	TEST_EQUAL(USART_Receive(), 'b');
+	TEST_EQUAL(USART_Receive(), 'c');
+	TEST_EQUAL(USART_Available(), 0);
+	TEST_EQUAL(Mock_UartPending(), 0);
+	TEST_ASSERT(Mock_Sleeps >= 3);
+}
+
+static void Test_ReceiveFull(void)
+{
+	uint8_t data[USART_RX_BUFFER_SIZE + 4];
+	uint8_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 0x40 + i;
+	USART_Init(MYUBRR);
+	sei();
+	Mock_UartInject(data, sizeof(data));
+	Mock_Run(sizeof(data) * (Mock_UartRxPeriod + 1) + 10);
+	/* The ring keeps size - 1 bytes, the newest ones are dropped */
+	TEST_EQUAL(USART_Available(), USART_RX_BUFFER_SIZE - 1);
+	TEST_EQUAL(Mock_UartRxLost, 0);
+	for (i = 0; i < USART_RX_BUFFER_SIZE - 1; i++)
+		TEST_EQUAL(USART_Receive(), data[i]);
+	TEST_EQUAL(USART_Available(), 0);
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Init);
+	TEST_RUN(Test_Baud);
+	TEST_RUN(Test_Transmit);
+	TEST_RUN(Test_TransmitFull);
+	TEST_RUN(Test_TransmitBlock);
+	TEST_RUN(Test_PutNumber);
+	TEST_RUN(Test_Receive);
+	TEST_RUN(Test_ReceiveFull);
+	return TEST_END();
+}
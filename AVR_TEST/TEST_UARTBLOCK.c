@@ -0,0 +1,238 @@
+/*************************************************************************
+ Title	:   Host test of the block receive mode of the UART library
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The test is the sender of the protocol of USART_BlockStart(): it 
+       sends the frames through the USART model with a window, reads the
+       ACK/NAK replies from Mock_UartTx and resends. The receiver side 
+       is UART.c with USART_BlockPoll() and a writer that keeps the 
+       blocks. Checks the order, the CRC errors, the duplicated frames 
+       of a lost ACK and the end of the transfer.
+
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include <string.h>
+#include "TEST.h"
+#include "../AVR_UART/UART.h"
+
+#define TEST_SLOTS			4
+#define TEST_BLOCKS			12
+
+static uint8_t Test_Buffer[TEST_SLOTS * USART_BLOCK_SIZE];
+
+/* Blocks given to the writer */
+static uint8_t Test_Written[TEST_BLOCKS][USART_BLOCK_SIZE];
+static uint8_t Test_WrittenLen[TEST_BLOCKS];
+static uint8_t Test_Writes;
+static uint8_t Test_WrongSeq;
+
+/* Replies of the receiver already read from Mock_UartTx */
+static uint16_t Test_ReplyPos;
+
+
+static void Test_Writer(uint8_t seq, uint8_t* data, uint8_t len)
+{
+	if (seq != Test_Writes)
+		Test_WrongSeq++;
+	if (Test_Writes < TEST_BLOCKS)
+	{
+		memcpy(Test_Written[Test_Writes], data, len);
+		Test_WrittenLen[Test_Writes] = len;
+	}
+	Test_Writes++;
+}
+
+/* Length and data of each block, different for every seq */
+static uint8_t Test_Len(uint8_t seq)
+{
+	return 1 + (seq * 23) % USART_BLOCK_SIZE;
+}
+
+static uint8_t Test_Data(uint8_t seq, uint8_t i)
+{
+	return (uint8_t)(seq * 31 + i * 7);
+}
+
+/* Send one frame, with a wrong CRC if corrupt is set */
+static void Test_SendFrame(uint8_t seq, uint8_t corrupt)
+{
+	uint8_t frame[USART_BLOCK_SIZE + 5];
+	uint8_t len = Test_Len(seq);
+	uint16_t crc;
+	uint8_t i;
+
+	frame[0] = USART_SOH;
+	frame[1] = seq;
+	frame[2] = len;
+	crc = _crc_xmodem_update(0, seq);
+	crc = _crc_xmodem_update(crc, len);
+	for (i = 0; i < len; i++)
+	{
+		frame[3 + i] = Test_Data(seq, i);
+		crc = _crc_xmodem_update(crc, frame[3 + i]);
+	}
+	if (corrupt)
+		crc ^= 0x0100;
+	frame[3 + len] = crc >> 8;
+	frame[4 + len] = crc & 0xFF;
+	Mock_UartInject(frame, len + 5);
+}
+
+/* Let the model receive the pending bytes and send the replies */
+static void Test_Deliver(void)
+{
+	while (Mock_UartPending())
+		Mock_Run(Mock_UartRxPeriod);
+	Mock_Run(Mock_UartTxPeriod * 16);
+}
+
+/* Read the next reply pair, 0 if there is none */
+static uint8_t Test_Reply(uint8_t* type, uint8_t* seq)
+{
+	if (Mock_UartTxLen < Test_ReplyPos + 2)
+		return 0;
+	*type = Mock_UartTx[Test_ReplyPos];
+	*seq = Mock_UartTx[Test_ReplyPos + 1];
+	Test_ReplyPos += 2;
+	return 1;
+}
+
+static void Test_Start(void)
+{
+	USART_Init(MYUBRR);
+	sei();
+	memset(Test_Written, 0, sizeof(Test_Written));
+	Test_Writes = 0;
+	Test_WrongSeq = 0;
+	Test_ReplyPos = 0;
+	USART_BlockStart(Test_Buffer, TEST_SLOTS);
+}
+
+static void Test_CheckWritten(void)
+{
+	uint8_t seq;
+	uint8_t i;
+
+	TEST_EQUAL(Test_Writes, TEST_BLOCKS);
+	TEST_EQUAL(Test_WrongSeq, 0);
+	for (seq = 0; seq < TEST_BLOCKS; seq++)
+	{
+		TEST_EQUAL(Test_WrittenLen[seq], Test_Len(seq));
+		for (i = 0; i < Test_Len(seq); i++)
+			if (Test_Written[seq][i] != Test_Data(seq, i))
+				break;
+		TEST_EQUAL(i, Test_Len(seq));
+	}
+}
+
+/* Sliding window sender. Frame corrupt_seq is sent once with a wrong CRC
+   and frame dup_seq is sent again after its ACK, like after a lost ACK */
+static void Test_Transfer(uint8_t corrupt_seq, uint8_t dup_seq)
+{
+	uint8_t acked[TEST_BLOCKS] = { 0 };
+	uint8_t sent[TEST_BLOCKS] = { 0 };
+	uint8_t base = 0;
+	uint8_t next = 0;
+	uint8_t naks = 0;
+	uint8_t dups = 0;
+	uint8_t type, seq;
+	uint16_t rounds = 0;
+
+	while (base < TEST_BLOCKS && rounds++ < 200)
+	{
+		while (next < TEST_BLOCKS && next < base + TEST_SLOTS)
+		{
+			Test_SendFrame(next, next == corrupt_seq && !sent[next]);
+			sent[next] = 1;
+			next++;
+		}
+		Test_Deliver();
+		while (Test_Reply(&type, &seq))
+		{
+			TEST_ASSERT(seq < TEST_BLOCKS);
+			if (type == USART_ACK)
+			{
+				if (acked[seq])
+					dups++;
+				acked[seq] = 1;
+				if (seq == dup_seq && dups == 0)
+					Test_SendFrame(seq, 0);
+			} else
+			{
+				TEST_EQUAL(type, USART_NAK);
+				naks++;
+				Test_SendFrame(seq, 0);
+			}
+		}
+		while (base < TEST_BLOCKS && acked[base])
+			base++;
+		TEST_EQUAL(USART_BlockPoll(Test_Writer), USART_BLOCK_BUSY);
+	}
+	TEST_EQUAL(base, TEST_BLOCKS);
+	TEST_EQUAL(naks, corrupt_seq < TEST_BLOCKS ? 1 : 0);
+	TEST_EQUAL(dups, dup_seq < TEST_BLOCKS ? 1 : 0);
+
+	/* End of the transfer */
+	Mock_UartInject((const uint8_t*)"\x04", 1);
+	Test_Deliver();
+	TEST_ASSERT(Test_Reply(&type, &seq));
+	TEST_EQUAL(type, USART_ACK);
+	TEST_EQUAL(seq, USART_EOT);
+	TEST_EQUAL(USART_BlockPoll(Test_Writer), USART_BLOCK_DONE);
+}
+
+
+static void Test_Clean(void)
+{
+	Test_Start();
+	Test_Transfer(0xFF, 0xFF);
+	Test_CheckWritten();
+}
+
+static void Test_CrcError(void)
+{
+	Test_Start();
+	Test_Transfer(5, 0xFF);
+	Test_CheckWritten();
+}
+
+static void Test_Duplicate(void)
+{
+	Test_Start();
+	Test_Transfer(0xFF, 2);
+	/* The second copy is acknowledged, not written */
+	Test_CheckWritten();
+}
+
+static void Test_EndWithBlocks(void)
+{
+	uint8_t seq;
+
+	/* The last frames and the EOT arrive before any poll: the blocks
+	   stored before the EOT are written before DONE */
+	Test_Start();
+	for (seq = 0; seq < TEST_SLOTS; seq++)
+		Test_SendFrame(seq, 0);
+	Mock_UartInject((const uint8_t*)"\x04", 1);
+	Test_Deliver();
+	TEST_EQUAL(USART_BlockPoll(Test_Writer), USART_BLOCK_DONE);
+	TEST_EQUAL(Test_Writes, TEST_SLOTS);
+	TEST_EQUAL(Test_WrongSeq, 0);
+	/* Back to the RX Buffer */
+	Mock_UartInject((const uint8_t*)"ok", 2);
+	TEST_EQUAL(USART_Receive(), 'o');
+	TEST_EQUAL(USART_Receive(), 'k');
+}
+
+int main(void)
+{
+	TEST_RUN(Test_Clean);
+	TEST_RUN(Test_CrcError);
+	TEST_RUN(Test_Duplicate);
+	TEST_RUN(Test_EndWithBlocks);
+	return TEST_END();
+}
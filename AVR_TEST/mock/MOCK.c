@@ -0,0 +1,702 @@
+/*************************************************************************
+ Title	:   Host model of the ATmega328P (MOCK.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host)
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Registers, peripherals and interrupts used by the libraries, run
+       one tick per register access.
+
+       See the C include MOCK.h file for a description of the models.
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MOCK.h"
+#include "avr/io.h"
+#include "avr/sleep.h"
+
+/* Vectors of the libraries, NULL if the test does not link them */
+#define MOCK_VECTOR(name)	void name(void) __attribute__((weak))
+MOCK_VECTOR(USART_RX_vect);
+MOCK_VECTOR(USART_UDRE_vect);
+MOCK_VECTOR(ADC_vect);
+MOCK_VECTOR(TWI_vect);
+MOCK_VECTOR(TIMER1_OVF_vect);
+
+/* Marker of TWCR, kept set by the model: a plain write clears it */
+#define MOCK_TWCR_MARK		(1 << 1)
+/* Same for TIFR1, the flags are cleared by writing one */
+#define MOCK_TIFR1_MARK		(1 << 7)
+
+/* Registers without ticks, for the model itself */
+#define R_UCSR0A	Mock_Io[0xC0]
+#define R_UCSR0B	Mock_Io[0xC1]
+#define R_UDR0		Mock_Io[0xC6]
+#define R_ADCSRA	Mock_Io[0x7A]
+#define R_ADCSRB	Mock_Io[0x7B]
+#define R_ADMUX		Mock_Io[0x7C]
+#define R_TWSR		Mock_Io[0xB9]
+#define R_TWDR		Mock_Io[0xBB]
+#define R_TWCR		Mock_Io[0xBC]
+#define R_TCCR1B	Mock_Io[0x81]
+#define R_TIFR1		Mock_Io[0x36]
+#define R_TIMSK1	Mock_Io[0x6F]
+#define R_SMCR		Mock_Io[0x53]
+#define R_SREG		Mock_Io[0x5F]
+
+uint8_t Mock_Io[MOCK_IO_SIZE] __attribute__((aligned(2)));
+
+uint32_t Mock_Ticks;
+uint32_t Mock_SleepTicks;
+uint32_t Mock_Sleeps;
+uint32_t Mock_SleepLimit;
+uint32_t Mock_DelayUs;
+
+vector_MOCK Mock_Vector;
+uint32_t Mock_Interrupts;
+
+uint8_t (*Mock_Preempt)(void);
+uint32_t Mock_Preemptions;
+
+uint16_t Mock_UartRxPeriod;
+uint16_t Mock_UartTxPeriod;
+uint8_t Mock_UartTx[MOCK_UART_SIZE];
+uint16_t Mock_UartTxLen;
+uint16_t Mock_UartRxLost;
+
+uint16_t Mock_AdcPeriod;
+uint16_t Mock_AdcValue[16];
+uint16_t (*Mock_AdcSource)(uint8_t channel);
+uint32_t Mock_AdcConversions;
+
+uint8_t Mock_TwiAddress;
+uint8_t Mock_TwiNackData;
+uint8_t Mock_TwiHang;
+uint16_t Mock_TwiPeriod;
+const uint8_t* Mock_TwiData;
+uint16_t Mock_TwiDataLen;
+uint16_t Mock_TwiLog[MOCK_TWI_SIZE];
+uint16_t Mock_TwiLogLen;
+
+uint32_t Mock_EepromWrites;
+
+/* USART0 */
+static uint8_t Uart_RxQueue[MOCK_UART_SIZE];
+static uint16_t Uart_RxHead, Uart_RxTail;
+static uint16_t Uart_RxTimer, Uart_TxTimer;
+static uint8_t Uart_Rxc, Uart_Dor, Uart_Txc, Uart_RxData;
+static uint8_t Uart_TxPending;
+
+/* ADC */
+static uint8_t Adc_Busy, Adc_Flag, Adc_Channel;
+static uint16_t Adc_Timer;
+
+/* TWI */
+enum { TWI_IDLE, TWI_ADDRESS, TWI_WRITE, TWI_READ, TWI_NONE };
+enum { OP_NONE, OP_START, OP_STOP, OP_DATA };
+static uint8_t Twi_Flag, Twi_State, Twi_Op, Twi_OpTwcr, Twi_Status;
+static uint16_t Twi_Timer, Twi_DataIndex;
+
+/* Timer 1 */
+static uint8_t Tim1_Tov;
+
+
+/*************************************************************************
+Stop the test. The model can not go on.
+Input:    msg 	reason
+Returns:  does not return
+*************************************************************************/
+void Mock_Fail(const char* msg)
+{
+	fprintf(stderr, "MOCK: %s (tick %lu)\n", msg, (unsigned long)Mock_Ticks);
+	exit(2);
+}
+
+
+/*************************************************************************
+Default source of the ADC values.
+*************************************************************************/
+static uint16_t Mock_AdcDefault(uint8_t channel)
+{
+	return Mock_AdcValue[channel & 0x0F];
+}
+
+
+/*************************************************************************
+Reset the model, like the RESET pin. The EEPROM is kept.
+*************************************************************************/
+void Mock_Reset(void)
+{
+	memset(Mock_Io, 0, sizeof(Mock_Io));
+	R_UCSR0A = (1 << UDRE0);
+	R_TWSR = 0xF8;
+	R_TWCR = MOCK_TWCR_MARK;
+	R_TIFR1 = MOCK_TIFR1_MARK;
+
+	Mock_Ticks = 0;
+	Mock_SleepTicks = 0;
+	Mock_Sleeps = 0;
+	Mock_SleepLimit = 1000000UL;
+	Mock_DelayUs = 0;
+	Mock_Vector = NULL;
+	Mock_Interrupts = 0;
+	Mock_Preempt = NULL;
+	Mock_Preemptions = 0;
+
+	Mock_UartRxPeriod = 20;
+	Mock_UartTxPeriod = 10;
+	Mock_UartTxLen = 0;
+	Mock_UartRxLost = 0;
+	Uart_RxHead = Uart_RxTail = 0;
+	Uart_RxTimer = Uart_TxTimer = 0;
+	Uart_Rxc = Uart_Dor = Uart_Txc = Uart_RxData = 0;
+	Uart_TxPending = 0;
+
+	Mock_AdcPeriod = 25;
+	memset(Mock_AdcValue, 0, sizeof(Mock_AdcValue));
+	Mock_AdcSource = Mock_AdcDefault;
+	Mock_AdcConversions = 0;
+	Adc_Busy = Adc_Flag = Adc_Channel = 0;
+	Adc_Timer = 0;
+
+	Mock_TwiAddress = 0x27;
+	Mock_TwiNackData = 0;
+	Mock_TwiHang = 0;
+	Mock_TwiPeriod = 8;
+	Mock_TwiData = NULL;
+	Mock_TwiDataLen = 0;
+	Mock_TwiLogLen = 0;
+	Twi_Flag = 0;
+	Twi_State = TWI_IDLE;
+	Twi_Op = OP_NONE;
+	Twi_Status = 0xF8;
+	Twi_Timer = Twi_DataIndex = 0;
+
+	Tim1_Tov = 0;
+
+	Mock_EepromWrites = 0;
+}
+
+
+/*************************************************************************
+Log one event of the TWI bus.
+*************************************************************************/
+static void Mock_TwiLogEvent(uint16_t event)
+{
+	if (Mock_TwiLogLen < MOCK_TWI_SIZE)
+		Mock_TwiLog[Mock_TwiLogLen++] = event;
+}
+
+
+/*************************************************************************
+Start a conversion with the channel of ADMUX.
+*************************************************************************/
+static void Mock_AdcStart(void)
+{
+	Adc_Busy = 1;
+	Adc_Timer = 0;
+	Adc_Channel = R_ADMUX & 0x0F;
+}
+
+
+/*************************************************************************
+Apply the writes of the previous register access: UDR0, TWCR and ADCSRA.
+*************************************************************************/
+static void Mock_Commit(void)
+{
+	/* UDR0 written */
+	if (Uart_TxPending)
+	{
+		Uart_TxPending = 0;
+		if (!(R_UCSR0B & (1 << TXEN0)))
+			Mock_Fail("UDR0 written with the transmitter disabled");
+		if (Uart_TxTimer)
+			Mock_Fail("UDR0 written with UDRE0 cleared");
+		if (Mock_UartTxLen < MOCK_UART_SIZE)
+			Mock_UartTx[Mock_UartTxLen++] = R_UDR0;
+		Uart_TxTimer = Mock_UartTxPeriod ? Mock_UartTxPeriod : 1;
+		Uart_Txc = 0;
+	}
+
+	/* TWCR written: an operation starts if TWINT was written to one */
+	if (!(R_TWCR & MOCK_TWCR_MARK))
+	{
+		uint8_t twcr = R_TWCR;
+
+		if ((twcr & (1 << TWINT)) && (twcr & (1 << TWEN)))
+		{
+			Twi_Flag = 0;
+			Twi_Timer = 0;
+			Twi_OpTwcr = twcr;
+			if (twcr & (1 << TWSTA))
+				Twi_Op = OP_START;
+			else if (twcr & (1 << TWSTO))
+				Twi_Op = OP_STOP;
+			else
+				Twi_Op = OP_DATA;
+		}
+	}
+
+	/* TOV1 written to one */
+	if (!(R_TIFR1 & MOCK_TIFR1_MARK) && (R_TIFR1 & (1 << TOV1)))
+		Tim1_Tov = 0;
+
+	/* ADSC written to one */
+	if (!(R_ADCSRA & (1 << ADEN)))
+		Adc_Busy = 0;
+	else if ((R_ADCSRA & (1 << ADSC)) && !Adc_Busy)
+		Mock_AdcStart();
+}
+
+
+/*************************************************************************
+End of a TWI operation.
+*************************************************************************/
+static void Mock_TwiDone(void)
+{
+	uint8_t byte;
+	uint8_t ack;
+
+	switch (Twi_Op)
+	{
+		case OP_START:
+			Mock_TwiLogEvent(MOCK_TWI_START);
+			Twi_Status = (Twi_State == TWI_IDLE) ? 0x08 : 0x10;
+			Twi_State = TWI_ADDRESS;
+			Twi_Flag = 1;
+			break;
+
+		case OP_STOP:
+			Mock_TwiLogEvent(MOCK_TWI_STOP);
+			Twi_Status = 0xF8;
+			Twi_State = TWI_IDLE;
+			break;
+
+		case OP_DATA:
+			if (Twi_State == TWI_ADDRESS)
+			{
+				byte = R_TWDR;
+				ack = (byte >> 1) == Mock_TwiAddress;
+				if (byte & 1)
+					Twi_Status = ack ? 0x40 : 0x48;
+				else
+					Twi_Status = ack ? 0x18 : 0x20;
+				Twi_State = !ack ? TWI_NONE : (byte & 1) ? TWI_READ : TWI_WRITE;
+				Twi_DataIndex = 0;
+			}
+			else if (Twi_State == TWI_READ)
+			{
+				byte = (Twi_DataIndex < Mock_TwiDataLen) ? Mock_TwiData[Twi_DataIndex] : 0xFF;
+				Twi_DataIndex++;
+				R_TWDR = byte;
+				ack = (Twi_OpTwcr >> TWEA) & 1;
+				Twi_Status = ack ? 0x50 : 0x58;
+			}
+			else
+			{
+				byte = R_TWDR;
+				ack = (Twi_State == TWI_WRITE) && !Mock_TwiNackData;
+				Twi_Status = ack ? 0x28 : 0x30;
+			}
+			Mock_TwiLogEvent(byte | (ack ? 0 : MOCK_TWI_NACK));
+			Twi_Flag = 1;
+			break;
+	}
+	Twi_Op = OP_NONE;
+}
+
+
+/*************************************************************************
+One tick of the peripherals.
+*************************************************************************/
+static void Mock_Tick(void)
+{
+	uint16_t value;
+
+	Mock_Ticks++;
+
+	/* USART0 receiver */
+	if ((R_UCSR0B & (1 << RXEN0)) && Uart_RxHead != Uart_RxTail)
+	{
+		if (++Uart_RxTimer >= Mock_UartRxPeriod)
+		{
+			Uart_RxTimer = 0;
+			if (Uart_Rxc)
+			{
+				Uart_Dor = 1;
+				Mock_UartRxLost++;
+			}
+			else
+			{
+				Uart_RxData = Uart_RxQueue[Uart_RxTail];
+				Uart_Rxc = 1;
+			}
+			Uart_RxTail = (Uart_RxTail + 1) % MOCK_UART_SIZE;
+		}
+	}
+
+	/* USART0 transmitter */
+	if (Uart_TxTimer && --Uart_TxTimer == 0)
+		Uart_Txc = 1;
+
+	/* ADC */
+	if (Adc_Busy && ++Adc_Timer >= Mock_AdcPeriod)
+	{
+		value = Mock_AdcSource(Adc_Channel) & 0x3FF;
+		if (R_ADMUX & (1 << ADLAR))
+			value <<= 6;
+		Mock_Io[0x78] = (uint8_t)value;
+		Mock_Io[0x79] = (uint8_t)(value >> 8);
+		Mock_AdcConversions++;
+		Adc_Flag = 1;
+		Adc_Busy = 0;
+		/* Free Running restarts with the new MUX */
+		if ((R_ADCSRA & (1 << ADATE)) && (R_ADCSRB & 0x07) == 0)
+			Mock_AdcStart();
+	}
+
+	/* TWI */
+	if (Twi_Op != OP_NONE && !Mock_TwiHang && ++Twi_Timer >= Mock_TwiPeriod)
+		Mock_TwiDone();
+
+	/* Timer 1, one count per tick */
+	if (R_TCCR1B & 0x07)
+	{
+		uint16_t tcnt = (uint16_t)(Mock_Io[0x84] | (Mock_Io[0x85] << 8)) + 1;
+		Mock_Io[0x84] = (uint8_t)tcnt;
+		Mock_Io[0x85] = (uint8_t)(tcnt >> 8);
+		if (tcnt == 0)
+			Tim1_Tov = 1;
+	}
+}
+
+
+/*************************************************************************
+Finish the events in progress at the next tick: a byte waiting in the 
+queue, the byte being sent and the conversion. The byte received and the
+conversion wait for the ISR of the previous one: the model would lose it,
+the hardware can not be that fast.
+*************************************************************************/
+static void Mock_Hurry(void)
+{
+	if (Uart_RxHead != Uart_RxTail && !Uart_Rxc && Mock_UartRxPeriod)
+		Uart_RxTimer = Mock_UartRxPeriod - 1;
+	if (Uart_TxTimer)
+		Uart_TxTimer = 1;
+	if (Adc_Busy && !Adc_Flag && Mock_AdcPeriod)
+		Adc_Timer = Mock_AdcPeriod - 1;
+}
+
+
+/*************************************************************************
+Copy the flags owned by the hardware to the registers.
+*************************************************************************/
+static void Mock_Mirror(void)
+{
+	R_UCSR0A = (R_UCSR0A & ((1 << U2X0) | (1 << MPCM0)))
+			 | (Uart_Rxc << RXC0) | (Uart_Txc << TXC0) | (Uart_Dor << DOR0)
+			 | ((Uart_TxTimer == 0) << UDRE0);
+
+	R_ADCSRA = (R_ADCSRA & ~((1 << ADSC) | (1 << ADIF)))
+			 | (Adc_Busy << ADSC) | (Adc_Flag << ADIF);
+
+	R_TWCR = (R_TWCR & ~((1 << TWINT) | (1 << TWSTO)))
+		   | (Twi_Flag << TWINT) | ((Twi_Op == OP_STOP) << TWSTO) | MOCK_TWCR_MARK;
+	R_TWSR = (R_TWSR & 0x03) | (Twi_Status & 0xF8);
+
+	R_TIFR1 = (Tim1_Tov << TOV1) | MOCK_TIFR1_MARK;
+}
+
+
+/*************************************************************************
+Highest priority vector pending, NULL if none.
+*************************************************************************/
+static vector_MOCK Mock_Pending(void)
+{
+	if (TIMER1_OVF_vect && (R_TIMSK1 & (1 << TOIE1)) && Tim1_Tov)
+		return TIMER1_OVF_vect;
+	if (USART_RX_vect && (R_UCSR0B & (1 << RXCIE0)) && Uart_Rxc)
+		return USART_RX_vect;
+	if (USART_UDRE_vect && (R_UCSR0B & (1 << UDRIE0)) && !Uart_TxTimer)
+		return USART_UDRE_vect;
+	if (ADC_vect && (R_ADCSRA & (1 << ADIE)) && Adc_Flag)
+		return ADC_vect;
+	if (TWI_vect && (R_TWCR & (1 << TWIE)) && Twi_Flag)
+		return TWI_vect;
+	return NULL;
+}
+
+
+/*************************************************************************
+Run an ISR like the hardware: I bit cleared, reti sets it again.
+Input:    vector 	ISR function
+Returns:  none
+*************************************************************************/
+void Mock_Interrupt(vector_MOCK vector)
+{
+	vector_MOCK previous = Mock_Vector;
+	uint8_t sreg = R_SREG;
+
+	if (vector == ADC_vect)
+		Adc_Flag = 0;
+	if (vector == TIMER1_OVF_vect)
+		Tim1_Tov = 0;
+
+	R_SREG &= ~(1 << SREG_I);
+	Mock_Vector = vector;
+	Mock_Interrupts++;
+	vector();
+	Mock_Vector = previous;
+	Mock_Commit();
+	Mock_Mirror();
+	R_SREG = sreg;
+}
+
+
+/*************************************************************************
+Run one pending interrupt, if the interrupts are enabled.
+Returns:  1 if an ISR was run
+*************************************************************************/
+static uint8_t Mock_Dispatch(void)
+{
+	vector_MOCK vector;
+
+	if (!(R_SREG & (1 << SREG_I)) || Mock_Vector)
+		return 0;
+	vector = Mock_Pending();
+	if (!vector)
+		return 0;
+	Mock_Interrupt(vector);
+	return 1;
+}
+
+
+/*************************************************************************
+Access to a register: one tick of the model. As the AVR, one pending
+interrupt runs before the instruction.
+Input:    addr 	data space address of the register
+Returns:  the register
+*************************************************************************/
+static uint8_t* Mock_Access(uint8_t addr)
+{
+	Mock_Commit();
+	if (Mock_Preempt && !Mock_Vector && Mock_Preempt())
+	{
+		Mock_Preemptions++;
+		Mock_Hurry();
+	}
+	Mock_Tick();
+	Mock_Mirror();
+	Mock_Dispatch();
+
+	if (addr == 0xC6)
+	{
+		/* UDR0: read in the RX ISR, written anywhere else */
+		if (USART_RX_vect && Mock_Vector == USART_RX_vect)
+		{
+			R_UDR0 = Uart_RxData;
+			Uart_Rxc = 0;
+			Uart_Dor = 0;
+			Mock_Mirror();
+		}
+		else
+			Uart_TxPending = 1;
+	}
+	return &Mock_Io[addr];
+}
+
+volatile uint8_t* Mock_Io8(uint8_t addr)
+{
+	return Mock_Access(addr);
+}
+
+volatile uint16_t* Mock_Io16(uint8_t addr)
+{
+	return (volatile uint16_t*)(void*)Mock_Access(addr);
+}
+
+
+/*************************************************************************
+Run ticks of the model, with its interrupts.
+Input:    ticks 	number of ticks
+Returns:  none
+*************************************************************************/
+void Mock_Run(uint32_t ticks)
+{
+	while (ticks--)
+	{
+		Mock_Commit();
+		Mock_Tick();
+		Mock_Mirror();
+		Mock_Dispatch();
+	}
+	Mock_Commit();
+	Mock_Mirror();
+}
+
+
+/*************************************************************************
+Queue bytes to be received by USART0.
+*************************************************************************/
+void Mock_UartInject(const uint8_t* data, uint16_t len)
+{
+	while (len--)
+	{
+		uint16_t next = (Uart_RxHead + 1) % MOCK_UART_SIZE;
+		if (next == Uart_RxTail)
+			Mock_Fail("RX queue of the model is full");
+		Uart_RxQueue[Uart_RxHead] = *data++;
+		Uart_RxHead = next;
+	}
+}
+
+uint16_t Mock_UartPending(void)
+{
+	return (Uart_RxHead - Uart_RxTail + MOCK_UART_SIZE) % MOCK_UART_SIZE;
+}
+
+
+/*************************************************************************
+sei(), cli() and the sleep instructions.
+*************************************************************************/
+void Mock_Sei(void)
+{
+	R_SREG |= (1 << SREG_I);
+}
+
+void Mock_Cli(void)
+{
+	R_SREG &= ~(1 << SREG_I);
+}
+
+void Mock_SetSleepMode(uint8_t mode)
+{
+	R_SMCR = (R_SMCR & ~((1 << SM2) | (1 << SM1) | (1 << SM0))) | mode;
+}
+
+void Mock_SleepEnable(uint8_t on)
+{
+	if (on)
+		R_SMCR |= (1 << SE);
+	else
+		R_SMCR &= ~(1 << SE);
+}
+
+void Mock_SleepCpu(void)
+{
+	uint32_t ticks = 0;
+
+	if (!(R_SMCR & (1 << SE)))
+		return;
+	if (Mock_Vector)
+		Mock_Fail("sleep inside an ISR");
+	if (!(R_SREG & (1 << SREG_I)))
+		Mock_Fail("sleep with the interrupts disabled, the CPU never wakes up");
+
+	Mock_Sleeps++;
+	Mock_Commit();
+	/* ADC Noise Reduction starts a conversion */
+	if ((R_SMCR & 0x0E) == SLEEP_MODE_ADC && (R_ADCSRA & (1 << ADEN)) && !Adc_Busy)
+		Mock_AdcStart();
+
+	while (!Mock_Dispatch())
+	{
+		if (++ticks > Mock_SleepLimit)
+			Mock_Fail("sleep without a wake up interrupt");
+		Mock_Tick();
+		Mock_Mirror();
+		Mock_SleepTicks++;
+	}
+}
+
+
+/*************************************************************************
+<util/delay.h>, only accounted.
+*************************************************************************/
+void Mock_Delay(double us)
+{
+	Mock_DelayUs += (uint32_t)us;
+}
+
+
+/*************************************************************************
+EEPROM, the EEMEM variables are in the section mock_eeprom.
+*************************************************************************/
+extern uint8_t __start_mock_eeprom[] __attribute__((weak));
+extern uint8_t __stop_mock_eeprom[] __attribute__((weak));
+
+uint8_t Mock_EepromRead(const void* addr)
+{
+	return *(const uint8_t*)addr;
+}
+
+void Mock_EepromWrite(void* addr, uint8_t data, uint8_t update)
+{
+	if (update && *(uint8_t*)addr == data)
+		return;
+	*(uint8_t*)addr = data;
+	Mock_EepromWrites++;
+}
+
+void Mock_EepromErase(void)
+{
+	if (__start_mock_eeprom && __stop_mock_eeprom)
+		memset(__start_mock_eeprom, 0xFF, (size_t)(__stop_mock_eeprom - __start_mock_eeprom));
+}
+
+uint8_t* Mock_Eeprom(uint16_t* size)
+{
+	*size = (uint16_t)(__stop_mock_eeprom - __start_mock_eeprom);
+	return __start_mock_eeprom;
+}
+
+
+/*************************************************************************
+itoa() family of avr-libc, not in the C library of the host.
+*************************************************************************/
+char* ultoa(unsigned long value, char* s, int radix)
+{
+	char tmp[33];
+	int i = 0;
+	int j = 0;
+
+	do
+	{
+		uint8_t digit = (uint8_t)(value % (unsigned)radix);
+		tmp[i++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+		value /= (unsigned)radix;
+	}
+	while (value);
+	while (i)
+		s[j++] = tmp[--i];
+	s[j] = 0;
+	return s;
+}
+
+char* ltoa(long value, char* s, int radix)
+{
+	if (value < 0 && radix == 10)
+	{
+		s[0] = '-';
+		ultoa(-(unsigned long)value, s + 1, radix);
+		return s;
+	}
+	return ultoa((unsigned long)value, s, radix);
+}
+
+char* utoa(unsigned value, char* s, int radix)
+{
+	return ultoa(value, s, radix);
+}
+
+char* itoa(int value, char* s, int radix)
+{
+	if (radix != 10)
+		return ultoa((unsigned)value, s, radix);
+	return ltoa(value, s, radix);
+}
@@ -0,0 +1,228 @@
+#ifndef MOCK_H_
+#define MOCK_H_
+
+/*************************************************************************
+ Title	:   C include file for the host model of the ATmega328P (MOCK.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+ Software:  GCC (host), with the headers of this folder as avr-libc
+ Hardware:  Linux or any host with GCC
+
+ DESCRIPTION
+       Register and interrupt model used to run the libraries on a PC.
+
+       The headers of this folder replace avr-libc. Every register of
+       <avr/io.h> is a byte of the I/O space (Mock_Io), reached through
+       Mock_Io8()/Mock_Io16(). Each access is one tick of the model: the
+       peripherals advance, the writes of the previous access take effect
+       and the pending interrupts run if the I bit of SREG is set. The ISR
+       of the libraries are plain functions called by the model.
+
+       Models:
+           USART0  bytes injected with Mock_UartInject() are received one
+                   every Mock_UartRxPeriod ticks, the bytes written to UDR0
+                   are logged in Mock_UartTx, one every Mock_UartTxPeriod.
+           ADC     conversions take Mock_AdcPeriod ticks, the values come
+                   from Mock_AdcSource() (Mock_AdcValue[] by default).
+                   Single, Free Running and Noise Reduction start.
+           TWI     master side of one slave at Mock_TwiAddress. The bus is
+                   logged in Mock_TwiLog, the slave sends Mock_TwiData.
+           Timer1  TCNT1 counts ticks while it has a clock. The overflow
+                   sets TOV1 and runs TIMER1_OVF_vect.
+           Sleep   sleep_cpu() runs ticks until an interrupt. Sleeping with
+                   the interrupts disabled is a test failure.
+           EEPROM  the EEMEM variables, erased with Mock_EepromErase().
+
+       The model is not cycle accurate: a tick is one register access,
+       not one clock. Use it for the logic, not for the timing.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+*	I/O Space
+*	Data space addresses 0x00-0xFF of the ATmega328P. Mock_Io can be read
+*	and written by the tests without ticks.
+*
+*/
+#define MOCK_IO_SIZE		256
+
+extern uint8_t Mock_Io[MOCK_IO_SIZE];
+
+volatile uint8_t* Mock_Io8(uint8_t addr);
+volatile uint16_t* Mock_Io16(uint8_t addr);
+
+
+/**
+*	Time
+*	Ticks since Mock_Reset(), and ticks spent in sleep_cpu().
+*
+*/
+extern uint32_t Mock_Ticks;
+extern uint32_t Mock_SleepTicks;
+extern uint32_t Mock_Sleeps;				// Calls of sleep_cpu() that slept
+extern uint32_t Mock_SleepLimit;			// Ticks before a sleep is a deadlock
+extern uint32_t Mock_DelayUs;				// Sum of _delay_ms()/_delay_us()
+
+
+/**
+*	Interrupts
+*	Vectors modelled by Mock_Run() and the register accesses. The vector
+*	of the running ISR is in Mock_Vector (NULL in the main code).
+*
+*/
+typedef void (*vector_MOCK)(void);
+
+extern vector_MOCK Mock_Vector;
+extern uint32_t Mock_Interrupts;			// ISRs run by the model
+
+
+/**
+*	Preemption
+*	Mock_Preempt, if set, is called at each register access of the main
+*	code. When it returns 1 the reception, the transmission and the 
+*	conversion in progress finish at this tick, so their ISRs run at 
+*	this point of the caller (the register accesses are the only points
+*	where the model can interrupt the code).
+*
+*/
+extern uint8_t (*Mock_Preempt)(void);
+extern uint32_t Mock_Preemptions;			// Times Mock_Preempt returned 1
+
+
+/**
+*	USART0 Model
+*
+*/
+#define MOCK_UART_SIZE		4096
+
+extern uint16_t Mock_UartRxPeriod;			// Ticks between received bytes
+extern uint16_t Mock_UartTxPeriod;			// Ticks to send one byte
+extern uint8_t Mock_UartTx[MOCK_UART_SIZE];	// Bytes sent, in order
+extern uint16_t Mock_UartTxLen;
+extern uint16_t Mock_UartRxLost;			// Bytes lost by overrun (DOR0)
+
+
+/**
+*	ADC Model
+*
+*/
+extern uint16_t Mock_AdcPeriod;				// Ticks of a conversion
+extern uint16_t Mock_AdcValue[16];			// Value of each MUX input
+extern uint16_t (*Mock_AdcSource)(uint8_t channel);
+extern uint32_t Mock_AdcConversions;
+
+
+/**
+*	TWI Model
+*	Mock_TwiLog has one entry per event of the bus: MOCK_TWI_START,
+*	MOCK_TWI_STOP, or a byte (address or data) with MOCK_TWI_NACK if it
+*	was not acknowledged.
+*
+*/
+#define MOCK_TWI_SIZE		4096
+#define MOCK_TWI_START		0x100
+#define MOCK_TWI_STOP		0x200
+#define MOCK_TWI_NACK		0x400
+
+extern uint8_t Mock_TwiAddress;				// 7 bits address of the slave
+extern uint8_t Mock_TwiNackData;			// 1: the slave NACKs the data
+extern uint8_t Mock_TwiHang;				// 1: operations never finish
+extern uint16_t Mock_TwiPeriod;				// Ticks of an operation
+extern const uint8_t* Mock_TwiData;			// Bytes sent by the slave
+extern uint16_t Mock_TwiDataLen;
+extern uint16_t Mock_TwiLog[MOCK_TWI_SIZE];
+extern uint16_t Mock_TwiLogLen;
+
+
+/**
+*	EEPROM Model
+*
+*/
+extern uint32_t Mock_EepromWrites;			// Bytes written
+
+
+/**
+*	Functions
+*/
+
+/**
+ @brief		Reset the registers, the peripherals and the counters of the
+ 			model. SREG starts with the interrupts disabled.
+ @param		none
+ @return 	none
+*/
+void Mock_Reset(void);
+
+/**
+ @brief		Run ticks of the model, with its interrupts.
+ @param		ticks 	number of ticks
+ @return 	none
+*/
+void Mock_Run(uint32_t ticks);
+
+/**
+ @brief		Run an ISR like the hardware: I bit cleared during the ISR.
+ @param		vector 	ISR function (e.g. TIMER2_COMPA_vect)
+ @return 	none
+*/
+void Mock_Interrupt(vector_MOCK vector);
+
+/**
+ @brief		Queue bytes to be received by USART0.
+ @param		data 	bytes
+ 			len 	number of bytes
+ @return 	none
+*/
+void Mock_UartInject(const uint8_t* data, uint16_t len);
+
+/**
+ @brief		Bytes injected and not received yet.
+ @param		none
+ @return 	number of bytes
+*/
+uint16_t Mock_UartPending(void);
+
+/**
+ @brief		Set all the EEMEM variables to 0xFF.
+ @param		none
+ @return 	none
+*/
+void Mock_EepromErase(void);
+
+/**
+ @brief		The EEMEM variables, in the order of the link.
+ @param		size 	returns the number of bytes
+ @return 	first byte, NULL if there are none
+*/
+uint8_t* Mock_Eeprom(uint16_t* size);
+
+/**
+ @brief		Stop the test with a message. Used by the model when the
+ 			program can not go on (e.g. a sleep that never ends).
+ @param		msg 	reason
+ @return 	does not return
+*/
+void Mock_Fail(const char* msg);
+
+
+/* Used by the headers of avr-libc of this folder */
+void Mock_Sei(void);
+void Mock_Cli(void);
+void Mock_SetSleepMode(uint8_t mode);
+void Mock_SleepEnable(uint8_t on);
+void Mock_SleepCpu(void);
+void Mock_Delay(double us);
+uint8_t Mock_EepromRead(const void* addr);
+void Mock_EepromWrite(void* addr, uint8_t data, uint8_t update);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOCK_H_ */
@@ -0,0 +1,83 @@
+#ifndef MOCK_AVR_EEPROM_H_
+#define MOCK_AVR_EEPROM_H_
+
+/*************************************************************************
+ Title	:   <avr/eeprom.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The EEMEM variables are RAM of the section mock_eeprom. The writes
+       are counted in Mock_EepromWrites, see MOCK.h.
+
+*****************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../MOCK.h"
+
+#define EEMEM	__attribute__((section("mock_eeprom")))
+
+static inline void eeprom_busy_wait(void) {}
+static inline uint8_t eeprom_is_ready(void) { return 1; }
+
+static inline void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+	size_t i;
+	for (i = 0; i < n; i++)
+		((uint8_t*)dst)[i] = Mock_EepromRead((const uint8_t*)src + i);
+}
+
+static inline void eeprom_write_block(const void* src, void* dst, size_t n)
+{
+	size_t i;
+	for (i = 0; i < n; i++)
+		Mock_EepromWrite((uint8_t*)dst + i, ((const uint8_t*)src)[i], 0);
+}
+
+static inline void eeprom_update_block(const void* src, void* dst, size_t n)
+{
+	size_t i;
+	for (i = 0; i < n; i++)
+		Mock_EepromWrite((uint8_t*)dst + i, ((const uint8_t*)src)[i], 1);
+}
+
+static inline uint8_t eeprom_read_byte(const uint8_t* p)
+{
+	return Mock_EepromRead(p);
+}
+
+static inline void eeprom_write_byte(uint8_t* p, uint8_t value)
+{
+	Mock_EepromWrite(p, value, 0);
+}
+
+static inline void eeprom_update_byte(uint8_t* p, uint8_t value)
+{
+	Mock_EepromWrite(p, value, 1);
+}
+
+static inline uint16_t eeprom_read_word(const uint16_t* p)
+{
+	uint16_t value;
+	eeprom_read_block(&value, p, sizeof(value));
+	return value;
+}
+
+static inline void eeprom_update_word(uint16_t* p, uint16_t value)
+{
+	eeprom_update_block(&value, p, sizeof(value));
+}
+
+static inline uint32_t eeprom_read_dword(const uint32_t* p)
+{
+	uint32_t value;
+	eeprom_read_block(&value, p, sizeof(value));
+	return value;
+}
+
+static inline void eeprom_update_dword(uint32_t* p, uint32_t value)
+{
+	eeprom_update_block(&value, p, sizeof(value));
+}
+
+#endif /* MOCK_AVR_EEPROM_H_ */
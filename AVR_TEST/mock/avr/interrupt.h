@@ -0,0 +1,33 @@
+#ifndef MOCK_AVR_INTERRUPT_H_
+#define MOCK_AVR_INTERRUPT_H_
+
+/*************************************************************************
+ Title	:   <avr/interrupt.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       An ISR is a plain function named as its vector, run by the model
+       (MOCK.h) or by the test with Mock_Interrupt().
+
+*****************************************************************************/
+
+#include "../MOCK.h"
+
+#ifdef __cplusplus
+#define MOCK_ISR_LINKAGE	extern "C"
+#else
+#define MOCK_ISR_LINKAGE
+#endif
+
+#define ISR(vector, ...) \
+	MOCK_ISR_LINKAGE void vector(void); \
+	MOCK_ISR_LINKAGE void vector(void)
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+#define sei()	Mock_Sei()
+#define cli()	Mock_Cli()
+
+#endif /* MOCK_AVR_INTERRUPT_H_ */
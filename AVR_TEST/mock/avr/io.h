@@ -0,0 +1,227 @@
+#ifndef MOCK_AVR_IO_H_
+#define MOCK_AVR_IO_H_
+
+/*************************************************************************
+ Title	:   <avr/io.h> of the host model, ATmega328P
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       Same names, addresses and bit numbers as avr-libc (iom328p.h). The
+       registers are lvalues of the model, see MOCK.h.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../MOCK.h"
+
+#define _SFR_MEM8(addr)		(*Mock_Io8(addr))
+#define _SFR_MEM16(addr)	(*Mock_Io16(addr))
+#define _BV(bit)			(1 << (bit))
+
+/* Ports */
+#define PINB	_SFR_MEM8(0x23)
+#define DDRB	_SFR_MEM8(0x24)
+#define PORTB	_SFR_MEM8(0x25)
+#define PINC	_SFR_MEM8(0x26)
+#define DDRC	_SFR_MEM8(0x27)
+#define PORTC	_SFR_MEM8(0x28)
+#define PIND	_SFR_MEM8(0x29)
+#define DDRD	_SFR_MEM8(0x2A)
+#define PORTD	_SFR_MEM8(0x2B)
+
+#define PB0	0
+#define PB1	1
+#define PB2	2
+#define PB3	3
+#define PB4	4
+#define PB5	5
+#define PB6	6
+#define PB7	7
+#define PC0	0
+#define PC1	1
+#define PC2	2
+#define PC3	3
+#define PC4	4
+#define PC5	5
+#define PC6	6
+#define PD0	0
+#define PD1	1
+#define PD2	2
+#define PD3	3
+#define PD4	4
+#define PD5	5
+#define PD6	6
+#define PD7	7
+
+/* Interrupt flags */
+#define TIFR0	_SFR_MEM8(0x35)
+#define TIFR1	_SFR_MEM8(0x36)
+#define TIFR2	_SFR_MEM8(0x37)
+#define PCIFR	_SFR_MEM8(0x3B)
+
+#define TOV1	0
+#define OCF1A	1
+#define OCF1B	2
+#define TOV2	0
+#define OCF2A	1
+#define OCF2B	2
+#define PCIF0	0
+#define PCIF1	1
+#define PCIF2	2
+
+/* Timer 0 */
+#define TCCR0A	_SFR_MEM8(0x44)
+#define TCCR0B	_SFR_MEM8(0x45)
+#define TCNT0	_SFR_MEM8(0x46)
+#define OCR0A	_SFR_MEM8(0x47)
+#define OCR0B	_SFR_MEM8(0x48)
+
+#define CS00	0
+#define CS01	1
+#define CS02	2
+
+/* System */
+#define SMCR	_SFR_MEM8(0x53)
+#define MCUSR	_SFR_MEM8(0x54)
+#define SREG	_SFR_MEM8(0x5F)
+#define PRR		_SFR_MEM8(0x64)
+
+#define SE		0
+#define SM0		1
+#define SM1		2
+#define SM2		3
+#define SREG_I	7
+
+/* Pin change and timer interrupts */
+#define PCICR	_SFR_MEM8(0x68)
+#define PCMSK0	_SFR_MEM8(0x6B)
+#define PCMSK1	_SFR_MEM8(0x6C)
+#define PCMSK2	_SFR_MEM8(0x6D)
+#define TIMSK0	_SFR_MEM8(0x6E)
+#define TIMSK1	_SFR_MEM8(0x6F)
+#define TIMSK2	_SFR_MEM8(0x70)
+
+#define PCIE0	0
+#define PCIE1	1
+#define PCIE2	2
+#define TOIE1	0
+#define OCIE1A	1
+#define OCIE1B	2
+#define TOIE2	0
+#define OCIE2A	1
+#define OCIE2B	2
+
+/* ADC */
+#define ADC		_SFR_MEM16(0x78)
+#define ADCL	_SFR_MEM8(0x78)
+#define ADCH	_SFR_MEM8(0x79)
+#define ADCSRA	_SFR_MEM8(0x7A)
+#define ADCSRB	_SFR_MEM8(0x7B)
+#define ADMUX	_SFR_MEM8(0x7C)
+#define DIDR0	_SFR_MEM8(0x7E)
+
+#define MUX0	0
+#define MUX1	1
+#define MUX2	2
+#define MUX3	3
+#define ADLAR	5
+#define REFS0	6
+#define REFS1	7
+#define ADPS0	0
+#define ADPS1	1
+#define ADPS2	2
+#define ADIE	3
+#define ADIF	4
+#define ADATE	5
+#define ADSC	6
+#define ADEN	7
+#define ADTS0	0
+#define ADTS1	1
+#define ADTS2	2
+#define ACME	6
+
+/* Timer 1 */
+#define TCCR1A	_SFR_MEM8(0x80)
+#define TCCR1B	_SFR_MEM8(0x81)
+#define TCCR1C	_SFR_MEM8(0x82)
+#define TCNT1	_SFR_MEM16(0x84)
+#define OCR1A	_SFR_MEM16(0x88)
+#define OCR1B	_SFR_MEM16(0x8A)
+
+#define CS10	0
+#define CS11	1
+#define CS12	2
+#define WGM12	3
+#define WGM13	4
+
+/* Timer 2 */
+#define TCCR2A	_SFR_MEM8(0xB0)
+#define TCCR2B	_SFR_MEM8(0xB1)
+#define TCNT2	_SFR_MEM8(0xB2)
+#define OCR2A	_SFR_MEM8(0xB3)
+#define OCR2B	_SFR_MEM8(0xB4)
+#define ASSR	_SFR_MEM8(0xB6)
+
+#define WGM20	0
+#define WGM21	1
+#define CS20	0
+#define CS21	1
+#define CS22	2
+
+/* TWI */
+#define TWBR	_SFR_MEM8(0xB8)
+#define TWSR	_SFR_MEM8(0xB9)
+#define TWAR	_SFR_MEM8(0xBA)
+#define TWDR	_SFR_MEM8(0xBB)
+#define TWCR	_SFR_MEM8(0xBC)
+
+#define TWPS0	0
+#define TWPS1	1
+#define TWIE	0
+#define TWEN	2
+#define TWWC	3
+#define TWSTO	4
+#define TWSTA	5
+#define TWEA	6
+#define TWINT	7
+
+/* USART0 */
+#define UCSR0A	_SFR_MEM8(0xC0)
+#define UCSR0B	_SFR_MEM8(0xC1)
+#define UCSR0C	_SFR_MEM8(0xC2)
+#define UBRR0	_SFR_MEM16(0xC4)
+#define UBRR0L	_SFR_MEM8(0xC4)
+#define UBRR0H	_SFR_MEM8(0xC5)
+#define UDR0	_SFR_MEM8(0xC6)
+
+#define MPCM0	0
+#define U2X0	1
+#define UPE0	2
+#define DOR0	3
+#define FE0		4
+#define UDRE0	5
+#define TXC0	6
+#define RXC0	7
+#define TXB80	0
+#define RXB80	1
+#define UCSZ02	2
+#define TXEN0	3
+#define RXEN0	4
+#define UDRIE0	5
+#define TXCIE0	6
+#define RXCIE0	7
+#define UCPOL0	0
+#define UCSZ00	1
+#define UCSZ01	2
+#define USBS0	3
+#define UPM00	4
+#define UPM01	5
+#define UMSEL00	6
+#define UMSEL01	7
+
+/* Memories */
+#define RAMEND			0x8FF
+#define E2END			0x3FF
+#define SPM_PAGESIZE	128
+
+#endif /* MOCK_AVR_IO_H_ */
@@ -0,0 +1,31 @@
+#ifndef MOCK_AVR_PGMSPACE_H_
+#define MOCK_AVR_PGMSPACE_H_
+
+/*************************************************************************
+ Title	:   <avr/pgmspace.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The host has one address space: PROGMEM data is read as RAM.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)					(s)
+#define PGM_P					const char*
+
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)		(*(void* const*)(addr))
+
+#define strcmp_P				strcmp
+#define strncmp_P				strncmp
+#define strcpy_P				strcpy
+#define strlen_P				strlen
+#define memcpy_P				memcpy
+
+#endif /* MOCK_AVR_PGMSPACE_H_ */
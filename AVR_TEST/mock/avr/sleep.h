@@ -0,0 +1,29 @@
+#ifndef MOCK_AVR_SLEEP_H_
+#define MOCK_AVR_SLEEP_H_
+
+/*************************************************************************
+ Title	:   <avr/sleep.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       sleep_cpu() runs the model until an interrupt, see MOCK.h.
+
+*****************************************************************************/
+
+#include "../MOCK.h"
+
+#define SLEEP_MODE_IDLE			0x00
+#define SLEEP_MODE_ADC			0x02
+#define SLEEP_MODE_PWR_DOWN		0x04
+#define SLEEP_MODE_PWR_SAVE		0x06
+#define SLEEP_MODE_STANDBY		0x0C
+#define SLEEP_MODE_EXT_STANDBY	0x0E
+
+#define set_sleep_mode(mode)	Mock_SetSleepMode(mode)
+#define sleep_enable()			Mock_SleepEnable(1)
+#define sleep_disable()			Mock_SleepEnable(0)
+#define sleep_cpu()				Mock_SleepCpu()
+#define sleep_mode() \
+	do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+
+#endif /* MOCK_AVR_SLEEP_H_ */
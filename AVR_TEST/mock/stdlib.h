@@ -0,0 +1,29 @@
+#ifndef MOCK_STDLIB_H_
+#define MOCK_STDLIB_H_
+
+/*************************************************************************
+ Title	:   <stdlib.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The C library of the host plus the itoa() family of avr-libc,
+       implemented in MOCK.c.
+
+*****************************************************************************/
+
+#include_next <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* itoa(int value, char* s, int radix);
+char* utoa(unsigned value, char* s, int radix);
+char* ltoa(long value, char* s, int radix);
+char* ultoa(unsigned long value, char* s, int radix);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOCK_STDLIB_H_ */
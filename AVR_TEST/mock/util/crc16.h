@@ -0,0 +1,59 @@
+#ifndef MOCK_UTIL_CRC16_H_
+#define MOCK_UTIL_CRC16_H_
+
+/*************************************************************************
+ Title	:   <util/crc16.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       C equivalents of the avr-libc functions, from its documentation.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+static __inline__ uint16_t _crc16_update(uint16_t crc, uint8_t a)
+{
+	int i;
+	crc ^= a;
+	for (i = 0; i < 8; ++i)
+		crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+	return crc;
+}
+
+static __inline__ uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data)
+{
+	int i;
+	crc = crc ^ ((uint16_t)data << 8);
+	for (i = 0; i < 8; i++)
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	return crc;
+}
+
+static __inline__ uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+	data ^= (uint8_t)crc;
+	data ^= data << 4;
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4)
+			^ ((uint16_t)data << 3));
+}
+
+static __inline__ uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data)
+{
+	uint8_t i;
+	crc = crc ^ data;
+	for (i = 0; i < 8; i++)
+		crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+	return crc;
+}
+
+static __inline__ uint8_t _crc8_ccitt_update(uint8_t inCrc, uint8_t inData)
+{
+	uint8_t i;
+	uint8_t data = inCrc ^ inData;
+	for (i = 0; i < 8; i++)
+		data = (data & 0x80) ? (data << 1) ^ 0x07 : (data << 1);
+	return data;
+}
+
+#endif /* MOCK_UTIL_CRC16_H_ */
@@ -0,0 +1,22 @@
+#ifndef MOCK_UTIL_DELAY_H_
+#define MOCK_UTIL_DELAY_H_
+
+/*************************************************************************
+ Title	:   <util/delay.h> of the host model
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe>
+
+ DESCRIPTION
+       The delays do not wait, they are added to Mock_DelayUs.
+
+*****************************************************************************/
+
+#include "../MOCK.h"
+
+#ifndef F_CPU
+#error "F_CPU has to be defined for <util/delay.h>"
+#endif
+
+#define _delay_us(us)	Mock_Delay(us)
+#define _delay_ms(ms)	Mock_Delay((ms) * 1000.0)
+
+#endif /* MOCK_UTIL_DELAY_H_ */
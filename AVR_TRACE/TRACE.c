@@ -0,0 +1,169 @@
+/*************************************************************************
+ Title	:   Trace library (TRACE.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Timestamped event log for the UART, ADC and I2C libraries.
+
+       The records are pushed by the ISRs with the inline Trace_Push()
+       of TRACE.h and sent through the UART by Trace_Dump().
+
+ USAGE
+       See the C include TRACE.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <stdlib.h>
+#include <util/atomic.h>
+#include "TRACE.h"
+#include "../AVR_UART/UART.h"
+
+#if TRACE_ENABLE
+
+/* Global Variables */
+record_TRACE Trace_Buffer[TRACE_SIZE] MEM_SECTION;
+volatile uint8_t Trace_Head;
+volatile uint8_t Trace_Tail;
+volatile uint8_t Trace_On;
+volatile uint8_t Trace_Lost;
+volatile uint8_t Trace_Wraps;
+
+/* Names of the events sent by Trace_Dump() */
+static const char Trace_Name[TRACE_USER][6] PROGMEM = 
+{
+	"RX", "UDRE", "ADC", "TWI", "START", "STOP", "NACK", "WRAP"
+};
+
+#endif
+
+
+/*************************************************************************
+Timer1 Overflow: one more wrap of the stamps before the next record.
+*************************************************************************/
+#if TRACE_ENABLE
+ISR(TIMER1_OVF_vect)
+{
+	if (Trace_Wraps != 0xFF)
+		Trace_Wraps++;
+}
+#endif
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Start Timer1 free running and clear the ring.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Trace_Init(void)
+{
+	#if TRACE_ENABLE
+	/* Normal mode, clock selected by TRACE_CLOCK */
+	TCCR1A = 0;
+	TCCR1B = (TRACE_CLOCK << CS10);
+	TIMSK1 |= (1 << TOIE1);
+	
+	Trace_On = 0;
+	Trace_Head = 0;
+	Trace_Tail = 0;
+	Trace_Lost = 0;
+	Trace_Wraps = 0;
+	Trace_On = 1;
+	#endif
+}
+
+/*************************************************************************
+Start or stop recording events.
+Input:    on 	1 to record, 0 to stop
+Returns:  none
+*************************************************************************/
+void Trace_Enable(uint8_t on)
+{
+	#if TRACE_ENABLE
+	Trace_On = on;
+	#else
+	(void)on;
+	#endif
+}
+
+/*************************************************************************
+Send the records as text lines, the oldest first, and remove them.
+Input:    none
+Returns:  none
+*************************************************************************/
+void Trace_Dump(void)
+{
+	#if TRACE_ENABLE
+	uint8_t on = Trace_On;
+	uint8_t tmptail = Trace_Tail;
+	uint8_t head = Trace_Head;
+	uint16_t last = 0;
+	uint8_t first = 1;
+	uint8_t wraps = 0;
+	uint8_t lost;
+	record_TRACE record;
+	char delta[11];
+	
+	/* Keep recording, but not the UDRE events of the dump itself */
+	if (on)
+		Trace_On = TRACE_DUMP;
+	
+	/* Only the records pushed before the dump, the new ones stay */
+	while (tmptail != head)
+	{
+		tmptail = (tmptail + 1) & TRACE_MASK;
+		record = Trace_Buffer[tmptail];
+		
+		/* Release the slot */
+		Trace_Tail = tmptail;
+		
+		/* Added to the delta of the next record */
+		if (record.id == TRACE_WRAP)
+		{
+			wraps = record.arg;
+			continue;
+		}
+		
+		USART_putNumber(record.stamp);
+		USART_putString(" +");
+		ultoa(first ? 0 : ((uint32_t)wraps << 16) + record.stamp - last, delta, 10);
+		USART_putString(delta);
+		USART_Transmit(' ');
+		if (record.id < TRACE_USER)
+		{
+			USART_putString_P(Trace_Name[record.id]);
+		} else
+		{
+			USART_putString("EVT");
+			USART_putNumber(record.id);
+		}
+		USART_Transmit(' ');
+		USART_putNumber(record.arg);
+		USART_putString("\r\n");
+		
+		last = record.stamp;
+		first = 0;
+		wraps = 0;
+	}
+	
+	/* The ISRs can drop records until the counter is cleared */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		lost = Trace_Lost;
+		Trace_Lost = 0;
+	}
+	USART_putString("LOST=");
+	USART_putNumber(lost);
+	USART_putString("\r\n");
+	
+	Trace_On = on;
+	#endif
+}
@@ -0,0 +1,231 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*************************************************************************
+ Title	:   C include file for the Trace library (TRACE.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Timestamped event log for the UART, ADC and I2C libraries.
+
+       Each event is a record with an id, an argument and the value of 
+       Timer1, the same timer used by the Stats library. The ISRs push 
+       the records into one ring buffer and the main loop reads them with
+       Trace_Dump(), which sends the timeline through the UART. The 
+       overflows of Timer1 are counted by TIMER1_OVF_vect and stored as a 
+       WRAP record before the next event, so the timeline can be unwrapped.
+
+       Everything is removed at compile time when TRACE_ENABLE is 0.
+
+*****************************************************************************/
+
+#include <stdint.h>
+
+
+/**
+*	Trace Enable
+*	TRACE_ENABLE is set in CONFIG.h: 1 compiles the ring and the trace 
+*	points of the libraries.
+*
+*/
+#include "../AVR_CONFIG/CONFIG.h"
+
+
+/**
+*	Trace Buffer Definitions
+*	Number of records of the ring, set in MEMCONF.h. Power of 2, each 
+*	record takes 4 bytes.
+*
+*/
+#include "../AVR_MEMCONF/MEMCONF.h"
+#define TRACE_MASK		(TRACE_SIZE - 1)
+
+
+/**
+*	Trace Clock
+*	Clock select bits of Timer1 (CS12:0). 1 counts at F_CPU, the stamps 
+*	wrap every 65536 cycles (4 ms at 16 MHz). 2 to 5 divide the clock by
+*	8, 64, 256 or 1024 for longer timelines. The Stats library needs 1.
+*	TRACE.c owns TIMER1_OVF_vect.
+*
+*/
+#ifndef TRACE_CLOCK
+#define TRACE_CLOCK		1
+#endif
+
+#if (TRACE_CLOCK < 1) || (TRACE_CLOCK > 5)
+	#error "TRACE_CLOCK must be between 1 and 5"
+#endif
+#if defined(STATS_ENABLE) && STATS_ENABLE && (TRACE_CLOCK != 1)
+	#error "The Stats library needs Timer1 at F_CPU, use TRACE_CLOCK 1"
+#endif
+
+
+/**
+*	Trace Events
+*	Ids of the records pushed by the libraries. The applications can use
+*	their own ids from TRACE_USER. The argument of each event is:
+*	UART_RX: received byte. UART_UDRE: 0. ADC: low byte of the value. 
+*	TWI: TWI status. I2C_START: address with the W/R bit. I2C_STOP: 0. 
+*	I2C_NACK: TWI status. WRAP: overflows of Timer1 since the previous 
+*	record (255 is 255 or more), pushed by the next event with its stamp.
+*
+*/
+typedef enum
+{
+	TRACE_UART_RX,
+	TRACE_UART_UDRE,
+	TRACE_ADC,
+	TRACE_TWI,
+	TRACE_I2C_START,
+	TRACE_I2C_STOP,
+	TRACE_I2C_NACK,
+	TRACE_WRAP,
+	TRACE_USER
+} events_TRACE;
+
+
+/**
+*	Trace Dump Format
+*	Trace_Dump() sends one text line per record, the oldest first:
+*
+*		<stamp> +<delta> <event> <arg>\r\n
+*
+*	stamp is the value of Timer1, delta the ticks since the previous 
+*	record of the dump (0 for the first one) and event the name of the 
+*	event, or "EVT<id>" for the ids from TRACE_USER. All numbers are 
+*	decimal. The dump ends with "LOST=<n>\r\n", the records dropped 
+*	because the ring was full. The WRAP records are not printed: their 
+*	overflows are added to the delta of the next line, which is exact up
+*	to 255 wraps. The sum of the deltas is the timeline.
+*
+*	The trace keeps recording during the dump, except the UDRE events of
+*	the bytes it sends. The records pushed meanwhile are left in the ring
+*	for the next dump, or counted in LOST if it was full.
+*
+*/
+
+
+/**
+*	Trace Record
+*	One event of the ring.
+*
+*/
+typedef struct
+{
+	uint8_t id;					// events_TRACE or TRACE_USER + n
+	uint8_t arg;				// Argument of the event
+	uint16_t stamp;				// Timer1 when the event was pushed
+} record_TRACE;
+
+
+/**
+*	Trace Macros
+*	Used by the libraries on the hot paths. TRACE_ISR() is for the ISRs,
+*	the interrupts are already disabled. TRACE() can be used anywhere.
+*	Only the ISRs and TRACE() write the ring, Trace_Dump() is the only 
+*	reader: the head and the tail are never written by both sides.
+*	Trace_On is 0 (stopped), 1 (recording) or TRACE_DUMP.
+*
+*/
+#define TRACE_DUMP		2
+
+#if TRACE_ENABLE
+#include <avr/io.h>
+#include <util/atomic.h>
+
+extern record_TRACE Trace_Buffer[TRACE_SIZE];
+extern volatile uint8_t Trace_Head;
+extern volatile uint8_t Trace_Tail;
+extern volatile uint8_t Trace_On;
+extern volatile uint8_t Trace_Lost;
+extern volatile uint8_t Trace_Wraps;
+
+/* Returns 0 if the ring is full, the oldest records are kept */
+static inline uint8_t Trace_Store(uint8_t id, uint8_t arg, uint16_t stamp)
+{
+	uint8_t tmphead = (Trace_Head + 1) & TRACE_MASK;
+	
+	if (tmphead == Trace_Tail)
+	{
+		if (Trace_Lost != 0xFF)
+			Trace_Lost++;
+		return 0;
+	}
+	Trace_Buffer[tmphead].id = id;
+	Trace_Buffer[tmphead].arg = arg;
+	Trace_Buffer[tmphead].stamp = stamp;
+	Trace_Head = tmphead;
+	return 1;
+}
+
+static inline void Trace_Push(uint8_t id, uint8_t arg)
+{
+	uint16_t stamp = TCNT1;
+	
+	if (!Trace_On)
+		return;
+	/* The UART sends the dump, its UDRE events would fill the ring */
+	if ((Trace_On == TRACE_DUMP) && (id == TRACE_UART_UDRE))
+		return;
+	
+	/* An overflow before the stamp, its ISR has not run: counted here */
+	if ((TIFR1 & (1 << TOV1)) && !(stamp & 0x8000))
+	{
+		TIFR1 = (1 << TOV1);
+		if (Trace_Wraps != 0xFF)
+			Trace_Wraps++;
+	}
+	/* The overflows since the previous record go first */
+	if (Trace_Wraps)
+	{
+		if (!Trace_Store(TRACE_WRAP, Trace_Wraps, stamp))
+			return;
+		Trace_Wraps = 0;
+	}
+	Trace_Store(id, arg, stamp);
+}
+
+#define TRACE_ISR(id, arg)		Trace_Push((id), (arg))
+#define TRACE(id, arg)			do { ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { Trace_Push((id), (arg)); } } while (0)
+#else
+#define TRACE_ISR(id, arg)
+#define TRACE(id, arg)
+#endif
+
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Start Timer1 free running with TRACE_CLOCK and its overflow 
+ 			interrupt, clear the ring and start the trace. Can be used with
+ 			Stats_Init(). 
+ @param		none
+ @return 	none
+*/
+void Trace_Init(void);
+
+/**
+ @brief		Start or stop recording events. The records are kept. 
+ @param		on 		1 to record, 0 to stop
+ @return 	none
+*/
+void Trace_Enable(uint8_t on);
+
+/**
+ @brief		Send the records through the UART and remove them from the ring.
+ 			The UDRE events of the dump are not recorded, the other events 
+ 			pushed meanwhile are kept for the next dump. The UART has to be
+ 			initialized. 
+ @param		none
+ @return 	none
+*/
+void Trace_Dump(void);
+
+
+#endif /* TRACE_H_ */
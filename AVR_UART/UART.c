@@ -1,186 +1,506 @@
-/*************************************************************************
- Title	:   UART library (UART.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the UART protocol.
-
-       Originally based on the AppNote AVR306 from Microchip,
-       changed the structure to use the 2X Mode of the AVR, 
-       Designed for the ATmega328P microcontroller.
-
-       This Library uses interruptions for the UART and have buffers to 
-       store the data. The baud rate to initialize the UART is MYUBRR. 
-       This value is obtain from a Macro definition.
-
- USAGE
-       See the C include UART.h file for a description of each function
-       
-*****************************************************************************/
-
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <stdlib.h>
-#include "UART.h"
-
-
-/* Static Variables */
-static uint8_t USART_RxBuf[USART_RX_BUFFER_SIZE];
-static volatile uint8_t USART_RxHead;
-static volatile uint8_t USART_RxTail;
-static uint8_t USART_TxBuf[USART_TX_BUFFER_SIZE];
-static volatile uint8_t USART_TxHead;
-static volatile uint8_t USART_TxTail;
-
-
-
-/*
-**	functions
-*/
-
-/*************************************************************************
-Low-level function to initialize the UART
-Input:    ubrr_val		MYUBRR from macro definition
-Returns:  none
-*************************************************************************/
-void USART_Init(unsigned int ubrr_val)
-{
-	/* Set the baud rate */
-	UBRR0H = (uint8_t) (ubrr_val>>8);                  
-	UBRR0L = (uint8_t) ubrr_val;
-	
-	/* Enable 2X Mode */ 
-	UCSR0A = (1<<U2X0);
-	
-	/* Enable USART receiver and transmitter */
-	UCSR0B = ((1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0)); 
-
-	/* Set frame format: 8 data 1stop */
-	UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
-	
-	/* Flush buffers */    
-	USART_RxTail = 0;
-	USART_RxHead = 0;
-	USART_TxTail = 0;
-	USART_TxHead = 0;
-}
-
-
-/*************************************************************************
-Interrupt Vector for the RX Mode.
-If there are new unread data this ISR will execute. Saves the data and
-change the index of the RX Buffer.
-*************************************************************************/
-ISR(USART_RX_vect)
-{
-	uint8_t data;
-	uint8_t tmphead;
-
-	/* Read the received data */
-	data = UDR0;                 
-	/* Calculate buffer index */
-	tmphead = (USART_RxHead + 1) & USART_RX_BUFFER_MASK;
-	/* Store new index */
-	USART_RxHead = tmphead;
-	/* Store received data in buffer */
-	USART_RxBuf[tmphead] = data; 
-}
-
-
-/*************************************************************************
-Interrupt Vector for the TX Mode.
-If the buffer of the UART is empty this ISR will execute. Check for new 
-data to be sent and puts that into the buffer . Change the index of the 
-TX Buffer.
-*************************************************************************/
-ISR(USART_UDRE_vect)
-{
-	uint8_t tmptail;
-
-	/* Check if all data is transmitted */
-	if (USART_TxHead != USART_TxTail) 
-	{
-		/* Calculate buffer index */
-		tmptail = (USART_TxTail + 1) & USART_TX_BUFFER_MASK;
-		/* Store new index */
-		USART_TxTail = tmptail;      
-		/* Start transmission */
-		UDR0 = USART_TxBuf[tmptail];  
-	} else 
-	{       
-		/* Disable UDRE interrupt */
-		UCSR0B &= ~(1<<UDRIE0);         
-	}
-}
-
-
-
-/*************************************************************************
-Waits until there are new data in the buffer. 
-Input:    none
-Returns:  Data received from the UART. 
-*************************************************************************/
-uint8_t USART_Receive(void)
-{
-	uint8_t tmptail;
-	
-	/* Wait for incoming data */
-	while (USART_RxHead == USART_RxTail);
-	/* Calculate buffer index */
-	tmptail = (USART_RxTail + 1) & USART_RX_BUFFER_MASK;
-	/* Store new index */
-	USART_RxTail = tmptail;                
-	/* Return data */
-	return USART_RxBuf[tmptail];          
-}
-
-
-/*************************************************************************
-Send Byte through UART. Enable the UDRE0 ISR. (buffer empty)
-Input:    data 	byte to be send
-Returns:  none
-*************************************************************************/
-void USART_Transmit(uint8_t data)
-{
-	uint8_t tmphead;
-	
-	/* Calculate buffer index */
-	tmphead = (USART_TxHead + 1) & USART_TX_BUFFER_MASK;
-	/* Wait for free space in buffer */
-	while (tmphead == USART_TxTail);
-	/* Store data in buffer */
-	USART_TxBuf[tmphead] = data;
-	/* Store new index */
-	USART_TxHead = tmphead;               
-	/* Enable UDRE interrupt */
-	UCSR0B |= (1<<UDRIE0);                    
-}
-
-
-/*************************************************************************
-Send String through UART. 
-Input:    StringPtr	String to be send
-Returns:  none
-*************************************************************************/
-void USART_putString(char* StringPtr)
-{
-	while(*StringPtr != 0x00) 	// Last char will be null. Check if there are more characters to send
-	{				
-		USART_Transmit(*StringPtr);	// Send 1 char at a time
-		StringPtr++;					// Increment the index
-	}
-}
-
-/*************************************************************************
-Send Number through UART. 
-Input:    data	Number to be send
-Returns:  none
-*************************************************************************/
-void USART_putNumber(uint16_t data)
-{
-	char array[4];				// 4 digits of the number. Change if needed
-	itoa(data, array, 10);		// Radix for the conversion: 10
-	USART_putString(array);		// Send the ASCII codes obtained from data
-}
+/*************************************************************************
+ Title	:   UART library (UART.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the UART protocol.
+
+       Originally based on the AppNote AVR306 from Microchip,
+       changed the structure to use the 2X Mode of the AVR, 
+       Designed for the ATmega328P microcontroller.
+
+       This Library uses interruptions for the UART and have buffers to 
+       store the data. The baud rate to initialize the UART is MYUBRR. 
+       This value is obtain from a Macro definition.
+
+ USAGE
+       See the C include UART.h file for a description of each function
+       
+*****************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include <stdlib.h>
+#include "UART.h"
+#include "../AVR_CONFIG/SLEEPWAIT.h"
+#include "../AVR_STATS/STATS.h"
+#include "../AVR_TRACE/TRACE.h"
+
+/* Checked here, not in UART.h: one warning per build, not per file */
+#if (UART_BAUD_ERROR < 980) || (UART_BAUD_ERROR > 1020)
+	#warning "UART baud rate error is higher than 2%"
+#endif
+
+
+/* Static Variables */
+static uint8_t USART_RxBuf[USART_RX_BUFFER_SIZE] MEM_SECTION;
+static volatile uint8_t USART_RxHead;
+static volatile uint8_t USART_RxTail;
+static uint8_t USART_TxBuf[USART_TX_BUFFER_SIZE] MEM_SECTION;
+static volatile uint8_t USART_TxHead;
+static volatile uint8_t USART_TxTail;
+static const uint8_t* volatile USART_TxBlock;
+static volatile uint8_t USART_TxBlockLen;
+#if USART_BLOCK_RX
+static uint8_t* USART_RxBlockBuf;				// Caller buffer
+static uint8_t USART_RxBlockMask;				// slots - 1
+static volatile uint8_t USART_RxBlockBase;		// Next seq for the writer
+static volatile uint8_t USART_RxBlockReady;		// Stored slots, 1 bit each
+static uint8_t USART_RxBlockLen[8];				// Data length of each slot
+static volatile uint8_t USART_RxBlockState;
+static volatile uint8_t USART_RxBlockEnd;		// EOT received
+static uint8_t* USART_RxBlockPos;				// NULL: data is discarded
+static uint8_t USART_RxBlockSeq;
+static uint8_t USART_RxBlockCount;
+static uint8_t USART_RxBlockDup;				// Frame already stored before
+static uint16_t USART_RxBlockCrc;
+#endif
+
+
+
+/*
+**	functions
+*/
+
+/*************************************************************************
+Low-level function to initialize the UART
+Input:    ubrr_val		MYUBRR from macro definition
+Returns:  none
+*************************************************************************/
+void USART_Init(unsigned int ubrr_val)
+{
+	/* Set the baud rate */
+	UBRR0H = (uint8_t) (ubrr_val>>8);                  
+	UBRR0L = (uint8_t) ubrr_val;
+	
+	/* Enable 2X Mode */ 
+	UCSR0A = (1<<U2X0);
+	
+	/* Enable USART receiver and transmitter */
+	UCSR0B = ((1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0)); 
+
+	/* Set frame format: 8 data 1stop */
+	UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+	
+	/* Flush buffers */    
+	USART_RxTail = 0;
+	USART_RxHead = 0;
+	USART_TxTail = 0;
+	USART_TxHead = 0;
+	USART_TxBlockLen = 0;
+}
+
+
+#if USART_BLOCK_RX
+/* States of the block receive mode */
+#define USART_BLK_IDLE		0			// RX Buffer mode
+#define USART_BLK_SOH		1
+#define USART_BLK_SEQ		2
+#define USART_BLK_LEN		3
+#define USART_BLK_DATA		4
+#define USART_BLK_CRC1		5
+#define USART_BLK_CRC2		6
+
+/*************************************************************************
+Put a reply in the TX Buffer from the RX ISR. Does not wait: if the
+buffer is full the reply is lost and the sender retries by timeout.
+Input:    data 	byte to be send
+Returns:  none
+*************************************************************************/
+static void USART_Reply(uint8_t data)
+{
+	uint8_t tmphead = (USART_TxHead + 1) & USART_TX_BUFFER_MASK;
+	
+	if (tmphead != USART_TxTail)
+	{
+		USART_TxBuf[tmphead] = data;
+		USART_TxHead = tmphead;
+		UCSR0B |= (1<<UDRIE0);
+	}
+}
+
+/*************************************************************************
+Process one byte of the block protocol. Called by the RX ISR. The data
+is written straight into the slot of the frame and checked at the end.
+Input:    data 	received byte
+Returns:  none
+*************************************************************************/
+static inline void USART_BlockByte(uint8_t data)
+{
+	uint8_t slot;
+	
+	switch (USART_RxBlockState)
+	{
+		case USART_BLK_SOH:
+			if (data == USART_SOH)
+			{
+				USART_RxBlockState = USART_BLK_SEQ;
+			} else if (data == USART_EOT)
+			{
+				USART_RxBlockEnd = 1;
+				USART_Reply(USART_ACK);
+				USART_Reply(USART_EOT);
+			}
+			break;
+		case USART_BLK_SEQ:
+			USART_RxBlockSeq = data;
+			USART_RxBlockCrc = _crc_xmodem_update(0, data);
+			USART_RxBlockState = USART_BLK_LEN;
+			break;
+		case USART_BLK_LEN:
+			USART_RxBlockCrc = _crc_xmodem_update(USART_RxBlockCrc, data);
+			USART_RxBlockCount = data;
+			USART_RxBlockPos = 0;
+			USART_RxBlockDup = 0;
+			slot = USART_RxBlockSeq - USART_RxBlockBase;
+			if (data == 0 || data > USART_BLOCK_SIZE)
+			{
+				/* Not a frame, wait for the next SOH */
+				USART_RxBlockState = USART_BLK_SOH;
+				break;
+			}
+			if (slot <= USART_RxBlockMask)
+			{
+				/* Inside the window, the block may be stored already */
+				slot = USART_RxBlockSeq & USART_RxBlockMask;
+				if (USART_RxBlockReady & (1<<slot))
+					USART_RxBlockDup = 1;
+				else
+					USART_RxBlockPos = USART_RxBlockBuf + slot * USART_BLOCK_SIZE;
+			} else if ((uint8_t)(USART_RxBlockBase - USART_RxBlockSeq) <= USART_RxBlockMask + 1)
+			{
+				/* Already given to the writer, the ACK was lost */
+				USART_RxBlockDup = 1;
+			}
+			USART_RxBlockState = USART_BLK_DATA;
+			break;
+		case USART_BLK_DATA:
+			USART_RxBlockCrc = _crc_xmodem_update(USART_RxBlockCrc, data);
+			if (USART_RxBlockPos)
+				*USART_RxBlockPos++ = data;
+			if (--USART_RxBlockCount == 0)
+				USART_RxBlockState = USART_BLK_CRC1;
+			break;
+		case USART_BLK_CRC1:
+			USART_RxBlockCrc ^= (uint16_t)data << 8;
+			USART_RxBlockState = USART_BLK_CRC2;
+			break;
+		case USART_BLK_CRC2:
+			USART_RxBlockCrc ^= data;
+			if (USART_RxBlockCrc == 0 && (USART_RxBlockPos || USART_RxBlockDup))
+			{
+				if (USART_RxBlockPos)
+				{
+					slot = USART_RxBlockSeq & USART_RxBlockMask;
+					USART_RxBlockLen[slot] = USART_RxBlockPos - (USART_RxBlockBuf + slot * USART_BLOCK_SIZE);
+					USART_RxBlockReady |= (1<<slot);
+				}
+				USART_Reply(USART_ACK);
+			} else
+			{
+				USART_Reply(USART_NAK);
+			}
+			USART_Reply(USART_RxBlockSeq);
+			USART_RxBlockState = USART_BLK_SOH;
+			break;
+		default:
+			break;
+	}
+}
+#endif
+
+
+/*************************************************************************
+Interrupt Vector for the RX Mode.
+If there are new unread data this ISR will execute. Saves the data and
+change the index of the RX Buffer. If the buffer is full the new data is
+dropped.
+*************************************************************************/
+ISR(USART_RX_vect)
+{
+	STATS_ISR_BEGIN();
+	uint8_t data;
+	uint8_t tmphead;
+
+	#if STATS_ENABLE
+	/* Hardware overrun, a byte was lost before this one */
+	if (UCSR0A & (1<<DOR0))
+		STATS_INC(STATS_UART_RX_OVERRUN);
+	#endif
+	/* Read the received data */
+	data = UDR0;                 
+	TRACE_ISR(TRACE_UART_RX, data);
+	#if USART_BLOCK_RX
+	if (USART_RxBlockState != USART_BLK_IDLE)
+	{
+		USART_BlockByte(data);
+		STATS_ISR_END(STATS_ISR_UART_RX);
+		return;
+	}
+	#endif
+	/* Calculate buffer index */
+	tmphead = (USART_RxHead + 1) & USART_RX_BUFFER_MASK;
+	/* Drop the data if the buffer is full, unread data is kept */
+	if (tmphead == USART_RxTail)
+	{
+		STATS_INC(STATS_UART_RX_OVERRUN);
+	} else
+	{
+		/* Store received data in buffer */
+		USART_RxBuf[tmphead] = data; 
+		/* Store new index */
+		USART_RxHead = tmphead;
+	}
+	STATS_ISR_END(STATS_ISR_UART_RX);
+}
+
+
+/*************************************************************************
+Interrupt Vector for the TX Mode.
+If the buffer of the UART is empty this ISR will execute. Check for new 
+data to be sent and puts that into the buffer . Change the index of the 
+TX Buffer. A block of USART_TransmitBlock() is sent first and is never 
+interleaved with bytes of the TX Buffer.
+*************************************************************************/
+ISR(USART_UDRE_vect)
+{
+	STATS_ISR_BEGIN();
+	uint8_t tmptail;
+
+	TRACE_ISR(TRACE_UART_UDRE, 0);
+	/* Check if a block is being sent */
+	if (USART_TxBlockLen != 0)
+	{
+		const uint8_t* block = USART_TxBlock;
+		/* Start transmission */
+		UDR0 = *block;
+		/* Store new position */
+		USART_TxBlock = block + 1;
+		USART_TxBlockLen--;
+	}
+	/* Check if all data is transmitted */
+	else if (USART_TxHead != USART_TxTail) 
+	{
+		/* Calculate buffer index */
+		tmptail = (USART_TxTail + 1) & USART_TX_BUFFER_MASK;
+		/* Store new index */
+		USART_TxTail = tmptail;      
+		/* Start transmission */
+		UDR0 = USART_TxBuf[tmptail];  
+	} else 
+	{       
+		/* Disable UDRE interrupt */
+		UCSR0B &= ~(1<<UDRIE0);         
+	}
+	STATS_ISR_END(STATS_ISR_UART_UDRE);
+}
+
+
+
+/*************************************************************************
+Waits until there are new data in the buffer. The CPU sleeps in Idle
+mode meanwhile if USART_SLEEP_WAIT is enabled.
+Input:    none
+Returns:  Data received from the UART. 
+*************************************************************************/
+uint8_t USART_Receive(void)
+{
+	uint8_t tmptail;
+	
+	/* Wait for incoming data */
+	#if USART_SLEEP_WAIT
+	SLEEP_WAIT_WHILE(USART_RxHead == USART_RxTail, SLEEP_MODE_IDLE);
+	#else
+	while (USART_RxHead == USART_RxTail);
+	#endif
+	/* Calculate buffer index */
+	tmptail = (USART_RxTail + 1) & USART_RX_BUFFER_MASK;
+	/* Store new index */
+	USART_RxTail = tmptail;                
+	/* Return data */
+	return USART_RxBuf[tmptail];          
+}
+
+
+/*************************************************************************
+Number of unread bytes in the buffer. 
+Input:    none
+Returns:  Bytes in the RX Buffer
+*************************************************************************/
+uint8_t USART_Available(void)
+{
+	return (USART_RxHead - USART_RxTail) & USART_RX_BUFFER_MASK;
+}
+
+
+/*************************************************************************
+Send Byte through UART. Enable the UDRE0 ISR. (buffer empty)
+If the buffer is full, waits (sleeping if enabled) for free space.
+Input:    data 	byte to be send
+Returns:  none
+*************************************************************************/
+void USART_Transmit(uint8_t data)
+{
+	uint8_t tmphead;
+	
+	/* Calculate buffer index */
+	tmphead = (USART_TxHead + 1) & USART_TX_BUFFER_MASK;
+	/* Wait for free space in buffer */
+	#if STATS_ENABLE
+	if (tmphead == USART_TxTail)
+		STATS_INC(STATS_UART_TX_FULL);
+	#endif
+	#if USART_SLEEP_WAIT
+	/* The UDRE interrupt frees one byte and wakes the CPU */
+	SLEEP_WAIT_WHILE(tmphead == USART_TxTail, SLEEP_MODE_IDLE);
+	#else
+	while (tmphead == USART_TxTail);
+	#endif
+	/* Store data in buffer */
+	USART_TxBuf[tmphead] = data;
+	/* Store new index */
+	USART_TxHead = tmphead;               
+	/* Enable UDRE interrupt */
+	UCSR0B |= (1<<UDRIE0);                    
+}
+
+
+/*************************************************************************
+Send a block through UART without copying it. Enable the UDRE0 ISR.
+Input:    data 	first byte of the block
+		  len 	number of bytes
+Returns:  1 if the block was accepted, 0 if another block is being sent
+*************************************************************************/
+uint8_t USART_TransmitBlock(const uint8_t* data, uint8_t len)
+{
+	uint8_t accepted = 0;
+	
+	/* Can be called from the main loop and from other ISRs */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (USART_TxBlockLen == 0)
+		{
+			USART_TxBlock = data;
+			USART_TxBlockLen = len;
+			/* Enable UDRE interrupt */
+			UCSR0B |= (1<<UDRIE0);
+			accepted = 1;
+		}
+	}
+	return accepted;
+}
+
+/*************************************************************************
+Check if a block is being sent.
+Input:    none
+Returns:  Bytes of the block still to be sent
+*************************************************************************/
+uint8_t USART_BlockBusy(void)
+{
+	return USART_TxBlockLen;
+}
+
+
+#if USART_BLOCK_RX
+/*************************************************************************
+Start receiving blocks into a buffer.
+Input:    buf 		slots * USART_BLOCK_SIZE bytes
+		  slots 	1, 2, 4 or 8
+Returns:  none
+*************************************************************************/
+void USART_BlockStart(uint8_t* buf, uint8_t slots)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		USART_RxBlockBuf = buf;
+		USART_RxBlockMask = slots - 1;
+		USART_RxBlockBase = 0;
+		USART_RxBlockReady = 0;
+		USART_RxBlockEnd = 0;
+		USART_RxBlockState = USART_BLK_SOH;
+	}
+}
+
+/*************************************************************************
+Give the received blocks to the writer, in order, and free their slots.
+The end flag is read before the drain: the sender sends EOT only after 
+the last block, so with the flag set all the blocks are already stored 
+and the drain writes them. Read after the drain, a block and the EOT 
+could arrive between the last check of the slots and the flag.
+Input:    writer 	function called with each block
+Returns:  USART_BLOCK_BUSY or USART_BLOCK_DONE
+*************************************************************************/
+uint8_t USART_BlockPoll(writer_USART writer)
+{
+	uint8_t end = USART_RxBlockEnd;
+	uint8_t slot = USART_RxBlockBase & USART_RxBlockMask;
+	
+	/* The ISR does not touch a slot while its bit is set */
+	while (USART_RxBlockReady & (1<<slot))
+	{
+		writer(USART_RxBlockBase, USART_RxBlockBuf + slot * USART_BLOCK_SIZE, USART_RxBlockLen[slot]);
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			USART_RxBlockReady &= ~(1<<slot);
+			USART_RxBlockBase++;
+		}
+		slot = USART_RxBlockBase & USART_RxBlockMask;
+	}
+	
+	if (end)
+	{
+		/* Back to the RX Buffer */
+		USART_RxBlockState = USART_BLK_IDLE;
+		return USART_BLOCK_DONE;
+	}
+	return USART_BLOCK_BUSY;
+}
+#endif
+
+
+/*************************************************************************
+Send String through UART. 
+Input:    StringPtr	String to be send
+Returns:  none
+*************************************************************************/
+void USART_putString(char* StringPtr)
+{
+	while(*StringPtr != 0x00) 	// Last char will be null. Check if there are more characters to send
+	{				
+		USART_Transmit(*StringPtr);	// Send 1 char at a time
+		StringPtr++;					// Increment the index
+	}
+}
+
+/*************************************************************************
+Send String stored in the program memory through UART. 
+Input:    StringPtr	String to be send
+Returns:  none
+*************************************************************************/
+void USART_putString_P(const char* StringPtr)
+{
+	char c;
+	
+	while ((c = pgm_read_byte(StringPtr)) != 0x00)
+	{
+		USART_Transmit(c);		// Send 1 char at a time
+		StringPtr++;			// Increment the index
+	}
+}
+
+/*************************************************************************
+Send Number through UART. 
+Input:    data	Number to be send
+Returns:  none
+*************************************************************************/
+void USART_putNumber(uint16_t data)
+{
+	char array[6];				// 5 digits of the number and the null char
+	utoa(data, array, 10);		// Radix for the conversion: 10
+	USART_putString(array);		// Send the ASCII codes obtained from data
+}
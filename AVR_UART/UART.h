@@ -1,90 +1,205 @@
-#ifndef UART_H_
-#define UART_H_
-
-/*************************************************************************
- Title	:   C include file for the UART library (UART.c)
- Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
- Software:  AVR-GCC 4.x
- Hardware:  Designed for ATmega328P, similar AVR devices
-
- DESCRIPTION
-       Basic routines for the UART protocol.
-
-       Originally based on the AppNote AVR306 from Microchip,
-       changed the structure to use the 2X Mode of the AVR, 
-       Designed for the ATmega328P microcontroller.
-
-       This Library uses interruptions for the UART and have buffers to 
-       store the data. The baud rate to initialize the UART is MYUBRR. 
-       This value is obtain from a Macro definition.
-
-*****************************************************************************/
-
-
-/**
-*	UART Clock Definitions
-*	Used to obtain the UBRR value for the desired baud rate.
-*
-*/
-#ifndef F_CPU				/* Prevent compiler error by supplying a default */
-	#define F_CPU 8000000UL
-#endif
-
-#define UART_BAUD_RATE 		9600		
-#define MYUBRR 				F_CPU/8/UART_BAUD_RATE-1
-
-
-/**
-*	UART Buffer Definitions
-*	Used to store the incoming data. The size of the buffers has to be a power 
-* 	of 2. Otherwise it won't work properly. 
-*
-*/
-#define USART_RX_BUFFER_SIZE 8     /* 2,4,8,16,32,64,128 or 256 bytes */
-#define USART_TX_BUFFER_SIZE 8     /* 2,4,8,16,32,64,128 or 256 bytes */
-#define USART_RX_BUFFER_MASK (USART_RX_BUFFER_SIZE - 1)
-#define USART_TX_BUFFER_MASK (USART_TX_BUFFER_SIZE - 1)
-
-
-/**
-*	Functions 
-*/
-
-/**
- @brief		Initialize the UART hardware in 2X Mode. 
- @param		ubrr_val uses the value from the macro definition of the main code
- @return 	none
-*/
-void USART_Init(unsigned int ubrr_val);
-
-/**
- @brief		Receive data from the UART's buffer
- @param		none
- @return 	data received from UART
-*/
-uint8_t USART_Receive(void);
-
-/**
- @brief		Send a byte with the UART 
- @param		data byte to be send through UART
- @return 	none
-*/
-void USART_Transmit(uint8_t data);
-
-
-/**
- @brief		Send a string with the UART 
- @param		StringPtr String to be send through UART
- @return 	none
-*/
-void USART_putString(char* StringPtr);
-
-/**
- @brief		Send the ASCII code of a number with the UART 
- @param		data Number to be send through UART in ASCII 
- @return 	none
-*/
-void USART_putNumber(uint16_t data);
-
-
+#ifndef UART_H_
+#define UART_H_
+
+/*************************************************************************
+ Title	:   C include file for the UART library (UART.c)
+ Author:    Jhonatan Macazana <jhonatan.macazana@utec.edu.pe> 
+ Software:  AVR-GCC 4.x
+ Hardware:  Designed for ATmega328P, similar AVR devices
+
+ DESCRIPTION
+       Basic routines for the UART protocol.
+
+       Originally based on the AppNote AVR306 from Microchip,
+       changed the structure to use the 2X Mode of the AVR, 
+       Designed for the ATmega328P microcontroller.
+
+       This Library uses interruptions for the UART and have buffers to 
+       store the data. The baud rate to initialize the UART is MYUBRR. 
+       This value is obtain from a Macro definition.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include "../AVR_CONFIG/CONFIG.h"			/* UART_BAUD_RATE and MYUBRR */
+
+
+/**
+*	UART Baud Rate Error
+*	Real baud rate obtained with MYUBRR (rounded to the nearest divisor, 
+*	e.g. 57600 baud at 16 MHz gives 34 and -0.8%, truncating gave 33 and 
+*	+2.1%) and its error in per mille. Rates 
+*	with more than 2% of error are not reliable, UART.c warns about them
+*	when it is compiled.
+*
+*/
+#define UART_BAUD_REAL		((F_CPU)/(8UL*(MYUBRR + 1)))
+#define UART_BAUD_ERROR		((UART_BAUD_REAL*1000UL)/(UART_BAUD_RATE))
+
+
+/**
+*	UART Buffer Definitions
+*	Used to store the incoming data. The sizes of the buffers are set in
+* 	MEMCONF.h and have to be a power of 2.
+*
+*/
+#include "../AVR_MEMCONF/MEMCONF.h"
+#define USART_RX_BUFFER_MASK (USART_RX_BUFFER_SIZE - 1)
+#define USART_TX_BUFFER_MASK (USART_TX_BUFFER_SIZE - 1)
+
+
+/**
+*	UART Sleep Definitions
+*	When enabled, USART_Receive() and USART_Transmit() put the CPU in Idle
+*	mode while they wait for the buffers instead of spinning (the loop of 
+*	SLEEPWAIT.h). The RX and UDRE interrupts wake the CPU up. The I bit 
+*	of SREG is not changed: called with the interrupts disabled they do 
+*	not sleep, and wait forever for a buffer that only the ISRs can change.
+*
+*/
+#ifndef USART_SLEEP_WAIT
+#define USART_SLEEP_WAIT	1			/* 1: Idle sleep -- 0: busy wait */
+#endif
+
+
+/**
+*	UART Block Receive Definitions
+*	With USART_BLOCK_RX enabled, the RX ISR can receive blocks straight 
+*	into a caller buffer instead of the RX Buffer, for uploads at 500k-1M 
+*	baud (MYUBRR 3 or 1 at 16 MHz). The sender uses this protocol:
+*
+*	  Frame:  SOH seq len data[len] crc_hi crc_lo
+*	          crc = CRC-16/XMODEM (_crc_xmodem_update) of seq, len and data
+*	  Reply:  ACK seq   block stored (or already stored before)
+*	          NAK seq   CRC error or block outside the window, send it again
+*	  End:    EOT       after the last block, replied with ACK EOT
+*
+*	Block seq is stored in the slot seq % slots of the buffer, at offset 
+*	slot * USART_BLOCK_SIZE. Up to slots blocks can be sent before their 
+*	ACK (the window). USART_BlockPoll() gives the stored blocks in order 
+*	to a writer (e.g. a flash or EEPROM page writer) and frees the slots.
+*	The replies are queued by the ISR, so do not call USART_Transmit() 
+*	during a transfer.
+*
+*/
+#ifndef USART_BLOCK_RX
+#define USART_BLOCK_RX		0			/* 1: compile the block receive mode */
+#endif
+#ifndef USART_BLOCK_SIZE
+#define USART_BLOCK_SIZE	64			/* Power of 2, max data per frame */
+#endif
+
+#define USART_SOH			0x01
+#define USART_EOT			0x04
+#define USART_ACK			0x06
+#define USART_NAK			0x15
+
+#define USART_BLOCK_BUSY	0			// Transfer in progress
+#define USART_BLOCK_DONE	1			// EOT received, all blocks written
+
+/**
+*	UART Block Writer
+*	Called by USART_BlockPoll() with every block, in order. Runs in the
+*	context of the caller of USART_BlockPoll(), not in the ISR.
+*
+*/
+typedef void (*writer_USART)(uint8_t seq, uint8_t* data, uint8_t len);
+
+
+/**
+*	Functions 
+*/
+
+/**
+ @brief		Initialize the UART hardware in 2X Mode. 
+ @param		ubrr_val uses the value from the macro definition of the main code,
+ 			MYUBRR, or uart_ubrr of EECONFIG_Data with EECONFIG_ENABLE
+ @return 	none
+*/
+void USART_Init(unsigned int ubrr_val);
+
+/**
+ @brief		Receive data from the UART's buffer
+ @param		none
+ @return 	data received from UART
+*/
+uint8_t USART_Receive(void);
+
+/**
+ @brief		Number of unread bytes in the UART's buffer. Does not wait. 
+ @param		none
+ @return 	bytes that USART_Receive() can return without waiting
+*/
+uint8_t USART_Available(void);
+
+/**
+ @brief		Send a byte with the UART 
+ @param		data byte to be send through UART
+ @return 	none
+*/
+void USART_Transmit(uint8_t data);
+
+
+/**
+ @brief		Send a block of memory with the UART without copying it to the 
+ 			TX buffer. The UDRE ISR reads it directly, so the memory has to 
+ 			stay unchanged until USART_BlockBusy() returns 0. Does not wait, 
+ 			can be called from other ISRs.
+ @param		data 	first byte of the block
+ 			len 	number of bytes (1 to 255)
+ @return 	1 if the block was accepted, 0 if another block is being sent
+*/
+uint8_t USART_TransmitBlock(const uint8_t* data, uint8_t len);
+
+/**
+ @brief		Check if a block of USART_TransmitBlock() is being sent. 
+ @param		none
+ @return 	Bytes of the block still to be sent
+*/
+uint8_t USART_BlockBusy(void);
+
+
+#if USART_BLOCK_RX
+/**
+ @brief		Start receiving blocks into a buffer. The RX Buffer is not used 
+ 			until the transfer ends.
+ @param		buf 	slots * USART_BLOCK_SIZE bytes
+ 			slots 	number of blocks of the buffer and size of the window:
+ 					1, 2, 4 or 8
+ @return 	none
+*/
+void USART_BlockStart(uint8_t* buf, uint8_t slots);
+
+/**
+ @brief		Give the received blocks to the writer and check the end of the
+ 			transfer. Has to be called often enough to free the slots.
+ @param		writer 	function called with each block
+ @return 	USART_BLOCK_BUSY or USART_BLOCK_DONE
+*/
+uint8_t USART_BlockPoll(writer_USART writer);
+#endif
+
+
+/**
+ @brief		Send a string with the UART 
+ @param		StringPtr String to be send through UART
+ @return 	none
+*/
+void USART_putString(char* StringPtr);
+
+/**
+ @brief		Send a string stored in the flash (PSTR()) with the UART 
+ @param		StringPtr String in the program memory to be send through UART
+ @return 	none
+*/
+void USART_putString_P(const char* StringPtr);
+
+/**
+ @brief		Send the ASCII code of a number with the UART 
+ @param		data Number to be send through UART in ASCII 
+ @return 	none
+*/
+void USART_putNumber(uint16_t data);
+
+
 #endif /* UART_H_ */
\ No newline at end of file